@@ -25,5 +25,7 @@
 uint8_t         audioCodecSetByIndex(int dex,int i);
 void            audioCodecConfigure( int dex );
 void            audioCodecConfigureCodecIndex( int dex,CONFcouple **conf  );
+/* Filter part */
+void            audioFilterClearScanCache(void);
 
 #endif
@@ -18,6 +18,7 @@
 #include "ADM_audioStream.h"
 #include "ADM_threadQueue.h"
 #include "ADM_byteBuffer.h"
+#include "ADM_stageStats.h"
 
 /**
     \class ADM_audioAccess_thread
@@ -29,6 +30,8 @@ class ADM_audioAccess_thread : public ADM_audioAccess,public ADM_threadQueue
   protected:
                 ADM_audioAccess   *son;
                 BVector <ADM_byteBuffer *> ListOfByteBuffers;
+                ADM_stageStats    *encodeStats; // NULL unless an export is collecting statistics
+                ADM_stageStats    *queueStats;
   public:
 
 
@@ -1,15 +1,102 @@
 /**
     \fn ADM_audioResample.h
-    \brief Wrapper around libsamplerate
+    \brief Polyphase FIR resampler, wrapper around libsamplerate for uncommon ratios
 
+    When the two frequencies have a small enough common ratio (48000->44100 is 160/147,
+    film2pal is 1001/960), a windowed sinc is precomputed for each of the possible
+    output phases and each output sample is a single dot product.
+    Channels are independent and are spread over the shared thread pool for large blocks.
 
 */
 #include "ADM_default.h"
 #include "ADM_coreAudio.h"
 #include "ADM_audioResample.h"
 #include "ADM_libsamplerate/samplerate.h"
+#include "ADM_threadPool.h"
 #include <math.h>
 
+#define ADM_RESAMPLE_MAX_PHASES 1024       // Above that we use libsamplerate
+#define ADM_RESAMPLE_MAX_TAPS   1024
+#define ADM_RESAMPLE_MT_THRESHOLD (64*1024) // Nb of multiply-add in a block before using threads
+
+#if defined( ADM_CPU_X86)
+extern "C"     void adm_resample_dot_sse(const float *src,const float *coef,float *sum, int count);
+#endif
+
+/**
+    \struct resamplePreset
+*/
+typedef struct
+{
+    uint32_t taps;     // Filter length when not downsampling
+    double   beta;     // Kaiser window shape
+    double   rolloff;  // Cutoff relative to the lowest Nyquist frequency
+}resamplePreset;
+
+static const resamplePreset presets[3]=
+{
+    {16, 6.0, 0.90}, // ADM_RESAMPLE_QUALITY_FAST
+    {32, 8.0, 0.94}, // ADM_RESAMPLE_QUALITY_MEDIUM
+    {64,10.0, 0.97}  // ADM_RESAMPLE_QUALITY_HIGH
+};
+
+/**
+    \fn gcd
+*/
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while(b)
+    {
+        uint32_t t=a%b;
+        a=b;
+        b=t;
+    }
+    return a;
+}
+/**
+    \fn besselI0
+    \brief Modified Bessel function of the first kind, order 0
+*/
+static double besselI0(double x)
+{
+    double sum=1.,term=1.;
+    double half=x/2.;
+    for(int k=1;k<50;k++)
+    {
+        term*=half/k;
+        double t2=term*term;
+        sum+=t2;
+        if(t2<sum*1e-12) break;
+    }
+    return sum;
+}
+/**
+    \fn dotC
+*/
+static float dotC(const float *src,const float *coef,uint32_t nb)
+{
+    float s0=0,s1=0,s2=0,s3=0;
+    for(uint32_t i=0;i<nb;i+=4)
+    {
+        s0+=src[i]*coef[i];
+        s1+=src[i+1]*coef[i+1];
+        s2+=src[i+2]*coef[i+2];
+        s3+=src[i+3]*coef[i+3];
+    }
+    return s0+s1+s2+s3;
+}
+#if defined( ADM_CPU_X86)
+/**
+    \fn dotSSE
+    \brief src may be unaligned, coef must be aligned on 16 bytes
+*/
+static float dotSSE(const float *src,const float *coef,uint32_t nb)
+{
+    float ASM_ALIGNED(16) sum4[4];
+    adm_resample_dot_sse(src,coef,sum4,nb>>2);
+    return sum4[0]+sum4[1]+sum4[2]+sum4[3];
+}
+#endif
 
 /**
     \fn ADM_resample
@@ -21,6 +108,16 @@ ADM_resample::ADM_resample(void)
     toFrequency=0;
     nbChannels=0;
     context=NULL;
+    up=down=1;
+    nbTaps=0;
+    coefs=NULL;
+    phase=position=filled=0;
+    historySize=0;
+    history=NULL;
+    planar=NULL;
+    planarSize=0;
+    totalIn=totalOut=0;
+    silence=NULL;
 }
 
 #define CONTEXT ((SRC_STATE* )context)
@@ -31,8 +128,9 @@ ADM_resample::ADM_resample(void)
     @param from    : Starting frequency
     @param to      : Ending frequency
     @param channel : Nb Channel
+    @param quality : Filter preset
 */
-bool ADM_resample::init(uint32_t from, uint32_t to, uint32_t channel)
+bool ADM_resample::init(uint32_t from, uint32_t to, uint32_t channel,ADM_RESAMPLE_QUALITY quality)
 {
 int er=0;
 
@@ -48,16 +146,108 @@ int er=0;
     fromFrequency=from;
     toFrequency=to;
     nbChannels=channel;
+    if(initPolyphase(quality))
+        return true;
     context=(void *)src_new (SRC_SINC_FASTEST*0+1*SRC_SINC_MEDIUM_QUALITY, channel, &er) ;
-    if(!context) 
+    if(!context)
     {
         printf("[SRC] Error :%d\n",er);
         return false;
     }
     ADM_assert(!src_set_ratio (CONTEXT,ratio)) ;
-    // 
+    //
+    return true;
+}
+/**
+    \fn initPolyphase
+    \brief Build the coefficient table, returns false if the ratio is not suitable
+*/
+bool ADM_resample::initPolyphase(ADM_RESAMPLE_QUALITY quality)
+{
+    if(quality>ADM_RESAMPLE_QUALITY_HIGH) quality=ADM_RESAMPLE_QUALITY_HIGH;
+    const resamplePreset *preset=presets+quality;
+    uint32_t g=gcd(fromFrequency,toFrequency);
+    up=toFrequency/g;
+    down=fromFrequency/g;
+    if(up>ADM_RESAMPLE_MAX_PHASES)
+    {
+        printf("[SRC] %u phases needed, using libsamplerate\n",up);
+        return false;
+    }
+    // When downsampling, the cutoff goes down and the filter must be longer
+    double cutoff=preset->rolloff;
+    if(up<down)
+        cutoff=(cutoff*up)/down;
+    uint32_t taps=(uint32_t)ceil(preset->taps*preset->rolloff/cutoff);
+    taps=(taps+3)&~3;
+    if(taps>ADM_RESAMPLE_MAX_TAPS)
+    {
+        printf("[SRC] Filter too long (%u taps), using libsamplerate\n",taps);
+        return false;
+    }
+    nbTaps=taps;
+    coefs=(float *)ADM_alloc(sizeof(float)*up*nbTaps);
+    double half=nbTaps/2;
+    double norm=besselI0(preset->beta);
+    for(uint32_t p=0;p<up;p++)
+    {
+        float *row=coefs+p*nbTaps;
+        double sum=0;
+        for(uint32_t k=0;k<nbTaps;k++)
+        {
+            // distance between the input sample and the output instant, in input samples
+            double x=(double)k-half-(double)p/up;
+            double sinc;
+            if(fabs(x)<1e-9)
+                sinc=cutoff;
+            else
+                sinc=sin(M_PI*cutoff*x)/(M_PI*x);
+            double w=x/(half+1.);
+            w=1.-w*w;
+            if(w<0.) w=0.;
+            w=besselI0(preset->beta*sqrt(w))/norm;
+            row[k]=(float)(sinc*w);
+            sum+=row[k];
+        }
+        // Unity gain for each phase
+        for(uint32_t k=0;k<nbTaps;k++)
+            row[k]=(float)(row[k]/sum);
+    }
+    // History is primed with half a filter of silence so that output 0 is centered on input 0
+    historySize=nbTaps*4;
+    history=new float *[nbChannels];
+    planar=new float *[nbChannels];
+    for(int c=0;c<nbChannels;c++)
+    {
+        history[c]=(float *)ADM_alloc(sizeof(float)*historySize);
+        planar[c]=NULL;
+    }
+    reset();
+    printf("[SRC] Polyphase %u/%u, %u taps, quality %d\n",up,down,nbTaps,(int)quality);
     return true;
 }
+/**
+    \fn cleanup
+*/
+void ADM_resample::cleanup(void)
+{
+    if(history)
+    {
+        for(int c=0;c<nbChannels;c++)
+        {
+            ADM_dezalloc(history[c]);
+            if(planar[c]) ADM_dezalloc(planar[c]);
+        }
+        delete [] history;
+        delete [] planar;
+    }
+    history=NULL;
+    planar=NULL;
+    if(coefs) ADM_dezalloc(coefs);
+    coefs=NULL;
+    if(silence) delete [] silence;
+    silence=NULL;
+}
 /**
     \fn ~ ADM_resample
     \brief Destructor
@@ -67,6 +257,7 @@ ADM_resample::~ADM_resample(void)
     if(context)
         src_delete (CONTEXT) ;
      context=NULL;
+    cleanup();
     printf("[SRC] Deleted\n");
 }
 /**
@@ -75,6 +266,16 @@ ADM_resample::~ADM_resample(void)
 */
 bool ADM_resample::reset(void)
 {
+    totalIn=totalOut=0;
+    if(coefs)
+    {
+        for(int c=0;c<nbChannels;c++)
+            memset(history[c],0,sizeof(float)*historySize);
+        phase=0;
+        position=0;
+        filled=nbTaps/2;
+        return true;
+    }
     ADM_assert(context);
     src_reset (CONTEXT);
     return true;
@@ -93,6 +294,13 @@ bool ADM_resample::reset(void)
 */
 bool ADM_resample::process(float *from, float *to, uint32_t nbSample,uint32_t maxOutSample, uint32_t *sampleProcessed, uint32_t *outNbSample)
 {
+    if(coefs)
+    {
+        if(!processPolyphase(from,to,nbSample,maxOutSample,sampleProcessed,outNbSample))
+            return false;
+        totalIn+=*sampleProcessed;
+        return true;
+    }
     SRC_DATA block;
     block.data_in=from;
     block.data_out=to;
@@ -112,4 +320,206 @@ bool ADM_resample::process(float *from, float *to, uint32_t nbSample,uint32_t ma
     *outNbSample=block.output_frames_gen;
     return true;
 }
+/**
+    \fn flush
+    \brief The input is over, feed silence to get the last samples out of the filter
+            Only the outputs matching real input samples are produced.
+*/
+bool ADM_resample::flush(float *to, uint32_t maxOutSample, uint32_t *outNbSample)
+{
+    *outNbSample=0;
+    if(!coefs)
+    {
+        SRC_DATA block;
+        float dummy[1];
+        block.data_in=dummy;
+        block.data_out=to;
+        block.input_frames=0;
+        block.output_frames=maxOutSample;
+        block.input_frames_used=0;
+        block.output_frames_gen=0;
+        block.end_of_input=1;
+        block.src_ratio=ratio;
+        int er=src_process (CONTEXT,&block);
+        if(er)
+        {
+            printf("[SRC] Error :%d->%s\n",er,src_strerror(er));
+            return false;
+        }
+        *outNbSample=block.output_frames_gen;
+        return true;
+    }
+    uint64_t expected=(totalIn*up+down-1)/down;
+    if(totalOut>=expected)
+        return true;
+    if(!silence)
+    {
+        silence=new float[nbTaps*nbChannels];
+        memset(silence,0,sizeof(float)*nbTaps*nbChannels);
+    }
+    while(totalOut<expected && *outNbSample<maxOutSample)
+    {
+        uint64_t left=expected-totalOut;
+        uint32_t room=maxOutSample-*outNbSample;
+        if(left<room) room=(uint32_t)left;
+        uint32_t taken=0,nbOut=0;
+        if(!processPolyphase(silence,to,nbTaps,room,&taken,&nbOut))
+            return false;
+        if(!nbOut && !taken)
+            break;
+        to+=nbOut*nbChannels;
+        *outNbSample+=nbOut;
+    }
+    return true;
+}
+/**
+    \struct resampleJob
+*/
+typedef struct
+{
+    ADM_resample *resampler;
+    float        *from;
+    uint32_t      take;
+    uint32_t      nbOut;
+}resampleJob;
+/**
+    \fn resampleWorker
+*/
+static void resampleWorker(void *cookie,int channel)
+{
+    resampleJob *job=(resampleJob *)cookie;
+    job->resampler->processChannel(channel,job->from,job->take,job->nbOut);
+}
+/**
+    \fn processChannel
+    \brief Append take samples of channel to its history and compute nbOut output samples into planar
+*/
+void ADM_resample::processChannel(int channel,float *from,uint32_t take,uint32_t nbOut)
+{
+    float *h=history[channel];
+    float *dst=h+filled;
+    from+=channel;
+    for(uint32_t i=0;i<take;i++)
+    {
+        dst[i]=*from;
+        from+=nbChannels;
+    }
+    float *out=planar[channel];
+    uint32_t p=phase,pos=position;
+#if defined( ADM_CPU_X86)
+    if(CpuCaps::hasSSE())
+    {
+        for(uint32_t n=0;n<nbOut;n++)
+        {
+            out[n]=dotSSE(h+pos,coefs+p*nbTaps,nbTaps);
+            p+=down;
+            pos+=p/up;
+            p%=up;
+        }
+        return;
+    }
+#endif
+    for(uint32_t n=0;n<nbOut;n++)
+    {
+        out[n]=dotC(h+pos,coefs+p*nbTaps,nbTaps);
+        p+=down;
+        pos+=p/up;
+        p%=up;
+    }
+}
+/**
+    \fn processPolyphase
+    \brief Only take the incoming samples needed to generate at most maxOutSample
+*/
+bool ADM_resample::processPolyphase(float *from, float *to, uint32_t nbSample,uint32_t maxOutSample, uint32_t *sampleProcessed, uint32_t *outNbSample)
+{
+    *sampleProcessed=0;
+    *outNbSample=0;
+    if(!maxOutSample) return true;
+    // How many incoming samples are needed to compute maxOutSample ?
+    uint64_t lastPosition=position+((uint64_t)phase+(uint64_t)(maxOutSample-1)*down)/up;
+    uint64_t need=lastPosition+nbTaps;
+    uint32_t take=0;
+    if(need>filled)
+    {
+        need-=filled;
+        take=(need<nbSample)? (uint32_t)need : nbSample;
+    }
+    // Make room
+    if(filled+take>historySize)
+    {
+        uint32_t newSize=filled+take+nbTaps;
+        for(int c=0;c<nbChannels;c++)
+        {
+            float *n=(float *)ADM_alloc(sizeof(float)*newSize);
+            memcpy(n,history[c],sizeof(float)*filled);
+            ADM_dezalloc(history[c]);
+            history[c]=n;
+        }
+        historySize=newSize;
+    }
+    // How many output samples will we get ?
+    uint32_t available=filled+take;
+    uint32_t nbOut=0;
+    uint32_t p=phase,pos=position;
+    while(nbOut<maxOutSample && pos+nbTaps<=available)
+    {
+        nbOut++;
+        p+=down;
+        pos+=p/up;
+        p%=up;
+    }
+    if(nbOut>planarSize)
+    {
+        for(int c=0;c<nbChannels;c++)
+        {
+            if(planar[c]) ADM_dezalloc(planar[c]);
+            planar[c]=(float *)ADM_alloc(sizeof(float)*nbOut);
+        }
+        planarSize=nbOut;
+    }
+    // Do the actual work, one channel per slice
+    resampleJob job;
+    job.resampler=this;
+    job.from=from;
+    job.take=take;
+    job.nbOut=nbOut;
+    if(nbChannels>1 && (uint64_t)nbOut*nbTaps*nbChannels>=ADM_RESAMPLE_MT_THRESHOLD)
+    {
+        ADM_threadPool::getInstance()->run(nbChannels,resampleWorker,&job);
+    }else
+    {
+        for(int c=0;c<nbChannels;c++)
+            processChannel(c,from,take,nbOut);
+    }
+    // Interleave
+    for(int c=0;c<nbChannels;c++)
+    {
+        float *src=planar[c];
+        float *dst=to+c;
+        for(uint32_t n=0;n<nbOut;n++)
+        {
+            *dst=src[n];
+            dst+=nbChannels;
+        }
+    }
+    // Update state and drop the samples we will never need again
+    phase=p;
+    filled=available;
+    if(pos>=filled) // Can happen when downsampling, the next window starts after what we have
+    {
+        position=pos-filled;
+        filled=0;
+    }else
+    {
+        for(int c=0;c<nbChannels;c++)
+            memmove(history[c],history[c]+pos,sizeof(float)*(filled-pos));
+        filled-=pos;
+        position=0;
+    }
+    totalOut+=nbOut;
+    *sampleProcessed=take;
+    *outNbSample=nbOut;
+    return true;
+}
 //EOF
@@ -0,0 +1,24 @@
+;
+;  Dot product for the polyphase resampler
+;  src can be unaligned, coef is aligned on 16 bytes
+;  count is the number of blocks of 4 floats
+;
+%define private_prefix adm
+%define public_prefix  adm
+
+%include "admx86util.asm"
+
+section .text
+INIT_XMM sse
+cglobal resample_dot, 4,4,3, src, coef, sum, l
+        xorps            m2,m2, m2
+.again:
+        movups           m0,   [srcq]
+        mulps            m0,   [coefq]
+        addps            m2,   m0
+        add              srcq, 16
+        add              coefq,16
+        sub              ld,   1
+        jnz             .again
+        movaps          [sumq],m2
+        RET
@@ -21,6 +21,7 @@ using std::string;
 #include "ADM_vidMisc.h"
 #include "ADM_ptrQueue.h"
 #include "ADM_audioClock.h"
+#include "ADM_packetPrefetch.h"
 #include <math.h>
 
 #if 1
@@ -45,6 +46,9 @@ class ADM_audioStreamCopy : public ADM_audioStream
                         ADM_audioStream *in;
                         uint64_t        startTime;
                         int64_t         shift;
+                        ADM_packetPrefetch *prefetch; // created on the first packet, reads ahead of the muxer
+                        bool            readInput(uint8_t *buffer,uint32_t *size, uint32_t sizeMax,uint32_t *nbSample,uint64_t *dts);
+static                  bool            prefetchReader(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet);
         public:
                         ADM_audioStreamCopy(ADM_audioStream *input,uint64_t startTime, int64_t shift);  
 virtual                 ~ADM_audioStreamCopy();
@@ -131,6 +135,9 @@ virtual uint8_t         getPacket(uint8_t *buffer,uint32_t *size, uint32_t sizeM
  */
 ADM_audioStreamCopy::~ADM_audioStreamCopy()
 {
+    if(prefetch)
+        delete prefetch;
+    prefetch=NULL;
 }
 // Pass Through class, just do the timing
 /**
@@ -150,7 +157,32 @@ ADM_audioStreamCopy::ADM_audioStreamCopy(ADM_audioStream *input,uint64_t startTi
     in->goToTime(startTime);
     this->shift=shift;
     setLanguage(input->getLanguage());
-    
+    prefetch=NULL;
+}
+/**
+    \fn prefetchReader
+    \brief Runs on the prefetch thread, read one packet from the source track
+*/
+bool ADM_audioStreamCopy::prefetchReader(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet)
+{
+    ADM_audioStreamCopy *me=(ADM_audioStreamCopy *)cookie;
+    return !!me->in->getPacket(buffer,&(packet->len),bufferSize,&(packet->samples),&(packet->dts));
+}
+/**
+    \fn readInput
+    \brief Read one packet from the source track, through the prefetch queue
+*/
+bool ADM_audioStreamCopy::readInput(uint8_t *buffer,uint32_t *size, uint32_t sizeMax,uint32_t *nbSample,uint64_t *dts)
+{
+    if(!prefetch)
+        prefetch=new ADM_packetPrefetch("audio copy",prefetchReader,this,sizeMax);
+    ADM_prefetchPacket packet;
+    if(false==prefetch->getPacket(buffer,sizeMax,&packet))
+        return false;
+    *size=packet.len;
+    *nbSample=packet.samples;
+    *dts=packet.dts;
+    return true;
 }
 /**
  * \fn isCBR
@@ -191,7 +223,7 @@ uint8_t         ADM_audioStreamCopy::getPacket(uint8_t *buffer,uint32_t *size, u
 {
     
 again:
-    if(false==in->getPacket(buffer,size,sizeMax,nbSample,dts)) 
+    if(false==readInput(buffer,size,sizeMax,nbSample,dts)) 
     {
         // done processing that
        return false;
@@ -301,7 +333,7 @@ again:
             return r;
        }
         // if we can't get an new packet...
-    if(false==in->getPacket(buffer,size,sizeMax,nbSample,dts)) 
+    if(false==readInput(buffer,size,sizeMax,nbSample,dts)) 
     {
         switch(state)
         {
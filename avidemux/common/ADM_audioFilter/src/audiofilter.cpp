@@ -24,6 +24,8 @@ using std::string;
 #include "audiofilter_internal.h"
 #include "audiofilter_conf.h"
 #include "audiofilter_film2pal.h"
+#include "ADM_edAudioTrackFromVideo.h"
+#include "ADM_edAudioTrackExternal.h"
 #include "prefs.h"
 VectorOfAudioFilter PlaybackVector;
 extern ADM_Composer *video_body;
@@ -103,6 +105,65 @@ bool            destroyPlaybackFilter(void)
     return true;
 
 }
+/**
+    \fn audioFilterClearScanCache
+    \brief Forget the normalize peaks, the sources they describe are gone
+*/
+void audioFilterClearScanCache(void)
+{
+    AUDMAudioFilterNormalize::clearScanCache();
+}
+/**
+    \fn ADM_normalizeScanKey
+    \brief Describe everything the normalize filter sees upstream : source files (size and date), track, segments and filters
+            Two chains with the same key produce the same samples, so the peak scan can be reused.
+            Returns an empty string if the source cannot be identified.
+*/
+static std::string ADM_normalizeScanKey(ADM_edAudioTrack *source,ADM_AUDIOFILTER_CONFIG *config)
+{
+    char tmp[1024];
+    std::string key;
+    ADM_edAudioTrackExternal *external=source->castToExternal();
+    ADM_edAudioTrackFromVideo *fromVideo=source->castToTrackFromVideo();
+    if(external)
+    {
+        const char *name=external->getMyName().c_str();
+        snprintf(tmp,sizeof(tmp),"external:%s:%" PRId64":%" PRId64,name,ADM_fileSize(name),ADM_fileMtime(name));
+        key=std::string(tmp);
+    }else if(fromVideo)
+    {
+        snprintf(tmp,sizeof(tmp),"track:%d",fromVideo->getMyTrackIndex());
+        key=std::string(tmp);
+        int nbSeg=video_body->getNbSegment();
+        for(int i=0;i<nbSeg;i++)
+        {
+            _SEGMENT *seg=video_body->getSegment(i);
+            _VIDEOS *ref=video_body->getRefVideo(seg->_reference);
+            if(!ref || !ref->_aviheader || !ref->_aviheader->getMyName())
+                return std::string();
+            const char *name=ref->_aviheader->getMyName();
+            snprintf(tmp,sizeof(tmp),"|%s:%" PRId64":%" PRId64":%" PRIu64":%" PRIu64,
+                    name,ADM_fileSize(name),ADM_fileMtime(name),seg->_refStartTimeUs,seg->_durationUs);
+            key+=std::string(tmp);
+        }
+    }else
+    {
+        return key;
+    }
+    // The resampler takes its quality from the preferences
+    uint32_t quality=ADM_RESAMPLE_QUALITY_MEDIUM;
+    if(!prefs->get(DEFAULT_RESAMPLE_QUALITY,&quality))
+        quality=ADM_RESAMPLE_QUALITY_MEDIUM;
+    snprintf(tmp,sizeof(tmp),"|start:%" PRIu64":%d|mixer:%d|drc:%d:%d:%f:%f:%f:%f:%f|film:%d|resample:%d:%d",
+            config->startTimeInUs,config->shiftEnabled? config->shiftInMs : 0,
+            config->mixerEnabled? (int)config->mixerConf : -1,
+            (int)config->drcEnabled,(int)config->drcConf.mUseGain,config->drcConf.mFloor,config->drcConf.mAttackTime,
+            config->drcConf.mDecayTime,config->drcConf.mRatio,config->drcConf.mThresholdDB,
+            (int)config->film2pal,
+            config->resamplerEnabled? (int)config->resamplerFrequency : 0,config->resamplerEnabled? (int)quality : -1);
+    key+=std::string(tmp);
+    return key;
+}
 /***********************************************************************/
 #define ADD_FILTER(x) { vec->push_back(x);last=x;}
 /**
@@ -167,7 +228,10 @@ bool ADM_buildFilterChain(ADM_edAudioTrack *source,VectorOfAudioFilter *vec,ADM_
     // Normalize
     if(config->gainParam.mode!=ADM_NO_GAIN)
     {
-        AUDMAudioFilterNormalize *norm=new AUDMAudioFilterNormalize(last,&(config->gainParam));
+        std::string scanKey;
+        if(config->gainParam.mode==ADM_GAIN_AUTOMATIC)
+            scanKey=ADM_normalizeScanKey(source,config);
+        AUDMAudioFilterNormalize *norm=new AUDMAudioFilterNormalize(last,&(config->gainParam),scanKey);
         ADD_FILTER(norm);
     }
     return true;
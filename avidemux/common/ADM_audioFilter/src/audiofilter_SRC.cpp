@@ -16,6 +16,7 @@
 
 #include "ADM_audioFilter.h"
 #include "audiofilter_SRC.h"
+#include "prefs.h"
 /**
     \fn AUDMAudioFilterSrc
 
@@ -32,7 +33,10 @@
     return;
   }
     int org=_previous->getInfo()->frequency;
-    if(true!=resampler.init(org,tgt,_wavHeader.channels))
+    uint32_t quality=ADM_RESAMPLE_QUALITY_MEDIUM;
+    if(!prefs->get(DEFAULT_RESAMPLE_QUALITY,&quality))
+        quality=ADM_RESAMPLE_QUALITY_MEDIUM;
+    if(true!=resampler.init(org,tgt,_wavHeader.channels,(ADM_RESAMPLE_QUALITY)quality))
     {
         printf("[AudioFilter Resample] Init failed! \n");
         engaged=0;
@@ -47,8 +51,19 @@ AUDMAudioFilterSrc::~AUDMAudioFilterSrc()
 {
   printf("[AudioFilter Resample] Destroying\n");
 };
+/**
+    \fn rewind
+    \brief Start again with an empty filter
+*/
+uint8_t AUDMAudioFilterSrc::rewind(void)
+{
+    if(engaged)
+        resampler.reset();
+    return AUDMAudioFilter::rewind();
+}
 
 #define BLK_SIZE 512
+#define BLK_SIZE_MAX (BLK_SIZE*16) // Large blocks allow the resampler to spread channels over threads
 //_____________________________________________
 uint32_t AUDMAudioFilterSrc::fill(uint32_t max,float *output,AUD_Status *status)
 {
@@ -74,19 +89,29 @@ uint32_t AUDMAudioFilterSrc::fill(uint32_t max,float *output,AUD_Status *status)
         fillIncomingBuffer(status);
         if(_head==_tail)
         {
+          // Get the tail of the filter out before reporting the end
+          uint32_t nbOut=0;
+          if(resampler.flush(output,max/_wavHeader.channels,&nbOut) && nbOut)
+          {
+              *status=AUD_OK;
+              return snboutput+nbOut*_wavHeader.channels;
+          }
           *status=AUD_END_OF_STREAM;
           return snboutput;
         }
         ADM_assert(_tail>=_head);
         uint32_t nb_in=(_tail-_head)/(_wavHeader.channels); // Nb Sample
-        if(nb_in>BLK_SIZE) nb_in=BLK_SIZE;
+        uint32_t maxSample=max/_wavHeader.channels;
+        // Feed as much as the output can hold
+        uint32_t fit=(uint32_t)(((uint64_t)maxSample*_previous->getInfo()->frequency)/_wavHeader.frequency);
+        if(fit<BLK_SIZE) fit=BLK_SIZE;
+        if(fit>BLK_SIZE_MAX) fit=BLK_SIZE_MAX;
+        if(nb_in>fit) nb_in=fit;
         if(!nb_in)
         {
           printf("[Resampler]Not enough audio\n");
           return snboutput;
         }
-        // We have one BLK_SIZE incoming
-        uint32_t maxSample=BLK_SIZE*4; // FIXME!
         uint32_t nbOut=0;
         uint32_t nbIn=nb_in;
         uint32_t nbInTaken=0;
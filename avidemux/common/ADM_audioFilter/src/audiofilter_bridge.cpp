@@ -22,6 +22,9 @@ using std::string;
 #include "audiofilter_bridge.h"
 #include "ADM_vidMisc.h"
 
+// The smallest room fillIncomingBuffer offers, a prefetched packet must always fit
+#define BRIDGE_PREFETCH_FLOATS ((3*AUD_PROCESS_BUFFER_SIZE)/20)
+
 #if 1
 #define aprintf(...) {}
 #else
@@ -62,6 +65,8 @@ AUDMAudioFilter_Bridge::AUDMAudioFilter_Bridge(ADM_edAudioTrack *incoming,
   _shiftUs=_ms2us(shiftMs);
   
   _held=_hold=0;
+  _prefetch=NULL;
+  _prefetchEnabled=false;
 
   ADM_info("[Bridge] Starting with time %s , shift %" PRIi32" ms\n",ADM_us2plain(startInMs*1000LL),-shiftMs);
   // If shiftMS is > 0, it means we have to go in the future, just increase _startTime
@@ -99,6 +104,53 @@ AUDMAudioFilter_Bridge::AUDMAudioFilter_Bridge(ADM_edAudioTrack *incoming,
 AUDMAudioFilter_Bridge::~AUDMAudioFilter_Bridge()
 {
   printf("[Bridge] Destroying bridge\n");
+  if(_prefetch)
+    delete _prefetch;
+  _prefetch=NULL;
+}
+/**
+    \fn enablePrefetch
+    \brief Demux and decode on a separate thread, so that the tracks of an export decode
+            in parallel with each other and with the audio encoders. The thread is started
+            on the first read.
+*/
+void AUDMAudioFilter_Bridge::enablePrefetch(void)
+{
+  _prefetchEnabled=true;
+}
+/**
+    \fn decodeAhead
+    \brief Runs on the prefetch thread
+*/
+bool AUDMAudioFilter_Bridge::decodeAhead(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet)
+{
+  ADM_edAudioTrack *track=(ADM_edAudioTrack *)cookie;
+  uint32_t samples=0;
+  uint64_t dts=ADM_NO_PTS;
+  if(false==track->getPCMPacket((float *)buffer,bufferSize/sizeof(float),&samples,&dts))
+    return false;
+  packet->samples=samples;
+  packet->dts=dts;
+  packet->len=samples*track->getOutputChannels()*sizeof(float);
+  return true;
+}
+/**
+    \fn getPCMPacket
+    \brief From the prefetch thread if enabled, else directly from the track
+*/
+bool AUDMAudioFilter_Bridge::getPCMPacket(float *dest,uint32_t sizeMax,uint32_t *samples,uint64_t *dts)
+{
+  if(!_prefetchEnabled)
+    return _incoming->getPCMPacket(dest,sizeMax,samples,dts);
+  if(!_prefetch)
+    _prefetch=new ADM_packetPrefetch("audio decode",decodeAhead,_incoming,BRIDGE_PREFETCH_FLOATS*sizeof(float));
+  ADM_assert(sizeMax>=BRIDGE_PREFETCH_FLOATS);
+  ADM_prefetchPacket packet;
+  if(!_prefetch->getPacket((uint8_t *)dest,sizeMax*sizeof(float),&packet))
+    return false;
+  *samples=packet.samples;
+  *dts=packet.dts;
+  return true;
 }
 /**
     \fn rewind
@@ -106,6 +158,10 @@ AUDMAudioFilter_Bridge::~AUDMAudioFilter_Bridge()
 uint8_t AUDMAudioFilter_Bridge::rewind(void)
 {
   ADM_info("[AudioBridge] Going to time %s\n",ADM_us2plain(_startTimeUs));
+  // The track cannot seek while it is being read, the thread is restarted on the next read
+  if(_prefetch)
+    delete _prefetch;
+  _prefetch=NULL;
   uint8_t r= _incoming->goToTime(_startTimeUs);
   if(!r) ADM_warning("[AudioBridge] Failed!\n");
   _hold=_held;
@@ -154,7 +210,7 @@ uint8_t AUDMAudioFilter_Bridge::fillIncomingBuffer(AUD_Status *status)
     {
       // don't ask too much front.
       asked = (3*AUD_PROCESS_BUFFER_SIZE)/4-_tail;
-      if(false==_incoming->getPCMPacket(_incomingBuffer.at(_tail), asked, &got,&dts))
+      if(false==getPCMPacket(_incomingBuffer.at(_tail), asked, &got,&dts))
       {
           got=0;
           dts=ADM_NO_PTS;
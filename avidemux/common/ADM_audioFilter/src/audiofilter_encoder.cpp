@@ -98,6 +98,9 @@ AUDMAudioFilter *createEncodingFilter(EditableAudioTrack *ed, uint64_t startTime
     //
     int last=ed->EncodingVector.size();
     ADM_assert(last);
+    // The bridge is always first, decode this track on its own thread
+    AUDMAudioFilter_Bridge *bridge=(AUDMAudioFilter_Bridge *)ed->EncodingVector[0];
+    bridge->enablePrefetch();
     return ed->EncodingVector[last-1];
 }
 /**
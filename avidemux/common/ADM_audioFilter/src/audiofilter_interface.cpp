@@ -21,13 +21,25 @@
 
 extern int DIA_getAudioFilter(ADM_AUDIOFILTER_CONFIG *config);
 
+/**
+    \fn filtersChanged
+    \brief The normalize peaks found so far were measured with other filters, forget them
+*/
+static void filtersChanged(bool changed)
+{
+    if(changed)
+        AUDMAudioFilterNormalize::clearScanCache();
+}
+
 /**
     \fn audioFilterconfigure
     \brief
 */
 bool ADM_AUDIOFILTER_CONFIG::audioFilterConfigure(void)
 {
-    return DIA_getAudioFilter(this);
+    bool r=DIA_getAudioFilter(this);
+    filtersChanged(r);
+    return r;
 }
 
 /**
@@ -36,6 +48,7 @@ bool ADM_AUDIOFILTER_CONFIG::audioFilterConfigure(void)
 */
 bool    ADM_AUDIOFILTER_CONFIG::audioFilterSetResample(uint32_t newfq)  // Set 0 to disable frequency
 {
+    filtersChanged(newfq!=audioFilterGetResample());
     if(!newfq) resamplerEnabled=false;
         else        
             {
@@ -62,6 +75,7 @@ uint32_t        ADM_AUDIOFILTER_CONFIG::audioFilterGetResample(void)  // Set 0 t
 
 bool    ADM_AUDIOFILTER_CONFIG::audioFilterSetFrameRate(FILMCONV conf)
 {
+    filtersChanged(film2pal!=conf);
     film2pal=conf;
     return true;
 }
@@ -87,6 +101,7 @@ bool ADM_AUDIOFILTER_CONFIG::audioFilterSetNormalize( ADM_GAINMode mode, int32_t
         return false;
     }
 
+    filtersChanged(gainParam.mode!=mode || gainParam.gain10!=gain || gainParam.maxlevel10!=limit);
     gainParam.mode=mode;
     gainParam.gain10=gain;
     gainParam.maxlevel10=limit;
@@ -111,6 +126,7 @@ bool ADM_AUDIOFILTER_CONFIG::audioFilterGetNormalize( ADM_GAINMode *mode, int32_
 
 bool    ADM_AUDIOFILTER_CONFIG::audioFilterSetMixer(CHANNEL_CONF conf) // Invalid to disable
 {
+    filtersChanged(conf!=audioFilterGetMixer());
     if(conf==CHANNEL_INVALID)
     {
         mixerEnabled=false;
@@ -137,6 +153,7 @@ CHANNEL_CONF    ADM_AUDIOFILTER_CONFIG::audioFilterGetMixer(void) // Invalid to
 */
 bool            ADM_AUDIOFILTER_CONFIG::audioFilterSetShift( bool enabled ,int32_t shift)
 {
+	filtersChanged(shiftEnabled!=enabled || shiftInMs!=shift);
 	shiftEnabled=enabled;
 	shiftInMs=shift;
 	return true;	
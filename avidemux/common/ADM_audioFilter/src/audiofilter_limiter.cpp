@@ -100,39 +100,57 @@ AUDMAudioFilterLimiter::~AUDMAudioFilterLimiter()
   ADM_info("[DRC] Destroyed\n");
 }
 
-uint32_t   AUDMAudioFilterLimiter::fill(uint32_t max,float *output,AUD_Status *status)
+/**
+    \fn process
+    \brief Compress len floats in place, len must be less than DELIM_WINDOW_SIZE
+*/
+void AUDMAudioFilterLimiter::process(float *samples,uint32_t len)
 {
-  uint32_t len,i;
-  
-  shrink();
-  fillIncomingBuffer(status);
-  
-  
-  len=_tail-_head;
-  if(len>max) len=max;
-  if(len>=DELIM_WINDOW_SIZE) len=DELIM_WINDOW_SIZE-1;
-  
-  // Count in full sample  i.e. all channels
-  len=len-(len%_wavHeader.channels);
-  
-  // Process..
+  uint32_t i;
   if (mLastLevel == 0.0) {
     int preSeed = mCircleSize;
     if (preSeed > len)
       preSeed = len;
     for(i=0; i<preSeed; i++)
-      AvgCircle(_incomingBuffer[_head+i]);
+      AvgCircle(samples[i]);
   }
   
     for (i = 0; i < len; i++) {
-      Follow(_incomingBuffer[_head+i], &follow[i], i);
+      Follow(samples[i], &follow[i], i);
     }
 
     for (i = 0; i < len; i++) {
-      output[i] =DoCompression(_incomingBuffer[_head+i], follow[i]);
+      samples[i] =DoCompression(samples[i], follow[i]);
     }  
-    _head+=len;
-    return len;
+}
+/**
+    \fn getBlock
+    \brief Work in place on the previous block, by windows of less than DELIM_WINDOW_SIZE
+*/
+uint32_t   AUDMAudioFilterLimiter::getBlock(float **data,AUD_Status *status)
+{
+  float *in;
+  uint32_t nb=_previous->getBlock(&in,status);
+  if(!nb)
+    return 0;
+  // Count in full sample  i.e. all channels
+  uint32_t window=DELIM_WINDOW_SIZE-1;
+  window-=window%_wavHeader.channels;
+  for(uint32_t done=0;done<nb;done+=window)
+  {
+    uint32_t len=nb-done;
+    if(len>window) len=window;
+    process(in+done,len);
+  }
+  *data=in;
+  return nb;
+}
+/**
+    \fn fill
+*/
+uint32_t   AUDMAudioFilterLimiter::fill(uint32_t max,float *output,AUD_Status *status)
+{
+  return fillFromBlocks(max,output,status);
 }
 
 float AUDMAudioFilterLimiter::AvgCircle(float value)
@@ -117,13 +117,6 @@ AUDMAudioFilterMixer::~AUDMAudioFilterMixer()
 {
 };
 
-static int MCOPY(float *in,float *out,uint32_t nbSample,uint32_t chan)
-{
-    memcpy(out,in,nbSample*chan*sizeof(float));
-    return nbSample*chan;
-    
-}
-
 static int MNto1(float *in,float *out,uint32_t nbSample,uint32_t chan,CHANNEL_TYPE *chanMap,AUDMAudioFilterMixer *me)
 {
 float sum;
@@ -567,62 +560,44 @@ typedef int MIXER(float *in,float *out,uint32_t nbSample,uint32_t chan,CHANNEL_T
 static MIXER *matrixCall[CHANNEL_LAST] = {
 NULL, MNto1, MStereo, M2F1R, M3F, M3F1R, M2F2R, M3F2R, M3F2RLFE, MDolbyProLogic, MDolbyProLogic2
 };
-//_____________________________________________
-uint32_t AUDMAudioFilterMixer::fill(uint32_t max,float *output,AUD_Status *status)
+/**
+    \fn getBlock
+    \brief Mix the previous block into ours, or hand it over as is when the channels are unchanged
+*/
+uint32_t AUDMAudioFilterMixer::getBlock(float **data,AUD_Status *status)
 {
-
-    uint32_t rd = 0;
-    int nbSampleMax=max/_wavHeader.channels;
-    if(!nbSampleMax) nbSampleMax=1;
-    uint8_t input_channels = _previous->getInfo()->channels;
-
-// Fill incoming buffer
-    shrink();
-    fillIncomingBuffer(status);
-    // Block not filled ?
-    if((_tail-_head)<input_channels)
-    {
-      if(*status==AUD_END_OF_STREAM && _head)
-      {
-        memset(_incomingBuffer.at(_head),0,sizeof(float) * input_channels);
-        _tail=_head+input_channels;
-        printf("[Mixer] Warning asked %u symbols\n",max);
-      }
-      else
-      {
+    uint32_t input_channels = _previous->getInfo()->channels;
+    float *in;
+    uint32_t nb=_previous->getBlock(&in,status);
+    if(!nb)
         return 0;
-      }
-    }
-    // How many ?
-
-    // Let's go
-    int available=0;
-    if(!nbSampleMax)
+    // Incomplete sample at the end of the stream
+    uint32_t partial=nb%input_channels;
+    if(partial)
     {
-      printf("[Mixer] Warning max %u, channels %u\n",max,input_channels);
+        printf("[Mixer] Warning incomplete sample (%u symbols)\n",partial);
+        memset(in+nb,0,sizeof(float)*(input_channels-partial));
+        nb+=input_channels-partial;
     }
-    available=(_tail-_head)/input_channels; // nb Sample
-    ADM_assert(available);
-    if(available > nbSampleMax) available=nbSampleMax;
-    
-    ADM_assert(available);
-    
+    uint32_t available=nb/input_channels;
 
-    // Now do the downsampling
 	if (_output == CHANNEL_INVALID || true==ADM_audioCompareChannelMapping(&_wavHeader, _previous->getInfo(),
 			_previous->getChannelMapping(),outputChannelMapping))
 	{
-		
-		rd= (uint32_t)MCOPY(_incomingBuffer.at(_head),output,available,input_channels);
-	} else 
-	{
-		MIXER *call=matrixCall[_output];
-		rd= (uint32_t)call(_incomingBuffer.at(_head),output,available,input_channels,_previous->getChannelMapping(),this);
+		*data=in;
+		return nb;
 	}
-
-    _head+=available*input_channels;
-    return rd;
-    
+    float *out=getBlockBuffer();
+    MIXER *call=matrixCall[_output];
+    *data=out;
+    return (uint32_t)call(in,out,available,input_channels,_previous->getChannelMapping(),this);
+}
+/**
+    \fn fill
+*/
+uint32_t AUDMAudioFilterMixer::fill(uint32_t max,float *output,AUD_Status *status)
+{
+    return fillFromBlocks(max,output,status);
 }
 /**
     \fn AudioMixerIdToString
@@ -21,8 +21,11 @@
 
 
 
+#include "ADM_cpp.h"
+#include <map>
 #include "ADM_default.h"
 #include <math.h>
+#include "ADM_threads.h"
 #include "ADM_audioFilter.h"
 #include "audiofilter_normalize_param.h"
 #include "audiofilter_normalize.h"
@@ -41,15 +44,29 @@
 #define LINEAR_TO_DB(x) (20.*log10(x))
 #define DB_TO_LINEAR(x) (POW10((x/20.)))
 
-static int32_t max_level_x10;
+/*
+    Peak values found by previous scans, indexed by the description of what is upstream
+    (source file(s), track, segment layout, upstream filters).
+    Saving the same source again does not need to decode the whole track a second time.
+    The cache is cleared when a file is opened or closed and when the audio filters change.
+*/
+#define ADM_NORMALIZE_MAX_SCANS 32
+typedef std::map<std::string,float> ListOfScannedPeaks;
+static ListOfScannedPeaks scannedPeaks;
+static admMutex           scannedPeaksLock("normalizeCache");
 
 /**
         \fn Ctor
 **/
 
-AUDMAudioFilterNormalize::AUDMAudioFilterNormalize(AUDMAudioFilter * instream,GAINparam *param):AUDMAudioFilter (instream)
+AUDMAudioFilterNormalize::AUDMAudioFilterNormalize(AUDMAudioFilter * instream,GAINparam *param,const std::string &scanKey):AUDMAudioFilter (instream)
 {
   float db_out;
+  _maxLevel10=param->maxlevel10;
+  _scanKey=scanKey;
+  _scanRunning=false;
+  _scanAbort=false;
+  _scanPeak=0;
     // nothing special here...
   switch(param->mode)
   {
@@ -57,8 +74,19 @@ AUDMAudioFilterNormalize::AUDMAudioFilterNormalize(AUDMAudioFilter * instream,GA
     case ADM_GAIN_AUTOMATIC:
                 _ratio=1;
                 _scanned=0;
-                max_level_x10 = param->maxlevel10;
-                ADM_info("[Gain] Automatic gain, max level %.1f\n",max_level_x10/10.0);
+                ADM_info("[Gain] Automatic gain, max level %.1f\n",_maxLevel10/10.0);
+                if(_scanKey.size())
+                {
+                    scannedPeaksLock.lock();
+                    ListOfScannedPeaks::iterator it=scannedPeaks.find(_scanKey);
+                    if(it!=scannedPeaks.end())
+                    {
+                        ADM_info("[Normalize] Reusing previous scan, max value %0.4f\n",it->second);
+                        computeRatio(it->second);
+                        _scanned=1;
+                    }
+                    scannedPeaksLock.unlock();
+                }
                 break;
     case ADM_GAIN_MANUAL: 
                 _scanned=1;
@@ -73,6 +101,13 @@ AUDMAudioFilterNormalize::AUDMAudioFilterNormalize(AUDMAudioFilter * instream,GA
                 break;
   }
     _previous->rewind();
+    // Search the peak in the background while the rest of the export gets ready
+    if(!_scanned)
+    {
+        _scanRunning=!pthread_create(&_scanThread,NULL,scanEntry,this);
+        if(!_scanRunning)
+            ADM_warning("[Normalize] Cannot create the scan thread, the peak will be searched on the first block\n");
+    }
 };
 /**
         \fn dtor
@@ -80,18 +115,52 @@ AUDMAudioFilterNormalize::AUDMAudioFilterNormalize(AUDMAudioFilter * instream,GA
 AUDMAudioFilterNormalize::~AUDMAudioFilterNormalize()
 {
         ADM_info("Destroying normalize audio filter\n");
+        if(_scanRunning)
+        {
+            _scanAbort=true;
+            pthread_join(_scanThread,NULL);
+            _scanRunning=false;
+        }
 }
 /**
-        \fn preprocess
-        \brief Search for max value to compute gain
+        \fn scanEntry
 */
-uint8_t AUDMAudioFilterNormalize::preprocess(void)
+void *AUDMAudioFilterNormalize::scanEntry(void *me)
+{
+    AUDMAudioFilterNormalize *norm=(AUDMAudioFilterNormalize *)me;
+    norm->_scanPeak=norm->scanPeak();
+    return NULL;
+}
+/**
+        \fn waitScan
+        \brief Wait for the background scan and use its result, the upstream filters are ours again after that
+*/
+void AUDMAudioFilterNormalize::waitScan(void)
+{
+    if(!_scanRunning)
+        return;
+    pthread_join(_scanThread,NULL);
+    _scanRunning=false;
+    computeRatio(_scanPeak);
+    storePeak(_scanPeak);
+    _scanned=1;
+}
+/**
+        \fn clearScanCache
+*/
+void AUDMAudioFilterNormalize::clearScanCache(void)
+{
+    scannedPeaksLock.lock();
+    scannedPeaks.clear();
+    scannedPeaksLock.unlock();
+}
+/**
+        \fn scanPeak
+        \brief Decode the whole stream and return the maximum absolute value across all channels
+*/
+float AUDMAudioFilterNormalize::scanPeak(void)
 {
-
-
-    uint32_t scanned = 0;
     AUD_Status status;
-    _ratio = 0;
 
     float *max=new float[_wavHeader.channels];
     _previous->rewind();
@@ -99,9 +168,10 @@ uint8_t AUDMAudioFilterNormalize::preprocess(void)
     ADM_info("Seeking for maximum value, that can take a while\n");
 
       for(int i=0;i<_wavHeader.channels;i++) max[i]=0;
-      while (1)
+      while (!_scanAbort)
       {
-          int ready=_previous->fill(AUD_PROCESS_BUFFER_SIZE>>2,_incomingBuffer.at(0),&status);
+          float *block;
+          int ready=_previous->getBlock(&block,&status);
           if(!ready)
           {
             if(status==AUD_END_OF_STREAM) 
@@ -119,20 +189,16 @@ uint8_t AUDMAudioFilterNormalize::preprocess(void)
           int index=0;
           float current;
           
-        //  printf("*\n");
           int sample= ready /_wavHeader.channels;
           for(int j=0;j<sample;j++)
             for(int chan=0;chan<_wavHeader.channels;chan++)
           {
-            current=fabs(_incomingBuffer[index++]);
+            current=fabs(block[index++]);
             if(current>max[chan]) max[chan]=current;
           }
-          scanned+=ready;
       }
-      
-      
-      
 
+    ADMDolbyContext::DolbySkip(0);
     _previous->rewind();
     float mx=0;
     for(int chan=0;chan<_wavHeader.channels;chan++)
@@ -140,8 +206,17 @@ uint8_t AUDMAudioFilterNormalize::preprocess(void)
         if(max[chan]>mx) mx=max[chan];
         ADM_info("[Normalize] maximum found for channel %d : %f\n", chan,max[chan]);
     }
+    delete [] max;
+    return mx;
+}
+/**
+        \fn computeRatio
+        \brief Compute the gain so that peak ends up at the requested max level
+*/
+void AUDMAudioFilterNormalize::computeRatio(float mx)
+{
     ADM_info("[Normalize] Using : %0.4f as max value \n", mx);
-    double db_in, db_out=max_level_x10/10.0;
+    double db_in, db_out=_maxLevel10/10.0;
 
     if (mx>0.001)
       db_in = LINEAR_TO_DB(mx);
@@ -150,44 +225,73 @@ uint8_t AUDMAudioFilterNormalize::preprocess(void)
 
     printf("--> %2.2f db / %2.2f \n", db_in, db_out);
 
-    // search ratio
-    _ratio=1;
-
     float db_delta=db_out-db_in;
     ADM_info("[Normalize]Gain %f dB\n",db_delta);
     _ratio = DB_TO_LINEAR(db_delta);
     ADM_info("\n Using ratio of : %f\n", _ratio);
-
+}
+/**
+        \fn preprocess
+        \brief Search for max value to compute gain
+*/
+uint8_t AUDMAudioFilterNormalize::preprocess(void)
+{
+    float mx=scanPeak();
+    computeRatio(mx);
+    storePeak(mx);
     _scanned = 1;
-    ADMDolbyContext::DolbySkip(0);
-    _previous->rewind();
-    delete [] max;
     return 1;
 }
 /**
-        \fn fill
-        \brief
+        \fn storePeak
+        \brief Remember the peak for the next chain with the same upstream
 */
-uint32_t AUDMAudioFilterNormalize::fill( uint32_t max, float * buffer,AUD_Status *status)
+void AUDMAudioFilterNormalize::storePeak(float peak)
+{
+    if(!_scanKey.size())
+        return;
+    scannedPeaksLock.lock();
+    if(scannedPeaks.size()>=ADM_NORMALIZE_MAX_SCANS)
+        scannedPeaks.clear();
+    scannedPeaks[_scanKey]=peak;
+    scannedPeaksLock.unlock();
+}
+/**
+        \fn rewind
+*/
+uint8_t AUDMAudioFilterNormalize::rewind(void)
+{
+    waitScan();
+    return AUDMAudioFilter::rewind();
+}
+/**
+        \fn getBlock
+        \brief Apply the gain in place on the previous block
+*/
+uint32_t AUDMAudioFilterNormalize::getBlock(float **data,AUD_Status *status)
 {
-    uint32_t rd, i;
-
     *status=AUD_OK;
+    if(_scanRunning) waitScan();
     if(!_scanned) preprocess();
-    rd = _previous->fill(max, _incomingBuffer.at(0),status);
+    float *block;
+    uint32_t rd = _previous->getBlock(&block,status);
     if(!rd)
     {
       if(*status==AUD_END_OF_STREAM) return 0;
       ADM_assert(0);
     }
-    float tmp;
-    for (i = 0; i < rd; i++)
-    {
-      tmp=_incomingBuffer[i];
-      tmp*=_ratio;
-      buffer[i]=tmp;
-    }
+    float ratio=_ratio;
+    for (uint32_t i = 0; i < rd; i++)
+      block[i]*=ratio;
+    *data=block;
     return rd;
+}
+/**
+        \fn fill
+        \brief
+*/
+uint32_t AUDMAudioFilterNormalize::fill( uint32_t max, float * buffer,AUD_Status *status)
+{
+    return fillFromBlocks(max,buffer,status);
 };
 //EOF
-
@@ -18,6 +18,7 @@ using std::string;
 #include "ADM_default.h"
 #include "ADM_edit.hxx"
 #include "audiofilter_thread.h"
+#include "ADM_trace.h"
 #include <math.h>
 
 #define MAX_CHUNK_IN_QUEUE 10
@@ -56,7 +57,10 @@ ADM_audioAccess_thread::ADM_audioAccess_thread(ADM_audioAccess *son) :ADM_thread
             ListOfByteBuffers.append(buff);
 
     }
-    
+    encodeStats=ADM_stageStatsCreate("audio encode");
+    queueStats=ADM_stageStatsCreate("audio queue");
+    if(queueStats)
+        queueStats->setQueueSize(MAX_CHUNK_IN_QUEUE);
 }
 /**
     \fn ~ADM_audioAccess_thread
@@ -119,11 +123,21 @@ bool    ADM_audioAccess_thread::getPacket(uint8_t *buffer, uint32_t *size, uint3
     {
         startThread();      
     }
+    ADM_stageTimer timer;
+    ADM_TRACE_SCOPE("queue wait","audio queue");
+    bool waited=false;
     while(1)
     {
         mutex->lock();
         if(list.size())
         {
+            if(queueStats)
+            {
+                queueStats->sampleQueue(list.size());
+                if(waited)
+                    queueStats->addStarved();
+            }
+            ADM_TRACE_COUNTER("audio queue",list.size()-1);
             //
             // Dequeue one item
             ADM_queuePacket pkt=list[0];
@@ -143,6 +157,8 @@ bool    ADM_audioAccess_thread::getPacket(uint8_t *buffer, uint32_t *size, uint3
                 cond->wakeup();
             }
             mutex->unlock();
+            if(queueStats)
+                queueStats->addCall(timer.stop(),true);
             return true;
         }
         // If no item, thread still alive ?
@@ -150,9 +166,12 @@ bool    ADM_audioAccess_thread::getPacket(uint8_t *buffer, uint32_t *size, uint3
         {
             ADM_info("Audio thread stopped, no more data\n");
             mutex->unlock();
+            if(queueStats)
+                queueStats->addCall(timer.stop(),false);
             return false;
         }
         mutex->unlock();
+        waited=true;
         ADM_usleep(2*1000); // wait 10 ms
     }
     return false;
@@ -163,6 +182,7 @@ bool    ADM_audioAccess_thread::getPacket(uint8_t *buffer, uint32_t *size, uint3
 */
 bool ADM_audioAccess_thread::runAction(void)
 {
+    ADM_traceSetThreadName("audio");
     while(1)
     {
         if(threadState==RunStateStopOrder)  
@@ -173,6 +193,9 @@ bool ADM_audioAccess_thread::runAction(void)
         mutex->lock();
         if(!freeList.size())
         {
+            if(queueStats)
+                queueStats->addBlocked();
+            ADM_TRACE_INSTANT("audio queue","full");
             cond->wait();
             continue;
         }
@@ -181,7 +204,15 @@ bool ADM_audioAccess_thread::runAction(void)
         freeList.popFront();
         mutex->unlock();
 
-        if(false==son->getPacket(pkt.data,&(pkt.dataLen),CHUNK_SIZE,&(pkt.dts)))
+        ADM_stageTimer timer;
+        bool got;
+        {
+            ADM_TRACE_SCOPE("audio","encode");
+            got=son->getPacket(pkt.data,&(pkt.dataLen),CHUNK_SIZE,&(pkt.dts));
+        }
+        if(encodeStats)
+            encodeStats->addCall(timer.stop(),got);
+        if(false==got)
         {
             ADM_info("Audio Thread, no more data\n");
             freeList.append(pkt);
@@ -190,6 +221,7 @@ bool ADM_audioAccess_thread::runAction(void)
       
         mutex->lock();
         list.append(pkt);
+        ADM_TRACE_COUNTER("audio queue",list.size());
         //printf("Pushing Packet with DTS=%"PRId64",size=%d\n",dts,(int)size);
         mutex->unlock();
     }
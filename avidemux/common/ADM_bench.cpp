@@ -0,0 +1,880 @@
+/***************************************************************************
+    \file ADM_bench.cpp
+    \brief Headless benchmark of the individual components (avidemux_bench)
+
+    Plugins are loaded as usual, then each component is fed on its own
+    and timed :
+        - color conversions / resize
+        - each video filter with its default configuration
+        - each video encoder with its current configuration,
+          the bitstream is kept to time the matching decoder
+        - demuxing and decoding of the sample files given on the command line
+    Synthetic pictures are generated once before timing starts so that
+    only the component itself is measured.
+    The results are written as json.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_cpuCap.h"
+#include "ADM_coreJson.h"
+#include "ADM_colorspace.h"
+#include "ADM_pp.h"
+#include "ADM_codec.h"
+#include "ADM_compressedImage.h"
+#include "ADM_bitstream.h"
+#include "ADM_coreDemuxer.h"
+#include "ADM_coreVideoFilter.h"
+#include "ADM_coreVideoFilterFunc.h"
+#include "ADM_coreVideoEncoder.h"
+#include "ADM_videoEncoderApi.h"
+#include "fourcc.h"
+
+uint32_t ADM_ve6_getNbEncoders(void);
+bool     ADM_ve6_getEncoderInfo(int filter, const char **name, uint32_t *major,uint32_t *minor,uint32_t *patch);
+
+#define BENCH_DEFAULT_FRAMES    100
+#define BENCH_POOL_SIZE         8       // Distinct synthetic pictures, cycled
+#define BENCH_FRAME_INCREMENT   40000   // 25 fps
+#define BENCH_PACKET_PADDING    64
+#define BENCH_MAX_DRAIN         128
+#define BENCH_FILE_FACTOR       10      // At most that many times --frames are read from a sample file
+#define BENCH_DEFAULT_OUTPUT    "avidemux_bench.json"
+
+#define BENCH_COLORS    1
+#define BENCH_FILTERS   2
+#define BENCH_ENCODERS  4   // Also times the decoders on the encoded streams
+#define BENCH_DEMUXERS  8   // Sample files, demux + decode
+#define BENCH_POSTPROC  16  // Banded postprocessing, checked against a single whole frame call
+#define BENCH_PP_MAX_STRENGTH 5 // Same range as the postprocessing dialog
+#define BENCH_ALL       0xff
+
+/**
+    \struct benchSize
+*/
+typedef struct
+{
+    uint32_t w,h;
+}benchSize;
+
+/**
+    \struct benchParams
+*/
+typedef struct
+{
+    uint32_t                    what;
+    uint32_t                    nbFrames;
+    std::string                 output;
+    std::string                 match;     // Only run items whose name contains that
+    std::vector <benchSize>     sizes;
+    std::vector <std::string>   files;
+}benchParams;
+
+/**
+    \struct benchPacket
+    \brief Encoded frame kept to feed the decoder
+*/
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+    uint32_t flags;
+    uint64_t pts;
+    uint64_t dts;
+}benchPacket;
+
+/**
+    \class benchSource
+    \brief First filter of the chain, returns pregenerated pictures
+*/
+class benchSource : public ADM_coreVideoFilter
+{
+protected:
+        ADMImageDefault     *pool[BENCH_POOL_SIZE];
+        uint32_t            nbFrames;
+public:
+                            benchSource(uint32_t w,uint32_t h,uint32_t nbFrames);
+        virtual             ~benchSource();
+        virtual const char  *getConfiguration(void) {return "synthetic";}
+        virtual bool        goToTime(uint64_t usSeek);
+        virtual bool        getNextFrame(uint32_t *frameNumber,ADMImage *image);
+        virtual FilterInfo  *getInfo(void) {return &info;}
+        virtual bool        getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+        virtual void        setCoupledConf(CONFcouple *couples) {}
+        virtual uint64_t    getAbsoluteStartTime(void) {return 0;}
+        virtual bool        getTimeRange(uint64_t *start, uint64_t *end)
+                                {*start=0;*end=info.totalDuration;return true;}
+                void        rewind(void) {nextFrame=0;}
+};
+
+/**
+    \fn fillPlane
+    \brief Moving gradient + noise so that neither the encoders nor the filters get a trivial picture
+*/
+static void fillPlane(uint8_t *p,int pitch,int w,int h,int phase,uint32_t *seed)
+{
+    for(int y=0;y<h;y++)
+    {
+        for(int x=0;x<w;x++)
+        {
+            *seed=*seed*1103515245+12345;
+            int v=((x+y+phase)&0xff)/2+64+((*seed>>16)&0x1f)-16;
+            p[x]=(uint8_t)v;
+        }
+        p+=pitch;
+    }
+}
+/**
+    \fn ctor
+*/
+benchSource::benchSource(uint32_t w,uint32_t h,uint32_t nb) : ADM_coreVideoFilter(NULL,NULL)
+{
+    myName="benchSource";
+    nbFrames=nb;
+    info.width=w;
+    info.height=h;
+    info.frameIncrement=BENCH_FRAME_INCREMENT;
+    info.timeBaseNum=1;
+    info.timeBaseDen=1000000/BENCH_FRAME_INCREMENT;
+    info.totalDuration=(uint64_t)nb*BENCH_FRAME_INCREMENT;
+    uint32_t seed=1;
+    for(int i=0;i<BENCH_POOL_SIZE;i++)
+    {
+        ADMImageDefault *img=new ADMImageDefault(w,h);
+        fillPlane(img->GetWritePtr(PLANAR_Y),img->GetPitch(PLANAR_Y),w,h,i*4,&seed);
+        fillPlane(img->GetWritePtr(PLANAR_U),img->GetPitch(PLANAR_U),w/2,h/2,i*2,&seed);
+        fillPlane(img->GetWritePtr(PLANAR_V),img->GetPitch(PLANAR_V),w/2,h/2,255-i*2,&seed);
+        img->flags=AVI_KEY_FRAME;
+        pool[i]=img;
+    }
+}
+/**
+    \fn dtor
+*/
+benchSource::~benchSource()
+{
+    for(int i=0;i<BENCH_POOL_SIZE;i++)
+    {
+        delete pool[i];
+        pool[i]=NULL;
+    }
+}
+/**
+    \fn goToTime
+*/
+bool benchSource::goToTime(uint64_t usSeek)
+{
+    nextFrame=usSeek/BENCH_FRAME_INCREMENT;
+    return true;
+}
+/**
+    \fn getNextFrame
+*/
+bool benchSource::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    if(nextFrame>=nbFrames)
+        return false;
+    image->duplicate(pool[nextFrame%BENCH_POOL_SIZE]);
+    image->Pts=(uint64_t)nextFrame*BENCH_FRAME_INCREMENT;
+    *frameNumber=nextFrame;
+    nextFrame++;
+    return true;
+}
+
+/**
+    \fn wanted
+*/
+static bool wanted(const benchParams &params,const std::string &name)
+{
+    if(params.match.empty())
+        return true;
+    return name.find(params.match)!=std::string::npos;
+}
+/**
+    \fn sizeName
+*/
+static std::string sizeName(const benchSize &s)
+{
+    char str[32];
+    snprintf(str,sizeof(str),"%ux%u",s.w,s.h);
+    return std::string(str);
+}
+/**
+    \fn writeTiming
+    \brief Write the common part of a result : frames, fps and per frame time in us
+*/
+static void writeTiming(admJson &json,const char *name,uint32_t frames,uint64_t totalUs,ADMBenchmark &bench)
+{
+    float avg=0;
+    int mn=0,mx=0;
+    if(frames)
+        bench.getResultUs(avg,mn,mx);
+    double fps=0;
+    if(totalUs)
+        fps=(double)frames*1000000./(double)totalUs;
+    json.addUint32("frames",frames);
+    json.addDouble("totalMs",(double)totalUs/1000.);
+    json.addDouble("fps",fps);
+    json.addFloat("avgUs",avg);
+    json.addInt32("minUs",mn);
+    json.addInt32("maxUs",mx);
+    ADM_info("[bench] %-40s %6u frames %9.2f fps\n",name,frames,fps);
+}
+
+/**
+    \fn benchColors
+*/
+static void benchColors(const benchParams &params,admJson &json)
+{
+    static const struct
+    {
+        ADM_colorspace  from,to;
+        const char      *name;
+        bool            half;   // downscale by 2 at the same time
+    }conversions[]=
+    {
+        {ADM_COLOR_YV12,   ADM_COLOR_RGB32A, "YV12 to RGB32A",false},
+        {ADM_COLOR_YV12,   ADM_COLOR_RGB24,  "YV12 to RGB24",false},
+        {ADM_COLOR_YV12,   ADM_COLOR_YUV422, "YV12 to YUY2",false},
+        {ADM_COLOR_RGB32A, ADM_COLOR_YV12,   "RGB32A to YV12",false},
+        {ADM_COLOR_RGB24,  ADM_COLOR_YV12,   "RGB24 to YV12",false},
+        {ADM_COLOR_YV12,   ADM_COLOR_YV12,   "YV12 resize half",true}
+    };
+    json.addNode("colorConversions");
+    for(int s=0;s<params.sizes.size();s++)
+    {
+        const benchSize &sz=params.sizes[s];
+        uint32_t bufferSize=sz.w*sz.h*4;
+        uint8_t *src=new uint8_t[bufferSize];
+        uint8_t *dst=new uint8_t[bufferSize];
+        uint32_t seed=1;
+        fillPlane(src,sz.w*4,sz.w*4,sz.h,0,&seed);
+        for(int c=0;c<sizeof(conversions)/sizeof(conversions[0]);c++)
+        {
+            std::string name=std::string(conversions[c].name)+" "+sizeName(sz);
+            if(!wanted(params,name))
+                continue;
+            int dw=sz.w,dh=sz.h;
+            if(conversions[c].half)
+            {
+                dw=(sz.w/2)&~1;
+                dh=(sz.h/2)&~1;
+            }
+            ADMColorScalerFull scaler(ADM_CS_BICUBIC,sz.w,sz.h,dw,dh,conversions[c].from,conversions[c].to);
+            ADMBenchmark bench;
+            Clock clk;
+            uint32_t done=0;
+            scaler.convert(src,dst); // warm up
+            clk.reset();
+            for(int i=0;i<params.nbFrames;i++)
+            {
+                bench.start();
+                bool r=scaler.convert(src,dst);
+                bench.end();
+                if(!r) break;
+                done++;
+            }
+            uint64_t total=clk.getElapsedUS();
+            json.addNode(name.c_str());
+            writeTiming(json,name.c_str(),done,total,bench);
+            json.endNode();
+        }
+        delete [] src;
+        delete [] dst;
+    }
+    json.endNode();
+}
+
+/**
+    \fn samePicture
+*/
+static bool samePicture(ADMImage *a,ADMImage *b)
+{
+    for(int i=0;i<3;i++)
+    {
+        ADM_PLANE plane=(ADM_PLANE)i;
+        int w=a->GetWidth(plane),h=a->GetHeight(plane);
+        int pa=a->GetPitch(plane),pb=b->GetPitch(plane);
+        uint8_t *ra=a->GetReadPtr(plane),*rb=b->GetReadPtr(plane);
+        for(int y=0;y<h;y++)
+            if(memcmp(ra+y*pa,rb+y*pb,w))
+                return false;
+    }
+    return true;
+}
+/**
+    \fn benchPostProc
+    \brief ADM_PP splits the picture in bands run by the thread pool, the result must be bit exact
+            with a single call on the whole frame, at every strength. Also times both.
+*/
+static void benchPostProc(const benchParams &params,admJson &json)
+{
+    static const struct
+    {
+        uint32_t    type;
+        const char  *name;
+    }modes[]=
+    {
+        {1, "ha"},
+        {2, "va"},
+        {4, "dr"},
+        {8, "fd"},
+        {7, "ha+va+dr"},
+        {13,"ha+dr+fd"},
+        {15,"ha+va+dr+fd"}  // not banded, see ADM_PP::setupBands
+    };
+    static const benchSize ppSizes[]={{176,144},{720,576},{1280,720},{1918,1080}};
+    bool allExact=true;
+    json.addNode("postProc");
+    for(int s=0;s<sizeof(ppSizes)/sizeof(ppSizes[0]);s++)
+    {
+        const benchSize &sz=ppSizes[s];
+        ADMImageDefault src(sz.w,sz.h),whole(sz.w,sz.h),banded(sz.w,sz.h);
+        uint32_t seed=1;
+        fillPlane(src.GetWritePtr(PLANAR_Y),src.GetPitch(PLANAR_Y),sz.w,sz.h,0,&seed);
+        fillPlane(src.GetWritePtr(PLANAR_U),src.GetPitch(PLANAR_U),sz.w/2,sz.h/2,64,&seed);
+        fillPlane(src.GetWritePtr(PLANAR_V),src.GetPitch(PLANAR_V),sz.w/2,sz.h/2,192,&seed);
+        // Varying quantizers, so that a band reading the wrong rows of the table shows up
+        int qStride=(sz.w+15)>>4;
+        int qRows=(sz.h+15)>>4;
+        uint8_t *quant=new uint8_t[qStride*qRows];
+        for(int i=0;i<qStride*qRows;i++)
+        {
+            seed=seed*1103515245+12345;
+            quant[i]=2+((seed>>16)%30);
+        }
+        src.quant=quant;
+        src._qStride=qStride;
+        src._qSize=qStride*qRows;
+        src.flags=AVI_KEY_FRAME;
+        for(int m=0;m<sizeof(modes)/sizeof(modes[0]);m++)
+        for(int strength=1;strength<=BENCH_PP_MAX_STRENGTH;strength++)
+        {
+            char str[16];
+            snprintf(str,sizeof(str)," s%d ",strength);
+            std::string name=std::string("postproc ")+modes[m].name+str+sizeName(sz);
+            if(!wanted(params,name))
+                continue;
+            ADM_PP pp(sz.w,sz.h);
+            pp.postProcType=modes[m].type;
+            pp.postProcStrength=strength;
+            pp.forcedQuant=0;
+            pp.update();
+            pp.process(&src,&whole,false);
+            pp.process(&src,&banded,true);
+            bool exact=samePicture(&whole,&banded);
+            if(!exact)
+            {
+                ADM_error("[bench] %s : the banded output differs from the whole frame one\n",name.c_str());
+                allExact=false;
+            }
+            json.addNode(name.c_str());
+            json.addUint32("bands",pp.getNbBands());
+            json.addBool("bitExact",exact);
+            // Only time the strongest setting, the others are only checked
+            for(int b=0;strength==BENCH_PP_MAX_STRENGTH && b<2;b++)
+            {
+                bool useBands=!!b;
+                ADMBenchmark bench;
+                Clock clk;
+                for(int i=0;i<params.nbFrames;i++)
+                {
+                    bench.start();
+                    pp.process(&src,&banded,useBands);
+                    bench.end();
+                }
+                uint64_t total=clk.getElapsedUS();
+                std::string timed=name+(useBands? " banded" : " whole");
+                json.addNode(useBands? "banded" : "whole");
+                writeTiming(json,timed.c_str(),params.nbFrames,total,bench);
+                json.endNode();
+            }
+            json.endNode();
+        }
+        src.quant=NULL;
+        delete [] quant;
+    }
+    json.addBool("allBitExact",allExact);
+    json.endNode();
+}
+
+/**
+    \fn benchFilters
+    \brief Each filter, default configuration, directly on top of the synthetic source
+*/
+static void benchFilters(const benchParams &params,admJson &json)
+{
+    json.addNode("videoFilters");
+    for(int s=0;s<params.sizes.size();s++)
+    {
+        const benchSize &sz=params.sizes[s];
+        benchSource source(sz.w,sz.h,params.nbFrames);
+        for(int cat=0;cat<VF_MAX;cat++)
+        {
+            if(cat==VF_HIDDEN || cat==VF_OPENGL)
+                continue;
+            for(int f=0;f<ADM_videoFilterPluginsList[cat].size();f++)
+            {
+                ADM_vf_plugin *plugin=ADM_videoFilterPluginsList[cat][f];
+                if(plugin->neededFeatures && (plugin->neededFeatures() & ADM_FEATURE_OPENGL))
+                    continue;
+                std::string name=std::string(plugin->info.internalName)+" "+sizeName(sz);
+                if(!wanted(params,name))
+                    continue;
+                source.rewind();
+                ADM_coreVideoFilter *filter=ADM_vf_createFromTag(plugin->tag,&source,NULL);
+                if(!filter)
+                {
+                    ADM_warning("Cannot instantiate %s\n",plugin->info.internalName);
+                    continue;
+                }
+                FilterInfo *out=filter->getInfo();
+                ADMImageDefault image(out->width,out->height);
+                ADMBenchmark bench;
+                Clock clk;
+                uint32_t done=0,fn;
+                clk.reset();
+                while(1)
+                {
+                    bench.start();
+                    bool r=filter->getNextFrame(&fn,&image);
+                    bench.end();
+                    if(!r) break;
+                    done++;
+                }
+                uint64_t total=clk.getElapsedUS();
+                json.addNode(name.c_str());
+                json.addString("displayName",plugin->info.displayName);
+                json.addUint32("outWidth",out->width);
+                json.addUint32("outHeight",out->height);
+                writeTiming(json,name.c_str(),done,total,bench);
+                json.endNode();
+                delete filter;
+            }
+        }
+    }
+    json.endNode();
+}
+
+/**
+    \fn benchDecode
+    \brief Time a decoder on packets already in memory
+*/
+static bool benchDecode(decoders *codec,ADMImage *out,uint8_t *data,const std::vector <benchPacket> &packets,
+                        uint32_t *decoded,uint64_t *totalUs,ADMBenchmark &bench)
+{
+    ADMCompressedImage img;
+    Clock clk;
+    uint32_t done=0;
+    clk.reset();
+    for(int i=0;i<packets.size();i++)
+    {
+        const benchPacket &p=packets[i];
+        img.data=data+p.offset;
+        img.dataLength=p.length;
+        img.flags=p.flags;
+        img.demuxerFrameNo=i;
+        img.demuxerPts=p.pts;
+        img.demuxerDts=p.dts;
+        out->_colorspace=ADM_COLOR_YV12;
+        bench.start();
+        bool r=codec->uncompress(&img,out);
+        bench.end();
+        if(r && !out->_noPicture)
+            done++;
+    }
+    codec->setDrainingState(true);
+    if(codec->getDrainingState())
+    {
+        img.dataLength=0;
+        img.demuxerPts=ADM_NO_PTS;
+        img.demuxerDts=ADM_NO_PTS;
+        for(int i=0;i<BENCH_MAX_DRAIN;i++)
+        {
+            out->_colorspace=ADM_COLOR_YV12;
+            bench.start();
+            bool r=codec->uncompress(&img,out);
+            bench.end();
+            if(r)
+            {
+                if(!out->_noPicture)
+                    done++;
+                continue;
+            }
+            if(codec->endOfStreamReached())
+                break;
+        }
+    }
+    *totalUs=clk.getElapsedUS();
+    *decoded=done;
+    return done!=0;
+}
+/**
+    \fn writeDecode
+*/
+static void writeDecode(const char *name,uint32_t fcc,uint32_t w,uint32_t h,uint32_t extraLen,uint8_t *extra,
+                        uint8_t *data,const std::vector <benchPacket> &packets,admJson &json)
+{
+    decoders *codec=ADM_getDecoder(fcc,w,h,extraLen,extra,24);
+    if(!codec)
+    {
+        ADM_warning("No decoder for %s\n",name);
+        return;
+    }
+    ADMImage *out;
+    if(codec->dontcopy())
+        out=new ADMImageRef(w,h);
+    else
+        out=new ADMImageDefault(w,h);
+    ADMBenchmark bench;
+    uint32_t decoded=0;
+    uint64_t total=0;
+    benchDecode(codec,out,data,packets,&decoded,&total,bench);
+    json.addNode(name);
+    json.addString("decoder",codec->getDecoderName());
+    json.addString("fourcc",fourCC::tostring(fcc));
+    writeTiming(json,name,decoded,total,bench);
+    json.endNode();
+    delete out;
+    delete codec;
+}
+
+/**
+    \fn benchEncoders
+    \brief Each encoder with its current settings, the stream is then decoded back
+*/
+static void benchEncoders(const benchParams &params,admJson &json)
+{
+    json.addNode("videoEncoders");
+    std::vector <std::string> names;
+    std::vector <std::string> fccs;
+    std::vector <std::vector <benchPacket> > streams;
+    std::vector <std::vector <uint8_t> > payloads;
+    std::vector <std::vector <uint8_t> > extras;
+    std::vector <benchSize> streamSizes;
+
+    int nb=ADM_ve6_getNbEncoders();
+    for(int s=0;s<params.sizes.size();s++)
+    {
+        const benchSize &sz=params.sizes[s];
+        benchSource source(sz.w,sz.h,params.nbFrames);
+        for(int e=1;e<nb;e++) // 0 is copy
+        {
+            const char *encName;
+            uint32_t major,minor,patch;
+            ADM_ve6_getEncoderInfo(e,&encName,&major,&minor,&patch);
+            std::string name=std::string(encName)+" "+sizeName(sz);
+            if(!wanted(params,name))
+                continue;
+            source.rewind();
+            ADM_coreVideoEncoder *enc=createVideoEncoderFromIndex(&source,e,false);
+            if(!enc)
+                continue;
+            if(!enc->setup() || enc->isDualPass())
+            {
+                ADM_warning("Cannot setup %s (or dual pass), skipping\n",encName);
+                delete enc;
+                continue;
+            }
+            uint32_t bufferSize=sz.w*sz.h*3;
+            ADMBitstream bitstream(bufferSize);
+            uint8_t *buffer=new uint8_t[bufferSize];
+            bitstream.data=buffer;
+            std::vector <benchPacket> packets;
+            std::vector <uint8_t> payload;
+            ADMBenchmark bench;
+            Clock clk;
+            uint32_t done=0;
+            uint64_t bytes=0;
+            clk.reset();
+            while(1)
+            {
+                bitstream.len=0;
+                bench.start();
+                bool r=enc->encode(&bitstream);
+                bench.end();
+                if(!r) break;
+                if(!bitstream.len) continue;
+                benchPacket p;
+                p.offset=payload.size();
+                p.length=bitstream.len;
+                p.flags=bitstream.flags;
+                p.pts=bitstream.pts;
+                p.dts=bitstream.dts;
+                packets.push_back(p);
+                payload.insert(payload.end(),bitstream.data,bitstream.data+bitstream.len);
+                bytes+=bitstream.len;
+                done++;
+            }
+            uint64_t total=clk.getElapsedUS();
+            json.addNode(name.c_str());
+            json.addString("fourcc",enc->getFourcc());
+            json.addDouble("kbps",(double)bytes*8./((double)params.nbFrames*BENCH_FRAME_INCREMENT/1000.));
+            writeTiming(json,name.c_str(),done,total,bench);
+            json.endNode();
+
+            if(packets.size())
+            {
+                uint32_t extraLen=0;
+                uint8_t *extraData=NULL;
+                enc->getExtraData(&extraLen,&extraData);
+                payload.resize(payload.size()+BENCH_PACKET_PADDING,0);
+                names.push_back(name);
+                fccs.push_back(std::string(enc->getFourcc()));
+                streams.push_back(packets);
+                payloads.push_back(payload);
+                extras.push_back(std::vector <uint8_t>(extraData,extraData+extraLen));
+                streamSizes.push_back(sz);
+            }
+            delete [] buffer;
+            bitstream.data=NULL;
+            delete enc;
+        }
+    }
+    json.endNode();
+
+    json.addNode("videoDecoders");
+    for(int i=0;i<streams.size();i++)
+    {
+        uint32_t fcc=fourCC::get((uint8_t *)fccs[i].c_str());
+        std::vector <uint8_t> &extra=extras[i];
+        writeDecode(names[i].c_str(),fcc,streamSizes[i].w,streamSizes[i].h,extra.size(),
+                    extra.size()? extra.data() : NULL,payloads[i].data(),streams[i],json);
+    }
+    json.endNode();
+}
+
+/**
+    \fn benchFile
+    \brief Demux a sample file fully then decode what was read
+*/
+static void benchFile(const benchParams &params,const std::string &file,admJson &json)
+{
+    FILE *f=ADM_fopen(file.c_str(),"r");
+    uint8_t buffer[4]={0,0,0,0};
+    if(!f)
+    {
+        ADM_warning("Cannot open %s\n",file.c_str());
+        return;
+    }
+    fread(buffer,4,1,f);
+    fclose(f);
+    uint32_t magic=(buffer[3]<<24)+(buffer[2]<<16)+(buffer[1]<<8)+(buffer[0]);
+
+    ADM_info("[bench] demuxing %s\n",file.c_str());
+    Clock clk;
+    clk.reset();
+    vidHeader *demuxer=ADM_demuxerSpawn(magic,file.c_str());
+    if(!demuxer)
+    {
+        ADM_warning("No demuxer for %s\n",file.c_str());
+        return;
+    }
+    if(!demuxer->open(file.c_str()))
+    {
+        ADM_warning("Cannot open %s\n",file.c_str());
+        delete demuxer;
+        return;
+    }
+    uint64_t openUs=clk.getElapsedUS();
+    aviInfo info;
+    demuxer->getVideoInfo(&info);
+    uint32_t nbFrames=info.nb_frames;
+    if(nbFrames>params.nbFrames*BENCH_FILE_FACTOR)
+        nbFrames=params.nbFrames*BENCH_FILE_FACTOR;
+
+    std::vector <benchPacket> packets;
+    std::vector <uint8_t> payload;
+    uint32_t maxSize=info.width*info.height*3+BENCH_PACKET_PADDING;
+    uint8_t *read=new uint8_t[maxSize];
+    ADMCompressedImage img;
+    ADMBenchmark bench;
+    uint64_t bytes=0;
+    clk.reset();
+    for(uint32_t i=0;i<nbFrames;i++)
+    {
+        uint32_t size=0;
+        demuxer->getFrameSize(i,&size);
+        if(size>maxSize)
+        {
+            delete [] read;
+            maxSize=size+BENCH_PACKET_PADDING;
+            read=new uint8_t[maxSize];
+        }
+        img.data=read;
+        bench.start();
+        bool r=demuxer->getFrame(i,&img);
+        bench.end();
+        if(!r) break;
+        benchPacket p;
+        p.offset=payload.size();
+        p.length=img.dataLength;
+        p.flags=img.flags;
+        p.pts=img.demuxerPts;
+        p.dts=img.demuxerDts;
+        packets.push_back(p);
+        payload.insert(payload.end(),read,read+img.dataLength);
+        bytes+=img.dataLength;
+    }
+    uint64_t total=clk.getElapsedUS();
+    delete [] read;
+    read=NULL;
+
+    std::string name=ADM_getFileName(file);
+    json.addNode(name.c_str());
+    json.addString("fourcc",fourCC::tostring(info.fcc));
+    json.addUint32("width",info.width);
+    json.addUint32("height",info.height);
+    json.addDouble("openMs",(double)openUs/1000.);
+    json.addDouble("MBps",total? (double)bytes/(double)total : 0.);
+    writeTiming(json,name.c_str(),packets.size(),total,bench);
+
+    uint32_t extraLen=0;
+    uint8_t *extraData=NULL;
+    demuxer->getExtraHeaderData(&extraLen,&extraData);
+    payload.resize(payload.size()+BENCH_PACKET_PADDING,0);
+    if(packets.size())
+        writeDecode("decode",info.fcc,info.width,info.height,extraLen,extraData,payload.data(),packets,json);
+    json.endNode();
+    demuxer->close();
+    delete demuxer;
+}
+/**
+    \fn benchFiles
+*/
+static void benchFiles(const benchParams &params,admJson &json)
+{
+    json.addNode("demuxers");
+    for(int i=0;i<params.files.size();i++)
+        if(wanted(params,params.files[i]))
+            benchFile(params,params.files[i],json);
+    json.endNode();
+}
+
+/**
+    \fn usage
+*/
+static void usage(const char *me)
+{
+    printf("Usage: %s [options] [sample files]\n",me);
+    printf("  --json <file>        Write the results there (default %s)\n",BENCH_DEFAULT_OUTPUT);
+    printf("  --size <WxH>         Picture size for the synthetic tests, can be repeated (default 720x576 and 1920x1080)\n");
+    printf("  --frames <n>         Frames per test (default %d)\n",BENCH_DEFAULT_FRAMES);
+    printf("  --only <category>    colors, filters, encoders, demuxers or postproc, can be repeated\n");
+    printf("  --match <string>     Only run the tests whose name contains string\n");
+    printf("Decoders are timed on the encoded streams and on the first frames of the sample files.\n");
+}
+/**
+    \fn parseArgs
+*/
+static bool parseArgs(int argc,char **argv,benchParams &params)
+{
+    params.what=0;
+    params.nbFrames=BENCH_DEFAULT_FRAMES;
+    params.output=BENCH_DEFAULT_OUTPUT;
+    for(int i=1;i<argc;i++)
+    {
+        const char *a=argv[i];
+        bool hasNext=(i+1<argc);
+        if(!strcmp(a,"--help"))
+            return false;
+        if(!strncmp(a,"--",2) && !hasNext)
+        {
+            ADM_error("Missing value for %s\n",a);
+            return false;
+        }
+        if(!strcmp(a,"--json"))
+        {
+            params.output=argv[++i];
+        }else if(!strcmp(a,"--size"))
+        {
+            benchSize s;
+            if(2!=sscanf(argv[++i],"%ux%u",&s.w,&s.h) || s.w<16 || s.h<16 || (s.w&1) || (s.h&1))
+            {
+                ADM_error("Invalid size %s\n",argv[i]);
+                return false;
+            }
+            params.sizes.push_back(s);
+        }else if(!strcmp(a,"--frames"))
+        {
+            params.nbFrames=atoi(argv[++i]);
+            if(!params.nbFrames)
+                return false;
+        }else if(!strcmp(a,"--only"))
+        {
+            const char *c=argv[++i];
+            if(!strcmp(c,"colors"))         params.what|=BENCH_COLORS;
+            else if(!strcmp(c,"filters"))   params.what|=BENCH_FILTERS;
+            else if(!strcmp(c,"encoders"))  params.what|=BENCH_ENCODERS;
+            else if(!strcmp(c,"demuxers"))  params.what|=BENCH_DEMUXERS;
+            else if(!strcmp(c,"postproc"))  params.what|=BENCH_POSTPROC;
+            else
+            {
+                ADM_error("Unknown category %s\n",c);
+                return false;
+            }
+        }else if(!strcmp(a,"--match"))
+        {
+            params.match=argv[++i];
+        }else if(!strncmp(a,"--",2))
+        {
+            ADM_error("Unknown option %s\n",a);
+            return false;
+        }else
+        {
+            params.files.push_back(std::string(a));
+        }
+    }
+    if(!params.what)
+        params.what=BENCH_ALL;
+    if(!params.sizes.size())
+    {
+        benchSize sd={720,576},hd={1920,1080};
+        params.sizes.push_back(sd);
+        params.sizes.push_back(hd);
+    }
+    return true;
+}
+
+/**
+    \fn ADM_benchMain
+    \brief Entry point of avidemux_bench, called once all the plugins are loaded
+*/
+int ADM_benchMain(int argc,char **argv)
+{
+    benchParams params;
+    if(!parseArgs(argc,argv,params))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    admJson json;
+    json.addUint32("cpus",ADM_cpu_num_processors());
+    json.addUint32("framesPerTest",params.nbFrames);
+
+    if(params.what & BENCH_COLORS)
+        benchColors(params,json);
+    if(params.what & BENCH_FILTERS)
+        benchFilters(params,json);
+    if(params.what & BENCH_ENCODERS)
+        benchEncoders(params,json);
+    if((params.what & BENCH_DEMUXERS) && params.files.size())
+        benchFiles(params,json);
+    if(params.what & BENCH_POSTPROC)
+        benchPostProc(params,json);
+
+    if(!json.dumpToFile(params.output.c_str()))
+        return 1;
+    ADM_info("Results written to %s\n",params.output.c_str());
+    return 0;
+}
+// EOF
@@ -54,6 +54,7 @@ uint32_t encodePriority=2;
 uint32_t indexPriority=2;
 uint32_t playbackPriority=0;
 uint32_t downmix;
+uint32_t resampleQuality=1;
 bool     mpeg_no_limit=0;
 uint32_t msglevel=2;
 
@@ -63,6 +64,11 @@ bool     loadDefault=false;
 char     *alsaDevice=NULL;
 
 bool     lastReadDirAsTarget=false;
+bool     writeBehind=true;
+bool     saveExportStats=false;
+bool     saveExportTrace=false;
+bool     reuseEncodedChunks=false;
+bool     cacheFirstPass=false;
 bool     altKeyboardShortcuts=false;
 bool     swapUpDown=false;
 
@@ -181,6 +187,11 @@ std::string currentSdlDriver=getSdlDriverName();
 
         // Make users happy who prefer the output dir to be the same as the input dir
         prefs->get(FEATURES_USE_LAST_READ_DIR_AS_TARGET,&lastReadDirAsTarget);
+        prefs->get(FEATURES_WRITE_BEHIND,&writeBehind);
+        prefs->get(FEATURES_SAVE_EXPORT_STATS,&saveExportStats);
+        prefs->get(FEATURES_SAVE_EXPORT_TRACE,&saveExportTrace);
+        prefs->get(FEATURES_REUSE_ENCODED_CHUNKS,&reuseEncodedChunks);
+        prefs->get(FEATURES_CACHE_FIRST_PASS,&cacheFirstPass);
 
         // PgUp and PgDown are cumbersome to reach on some laptops, offer alternative kbd shortcuts
         prefs->get(KEYBOARD_SHORTCUTS_USE_ALTERNATE_KBD_SHORTCUTS,&altKeyboardShortcuts);
@@ -218,6 +229,9 @@ std::string currentSdlDriver=getSdlDriverName();
         {
             downmix=0;
         }
+        // Resampler quality
+        if(!prefs->get(DEFAULT_RESAMPLE_QUALITY,&resampleQuality))
+            resampleQuality=1;
         olddevice=newdevice=AVDM_getCurrentDevice();
         // Audio device
         /************************ Build diaelems ****************************************/
@@ -297,6 +311,11 @@ std::string currentSdlDriver=getSdlDriverName();
         framePriority.swallow(&menuPlaybackPriority);
 
         diaElemToggle useLastReadAsTarget(&lastReadDirAsTarget,QT_TRANSLATE_NOOP("adm","_Default to the directory of the last read file for saving"));
+        diaElemToggle useWriteBehind(&writeBehind,QT_TRANSLATE_NOOP("adm","_Write output files from a separate thread"));
+        diaElemToggle useExportStats(&saveExportStats,QT_TRANSLATE_NOOP("adm","_Save per stage timing next to the output file"));
+        diaElemToggle useExportTrace(&saveExportTrace,QT_TRANSLATE_NOOP("adm","Save a thread _timeline next to the output file"));
+        diaElemToggle useEncodedChunks(&reuseEncodedChunks,QT_TRANSLATE_NOOP("adm","_Reuse the unchanged parts of previous encodings"));
+        diaElemToggle useFirstPassCache(&cacheFirstPass,QT_TRANSLATE_NOOP("adm","_Keep the first pass pictures on disk for the second pass"));
         diaElemFrame frameCache(QT_TRANSLATE_NOOP("adm","Caching of decoded pictures"));
         diaElemUInteger cacheSize(&editor_cache_size,QT_TRANSLATE_NOOP("adm","_Cache size:"),8,16);
         frameCache.swallow(&cacheSize);
@@ -375,6 +394,12 @@ std::string currentSdlDriver=getSdlDriverName();
                              ,{3,      QT_TRANSLATE_NOOP("adm","Pro Logic II"),NULL}
          };
         diaElemMenu menuMixer(&downmix,QT_TRANSLATE_NOOP("adm","_Local playback downmixing:"), sizeof(mixerEntries)/sizeof(diaMenuEntry),mixerEntries,"");
+         diaMenuEntry resampleEntries[]={
+                             {0,       QT_TRANSLATE_NOOP("adm","Fast"),NULL}
+                             ,{1,      QT_TRANSLATE_NOOP("adm","Medium"),NULL}
+                             ,{2,      QT_TRANSLATE_NOOP("adm","High"),NULL}
+         };
+        diaElemMenu menuResample(&resampleQuality,QT_TRANSLATE_NOOP("adm","_Resampling quality:"), sizeof(resampleEntries)/sizeof(diaMenuEntry),resampleEntries,"");
 //*********** AV_
 
 //***AV
@@ -446,8 +471,8 @@ std::string currentSdlDriver=getSdlDriverName();
 
 
         /* Output */
-        diaElem *diaOutput[]={&allowAnyMpeg,&useLastReadAsTarget,&frameCache};
-        diaElemTabs tabOutput(QT_TRANSLATE_NOOP("adm","Output"),3,(diaElem **)diaOutput);
+        diaElem *diaOutput[]={&allowAnyMpeg,&useLastReadAsTarget,&useWriteBehind,&useExportStats,&useExportTrace,&useEncodedChunks,&useFirstPassCache,&frameCache};
+        diaElemTabs tabOutput(QT_TRANSLATE_NOOP("adm","Output"),8,(diaElem **)diaOutput);
 
         /* Audio */
 
@@ -460,8 +485,8 @@ std::string currentSdlDriver=getSdlDriverName();
 #endif
 
 #if 1
-        diaElem *diaAudio[]={&menuMixer,&menuAudio};
-        diaElemTabs tabAudio(QT_TRANSLATE_NOOP("adm","Audio"),2,(diaElem **)diaAudio);
+        diaElem *diaAudio[]={&menuMixer,&menuResample,&menuAudio};
+        diaElemTabs tabAudio(QT_TRANSLATE_NOOP("adm","Audio"),3,(diaElem **)diaAudio);
 #endif
 
 
@@ -593,6 +618,8 @@ std::string currentSdlDriver=getSdlDriverName();
             }
             // Downmixing (default)
             prefs->set(DEFAULT_DOWNMIXING,downmix);
+            // Resampling quality
+            prefs->set(DEFAULT_RESAMPLE_QUALITY,resampleQuality);
 #if defined(ALSA_SUPPORT) || defined (OSS_SUPPORT)
             // Master or PCM
             prefs->set(FEATURES_AUDIOBAR_USES_MASTER, useMaster);
@@ -641,6 +668,11 @@ std::string currentSdlDriver=getSdlDriverName();
 #endif
             // Make users happy who prefer the output dir to be the same as the input dir
             prefs->set(FEATURES_USE_LAST_READ_DIR_AS_TARGET,lastReadDirAsTarget);
+            prefs->set(FEATURES_WRITE_BEHIND,writeBehind);
+            prefs->set(FEATURES_SAVE_EXPORT_STATS,saveExportStats);
+            prefs->set(FEATURES_SAVE_EXPORT_TRACE,saveExportTrace);
+            prefs->set(FEATURES_REUSE_ENCODED_CHUNKS,reuseEncodedChunks);
+            prefs->set(FEATURES_CACHE_FIRST_PASS,cacheFirstPass);
             // Enable alternate keyboard shortcuts
             prefs->set(KEYBOARD_SHORTCUTS_USE_ALTERNATE_KBD_SHORTCUTS,altKeyboardShortcuts);
             // Allow to use the UP key to navigate back, DOWN to navigate forward
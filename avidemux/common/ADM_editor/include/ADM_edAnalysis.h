@@ -0,0 +1,54 @@
+/***************************************************************************
+    \file ADM_edAnalysis.h
+    \brief Headless black frame / scene change search
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_EDANALYSIS_H
+#define ADM_EDANALYSIS_H
+
+#include <vector>
+
+#define ADM_ANALYSIS_BLACK 1 /// Report frames that are (almost) fully black
+#define ADM_ANALYSIS_SCENE 2 /// Report frames that do not look like the previous one
+
+#define ADM_ANALYSIS_DEFAULT_DARKNESS   40
+#define ADM_ANALYSIS_DEFAULT_SCENE      0.4
+
+/**
+    \struct ADM_analysisParams
+*/
+typedef struct
+{
+    uint32_t    what;           /// ADM_ANALYSIS_BLACK and/or ADM_ANALYSIS_SCENE
+    uint32_t    darkness;       /// A luma sample above that is not black
+    float       sceneThreshold; /// 0..1, histogram distance above which it is a scene change
+    bool        stopAtFirst;    /// Stop as soon as one candidate has been found
+}ADM_analysisParams;
+
+/**
+    \struct ADM_analysisCandidate
+*/
+typedef struct
+{
+    uint64_t    pts;    /// Linear time, i.e. as seen in the editor
+    uint32_t    what;   /// ADM_ANALYSIS_BLACK or ADM_ANALYSIS_SCENE
+    float       score;  /// Scene : histogram distance, black : ratio of non black samples
+}ADM_analysisCandidate;
+
+typedef std::vector <ADM_analysisCandidate> ADM_analysisResult;
+
+/**
+    Called between two batches of GOPs, return true to abort
+*/
+typedef bool ADM_analysisProgress(void *cookie,uint64_t doneUs,uint64_t totalUs);
+
+#endif
@@ -42,6 +42,7 @@
  #include "ADM_segment.h"
  #include <BVector.h>
  #include "ADM_edAudioTrack.h"
+ #include "ADM_edAnalysis.h"
 
  #include "audiofilter_internal.h"
  #include "audiofilter_conf.h"
@@ -218,6 +219,9 @@ virtual                         ~ADM_Composer();
 					bool		isFileOpen(void);
 					int			openFile(const char *name);
 					int 		saveFile(const char *name);
+                    int         addRendition(const char *name,uint32_t width,uint32_t height);
+                    void        clearRenditions(void);
+                    int         saveRenditions(void);
 					int 		saveImageBmp(const char *filename);
 					int 		saveImageJpg(const char *filename);
                     int         saveImagePng(const char *filename);
@@ -292,6 +296,7 @@ public:
                     _VIDEOS*    getRefVideo(int videoIndex);
                     uint64_t    getVideoDuration(void);
                     uint64_t    getFrameIncrement(void); /// Returns the # of us between 2 frames or the smaller value of them
+                    uint32_t    getVideoBitDepth(void); /// Bits per sample of the last picture decoded for the current segment
                     int         getVideoCount(void);
                     bool        getTimeBase(uint32_t *scale, uint32_t *rate); // common timebase or an approximation for all videos within the selection
 
@@ -306,6 +311,9 @@ public:
                     bool                getNKFramePTS(uint64_t *frameTime);
                     bool                getPKFramePTS(uint64_t *frameTime);
                     bool                getDtsFromPts(uint64_t *time);
+                                        /// Headless black frame / scene change search, see ADM_edAnalysis.cpp
+                    bool                analyzeVideo(uint64_t startTime,uint64_t endTime,const ADM_analysisParams &params,
+                                                     ADM_analysisResult &result,ADM_analysisProgress *progress=NULL,void *cookie=NULL);
                                         /// Returns pts-dts for given frame
                     bool		getPtsDtsDelta(uint64_t frametime, uint64_t *delta);
 /******************************* Post Processing ************************************/
@@ -371,6 +379,11 @@ public:
         void        seekFrame(int count);
         void        seekKeyFrame(int count);
         void        seekBlackFrame(int count);
+        int         searchBlackFrames(uint64_t start,uint64_t end);
+        int         searchSceneChanges(uint64_t start,uint64_t end,float threshold);
+        uint64_t    getSearchResult(int index);
+private:
+        ADM_analysisResult lastSearch; /// result of the last searchXXX call, for scripts
 public:
         bool            setVar(const char *key, const char *value);
         const char      *getVar(const char *key);
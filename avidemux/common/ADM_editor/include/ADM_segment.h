@@ -50,6 +50,15 @@ public:
         }
     ~ADM_audioStreamTrack();
 };
+/**
+    \struct ADM_ptsIndexEntry
+    \brief One frame with a valid PTS, the index is sorted by PTS
+*/
+typedef struct
+{
+    uint64_t pts;
+    uint32_t frame;
+}ADM_ptsIndexEntry;
 /**
     \struct _VIDEOS
     \brief The _VIDEOS struct is a video we have loaded.
@@ -60,6 +69,7 @@ public:
       vidHeader *_aviheader; /// Demuxer
       decoders *decoder; /// Video codec
       ADMColorScalerSimple *color; /// Color conversion if needed
+      uint32_t          decodedBitDepth; /// Bits per sample of the pictures in the cache
       bool              dontTrustBFramePts;
       /* Audio part */
       uint32_t currentAudioStream;
@@ -81,12 +91,23 @@ public:
       uint64_t firstFramePts; /// Pts of firstFrame
       uint32_t decoderDelay; /// Nb of frames passed to decoder before the first picture pops out
 
+      /* PTS -> frame lookup, built when the video is loaded and rebuilt each time the demuxer PTS are modified.
+         It is never built lazily so that the lookups are read-only and can run from any thread. */
+      std::vector <ADM_ptsIndexEntry> ptsIndex;
+      bool     ptsIndexValid;
+
+      bool     buildPtsIndex(void);
+      void     rebuildPtsIndex(void) {buildPtsIndex();}
+      bool     ptsToFrame(uint64_t pts,uint32_t *frame); /// Frame whose PTS==pts
+      bool     ptsToFrameOrBefore(uint64_t pts,uint32_t *frame); /// Frame with the biggest PTS <= pts
+
     _VIDEOS()
     {
         currentAudioStream=0;
         _aviheader=NULL;
         decoder=NULL;
         color=NULL;
+        decodedBitDepth=8;
         _nb_video_frames=0;
         paramCacheSize=0;
         paramCache=NULL;
@@ -97,6 +118,7 @@ public:
         timeIncrementInUs=0;
         firstFramePts=0;
         decoderDelay=0;
+        ptsIndexValid=false;
     }
 };
 
@@ -61,6 +61,7 @@ public:
     virtual int getVideoCount(void) = 0;
     virtual uint64_t getVideoDuration(void) = 0;
     virtual uint8_t getVideoInfo(aviInfo *info) = 0;
+    virtual uint32_t getVideoBitDepth(void) = 0;
     virtual bool getTimeBase(uint32_t *scale, uint32_t *rate) = 0;
     virtual _VIDEOS* getRefVideo(int videoIndex) = 0;
     virtual bool getVideoPtsDts(uint32_t frame, uint32_t *flags, uint64_t *pts, uint64_t *dts) = 0;
@@ -75,6 +76,9 @@ public:
     virtual int saveImageJpg(const char *filename) = 0;
     virtual int saveImagePng(const char *filename) = 0;
     virtual int saveFile(const char *name) = 0;
+    virtual int addRendition(const char *name, uint32_t width, uint32_t height) = 0;
+    virtual void clearRenditions(void) = 0;
+    virtual int saveRenditions(void) = 0;
     virtual ADM_dynMuxer* getCurrentMuxer() = 0;
     virtual bool setContainer(const char *cont, CONFcouple *c) = 0;
     virtual bool setCurrentFramePts(uint64_t pts) = 0;
@@ -114,6 +118,9 @@ public:
     virtual void seekFrame(int count) = 0;
     virtual void seekKeyFrame(int count) = 0;
     virtual void seekBlackFrame(int count) = 0;
+    virtual int searchBlackFrames(uint64_t start, uint64_t end) = 0; // returns the number of black frames found
+    virtual int searchSceneChanges(uint64_t start, uint64_t end, float threshold) = 0;
+    virtual uint64_t getSearchResult(int index) = 0; // pts of the index-th frame found by the last search
     virtual uint32_t getFrameSize(int count) = 0;
     virtual int  setVideoCodecProfile(const char *codec, const char *profile)=0;
     virtual bool audioSetAudioPoolLanguage(int poolIndex, const char *language)=0;
@@ -30,6 +30,7 @@
 #endif
 
 #include "ADM_pp.h"
+#include "ADM_trace.h"
 
 /**
     \fn recalibrateSigned
@@ -213,6 +214,7 @@ bool ADM_Composer::nextPicture(ADMImage *image, int flags)
 {
 uint64_t pts;
 uint64_t tail;
+    ADM_TRACE_SCOPE("editor","nextPicture");
     
         // Decode image...
         _SEGMENT *seg=_segments.getSegment(_currentSegment);
@@ -534,6 +536,19 @@ uint32_t segNo;
 */
 uint8_t ADM_Composer::dupe(ADMImage *src,ADMImage *dst,_VIDEOS *vid)
 {
+    // 10 bits planar 4:2:0 is kept as is, the filter chain converts it only where needed
+    if(src->_colorspace==ADM_COLOR_YV12_10BITS && src->refType==ADM_HW_NONE && dst->setBitDepth(10))
+    {
+        ADM_assert(src->isRef());
+        src->castToRef()->setBitDepth(10);
+        vid->decodedBitDepth=10;
+        for(int i=PLANAR_Y;i<PLANAR_LAST;i++)
+            ADMImage::copyPlane(src,dst,(ADM_PLANE)i);
+        return 1;
+    }
+    if(dst->isHighBitDepth())
+        dst->setBitDepth(8);
+    vid->decodedBitDepth=8;
     if(src->_colorspace!=ADM_COLOR_YV12)
     {
         // We need to do some colorspace conversion
@@ -29,6 +29,7 @@
 #endif
 
 #include "ADM_pp.h"
+#include "ADM_trace.h"
 
 /**
     \fn seektoFrame
@@ -232,7 +233,12 @@ bool ADM_Composer::DecodeNextPicture(uint32_t ref)
     drain=vid->decoder->getDrainingState();
     if(!drain)
     {
-        if(!demuxer->getFrame(frame,&img))
+        bool gotFrame;
+        {
+            ADM_TRACE_SCOPE("editor","demux");
+            gotFrame=demuxer->getFrame(frame,&img);
+        }
+        if(!gotFrame)
         {
             ADM_warning("getFrame failed for frame %" PRIu32"\n",frame);
             drain=true;
@@ -339,6 +345,7 @@ bool ADM_Composer::DecodeNextPicture(uint32_t ref)
 
 bool ADM_Composer::decompressImage(ADMImage *out,ADMCompressedImage *in,uint32_t ref)
 {
+    ADM_TRACE_SCOPE("editor","decode");
     ADMImage *tmpImage=NULL;
     _VIDEOS  *v=_segments.getRefVideo(ref);
     bool refOnly=v->decoder->dontcopy(); // can we skip one memcpy ?
@@ -363,7 +370,9 @@ bool ADM_Composer::decompressImage(ADMImage *out,ADMCompressedImage *in,uint32_t
         tmpImage=_imageBuffer;
     }
 
+    tmpImage->hwDecRefCount(); // release the previous picture if it was shared by the decoder
     tmpImage->_colorspace=ADM_COLOR_YV12;
+    tmpImage->setBitDepth(8);
     // Decode it
     if (!v->decoder->uncompress (in, tmpImage))
     {
@@ -384,6 +393,8 @@ bool ADM_Composer::decompressImage(ADMImage *out,ADMCompressedImage *in,uint32_t
     if(tmpImage->refType!=ADM_HW_NONE || ((!tmpImage->quant || !tmpImage->_qStride) && tmpImage->_colorspace==ADM_COLOR_YV12))
     {
         out->_Qp=2;
+        out->setBitDepth(8);
+        v->decodedBitDepth=8;
         out->duplicate(tmpImage);
         aprintf("[decompressImage] : No quant avail\n");
         return true;
@@ -418,6 +429,8 @@ bool ADM_Composer::decompressImage(ADMImage *out,ADMCompressedImage *in,uint32_t
         return true;
     }
     /* Do it!*/
+    out->setBitDepth(8);
+    v->decodedBitDepth=8;
     _pp->process(tmpImage,out);
     return true;
 }
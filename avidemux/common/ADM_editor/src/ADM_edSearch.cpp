@@ -242,7 +242,7 @@ bool ADM_Composer::searchNextKeyFrameInRef(int ref,uint64_t refTime,uint64_t *nk
 /** 
  * \fn getFrameNumBeforePtsOrBefore
  * \brief Search the framenumber that has a valid PTS = what's given or  before
- *         it can be equal to refTime
+ *         it can be equal to refTime. This is a binary search in the sorted PTS table of the reference.
  * @param v
  * @param refTime
  * @param frameNumber
@@ -257,123 +257,16 @@ bool ADM_Composer::getFrameNumFromPtsOrBefore(_VIDEOS *v,uint64_t refTime,int &f
         frameNumber = 0;
         return true;
     }
-
-    uint32_t nbFrame = v->_nb_video_frames;
-    uint64_t pts, dts, margin = v->timeIncrementInUs * 16;
-    const uint64_t rangeBegin = (refTime < margin)? 0 : (refTime - margin);
-    const uint64_t rangeEnd = refTime + margin;
-    uint32_t curFrame = nbFrame >> 1;
-    uint32_t splitMoval = (curFrame + 1) >> 1;
-    uint32_t minFrame = 0;
-    bool worked = false;
     pivotPrintf("Looking for frame with pts %" PRIu64" us (%s)\n",refTime,ADM_us2plain(refTime));
-    // Try to find the frame that as the timestamp close enough to refTime, while being smaller
-    do 
+    uint32_t frame;
+    if(!v->ptsToFrameOrBefore(refTime,&frame))
     {
-        // seems like the pts determination, not always works -> retry if necessary
-        uint32_t tmpFrame = curFrame;
-        do
-        {
-            pts = ADM_NO_PTS;
-            worked = v->_aviheader->getPtsDts(tmpFrame,&pts,&dts);
-            if(worked && pts != ADM_NO_PTS)
-                break; // found
-            if(tmpFrame <= minFrame)
-            {
-                ADM_warning("Frames between %" PRIu32" and %" PRIu32" have no PTS.\n",minFrame,curFrame);
-                break;
-            }
-            tmpFrame--;
-        } while(true);
-        if(pts == ADM_NO_PTS)
-        {
-            tmpFrame = curFrame + 1;
-            do
-            {
-                if(tmpFrame >= nbFrame)
-                {
-                    ADM_warning("The whole segment is corrupted, aborting seek.\n");
-                    return false;
-                }
-                minFrame = tmpFrame;
-                worked = v->_aviheader->getPtsDts(tmpFrame,&pts,&dts);
-                if(worked && pts != ADM_NO_PTS)
-                    break; // found
-                tmpFrame++;
-            } while(true);
-        }
-        curFrame = tmpFrame; // resync
-        // are we lucky?
-        if(pts == refTime)
-        {
-            pivotPrintf("Perfect match for frame %" PRIu32"\n",curFrame);
-            frameNumber = curFrame;
-            return true;
-        }
-        // nope, are we at least close enough?
-        if(pts != ADM_NO_PTS && pts >= rangeBegin && pts <= rangeEnd)
-            break; // switch to linear search
-        // nope, continue to bisect
-        pivotPrintf("SplitMoval=%d\n",splitMoval);
-        if(splitMoval < 16)
-            break;
-        pivotPrintf("Pivot frame is %" PRIu32" at %s\n",curFrame,ADM_us2plain(pts));
-        if (pts > refTime)
-        {
-            if (curFrame <= splitMoval + minFrame)
-            {
-                curFrame = minFrame;
-            }else
-            {
-                curFrame -= splitMoval;
-            }
-        }else
-        {
-            curFrame += splitMoval;
-            if(curFrame >= nbFrame)
-                curFrame = nbFrame - 1;
-        }
-        splitMoval++;
-        splitMoval >>= 1;
-    } while(refTime != pts);
-
-    // linear search with a generous safety margin
-    curFrame = (curFrame < 32)? 0 : curFrame - 32;
-    pivotPrintf("Starting linear search at frame %" PRIu32", total frames: %" PRIu32"\n",curFrame,nbFrame);
-    int candidate = -1;
-    uint64_t last = 0;
-    for(int i = 0; i < 65; i++)
-    {
-        if(curFrame >= nbFrame) break;
-        pts = ADM_NO_PTS;
-        worked = v->_aviheader->getPtsDts(curFrame,&pts,&dts);
-        if(!worked || pts == ADM_NO_PTS)
-        {
-            pivotPrintf("Linear search, skipping frame %" PRIu32"\n",curFrame);
-            curFrame++;
-            continue;
-        }
-        if(pts == refTime)
-        {
-            pivotPrintf("Perfect match for frame %" PRIu32"\n",curFrame);
-            frameNumber = curFrame;
-            return true;
-        }
-        if(pts >= rangeBegin && (last? pts > last : true) && pts < refTime)
-        {
-            candidate = curFrame;
-            last = pts;
-        }
-        curFrame++;
-    }
-    if(candidate >= 0)
-    {
-        ADM_info("Best candidate for time %s in reference is frame %" PRIu32"\n",ADM_us2plain(refTime),candidate);
-        frameNumber = candidate;
-        return true;
+        ADM_warning("Search for frame matching time %s in reference failed.\n",ADM_us2plain(refTime));
+        return false;
     }
-    ADM_warning("Search for frame matching time %s in reference failed.\n",ADM_us2plain(refTime));
-    return false;
+    pivotPrintf("Best candidate for time %s in reference is frame %" PRIu32"\n",ADM_us2plain(refTime),frame);
+    frameNumber = (int)frame;
+    return true;
 }
 /**
     \fn searchPreviousKeyFrameInRef
@@ -22,6 +22,7 @@
 #include "ADM_vidMisc.h"
 #include "ADM_videoInfoExtractor.h"
 #include "ADM_h264_tag.h"
+#include "ADM_trace.h"
 
 #if 0
 #define aprintf printf
@@ -643,6 +644,7 @@ bool        ADM_Composer::getNonClosedGopDelay(uint64_t time,uint32_t *delay)
 */
 bool        ADM_Composer::getCompressedPicture(uint64_t start,uint64_t videoDelay,ADMCompressedImage *img)
 {
+    ADM_TRACE_SCOPE("editor","getCompressedPicture");
     uint64_t tail;
     //
     int64_t signedPts;
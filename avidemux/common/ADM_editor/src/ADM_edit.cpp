@@ -663,6 +663,8 @@ uint8_t ADM_Composer::addFile (const char *name)
                 _segments.updateRefVideo();
         }
      }
+    // The PTS may have been modified above, build the lookup table from the final ones
+    _segments.getRefVideo(_segments.getNbRefVideos()-1)->rebuildPtsIndex();
     int lastVideo=_segments.getNbSegments();
     if(lastVideo && (isH264Compatible(info.fcc) || FCC_MATCHES("WVC1")))
     {
@@ -775,6 +777,17 @@ uint64_t ADM_Composer::getFrameIncrement(void)
     if (!_segments.getNbSegments()) return 0;
     return _segments.getRefVideo(0)->timeIncrementInUs;
 }
+/**
+    \fn getVideoBitDepth
+    \brief 8 until a picture has been decoded
+*/
+uint32_t ADM_Composer::getVideoBitDepth(void)
+{
+    if (!_segments.getNbSegments()) return 8;
+    _SEGMENT *seg=_segments.getSegment(_currentSegment);
+    if(!seg) return 8;
+    return _segments.getRefVideo(seg->_reference)->decodedBitDepth;
+}
 /**
 	Set decoder settings (post process/swap u&v...)
 	for the segment referred by frame
@@ -15,6 +15,7 @@
  *                                                                         *
  ***************************************************************************/
 #include "ADM_cpp.h"
+#include <algorithm>
 #include "ADM_default.h"
 #include "ADM_segment.h"
 #include "ADM_codec.h"
@@ -67,6 +68,7 @@ bool        ADM_EditorSegment::updateRefVideo(void)
     vidHeader *demuxer=ref->_aviheader;
     uint64_t pts,dts;
 
+        ref->rebuildPtsIndex(); // we are called after the PTS have been fixed
         demuxer->getPtsDts(0,&pts,&dts);
         if(pts!=ADM_NO_PTS && pts >0)
         {
@@ -108,6 +110,9 @@ bool        ADM_EditorSegment::addReferenceVideo(_VIDEOS *ref)
     demuxer->getVideoInfo (&info);
     demuxer->getExtraHeaderData (&l, &d);
     ref->decoder = ADM_getDecoder (info.fcc, info.width, info.height, l, d, info.bpp);
+    // The cache and the filter chain hold the decoded pictures by reference, no copy
+    if(ref->decoder)
+        ref->decoder->shareOutput(true);
 
     if(false==prefs->get(FEATURES_CACHE_SIZE,&cacheSize))
         cacheSize = EDITOR_CACHE_MAX_SIZE;
@@ -201,6 +206,7 @@ bool        ADM_EditorSegment::addReferenceVideo(_VIDEOS *ref)
 
     segments.push_back(seg);
     videos.push_back(*ref);
+    videos.back().buildPtsIndex(); // the loader rebuilds it if it fixes the PTS afterward
     updateStartTime();
     return true;
 }
@@ -528,37 +534,85 @@ bool        ADM_EditorSegment::convertSegTimeToLinear(  uint32_t seg,uint64_t se
     return true;
 }
 /**
-    \fn TimeToFrame
-    \brief return the frameno whose PTS==time
+    \fn buildPtsIndex
+    \brief Collect all the frames having a PTS and sort them, so that PTS lookups are a binary search
 */
-static bool TimeToFrame(_VIDEOS *v,uint64_t time,uint32_t *frame,uint32_t *oflags)
+static bool ptsIndexCompare(const ADM_ptsIndexEntry &a,const ADM_ptsIndexEntry &b)
+{
+    if(a.pts!=b.pts) return a.pts<b.pts;
+    return a.frame<b.frame;
+}
+bool _VIDEOS::buildPtsIndex(void)
 {
-    vidHeader *demuxer=v->_aviheader;
-    bool warn=false;
-    int nb=demuxer->getMainHeader()->dwTotalFrames;
-    for(int i=0;i<nb;i++)
+    uint32_t nb=_nb_video_frames;
+    if(!nb) nb=_aviheader->getMainHeader()->dwTotalFrames;
+    ptsIndex.clear();
+    ptsIndex.reserve(nb);
+    bool sorted=true;
+    for(uint32_t i=0;i<nb;i++)
     {
         uint64_t pts,dts;
-        uint32_t flags;
-            demuxer->getPtsDts(i,&pts,&dts);
-            demuxer->getFlags(i,&flags);
-            if(pts==time)
-            {
-                *frame=i;
-                *oflags=flags;
-                return true;
-            }
-            if(dts!=ADM_NO_PTS && warn==false)
-            {
-                if(dts>time)
-                {
-                    ADM_error("We reached frame %d with a PTS of %" PRIu64" when looking for PTS %" PRIu64"\n",
-                                            i,dts,time);
-                    warn=true;
-                }
-            }
+        if(!_aviheader->getPtsDts(i,&pts,&dts)) continue;
+        if(pts==ADM_NO_PTS) continue;
+        ADM_ptsIndexEntry e;
+        e.pts=pts;
+        e.frame=i;
+        if(ptsIndex.size() && pts<ptsIndex.back().pts) sorted=false;
+        ptsIndex.push_back(e);
     }
-    return false;
+    if(!sorted)
+        std::sort(ptsIndex.begin(),ptsIndex.end(),ptsIndexCompare);
+    ptsIndexValid=true;
+    ADM_info("PTS index built, %d frames out of %d have a PTS\n",(int)ptsIndex.size(),(int)nb);
+    return true;
+}
+/**
+    \fn ptsToFrame
+*/
+bool _VIDEOS::ptsToFrame(uint64_t pts,uint32_t *frame)
+{
+    ADM_assert(ptsIndexValid); // built at load time
+    ADM_ptsIndexEntry key;
+    key.pts=pts;
+    key.frame=0;
+    std::vector <ADM_ptsIndexEntry>::iterator it=std::lower_bound(ptsIndex.begin(),ptsIndex.end(),key,ptsIndexCompare);
+    if(it==ptsIndex.end() || it->pts!=pts) return false;
+    *frame=it->frame;
+    return true;
+}
+/**
+    \fn ptsToFrameOrBefore
+*/
+bool _VIDEOS::ptsToFrameOrBefore(uint64_t pts,uint32_t *frame)
+{
+    ADM_assert(ptsIndexValid); // built at load time
+    ADM_ptsIndexEntry key;
+    key.pts=pts;
+    key.frame=0;
+    std::vector <ADM_ptsIndexEntry>::iterator it=std::lower_bound(ptsIndex.begin(),ptsIndex.end(),key,ptsIndexCompare);
+    if(it!=ptsIndex.end() && it->pts==pts)
+    {
+        *frame=it->frame;
+        return true;
+    }
+    if(it==ptsIndex.begin()) return false; // all frames are after pts
+    --it;
+    uint64_t before=it->pts;
+    // Several frames may share that PTS, take the first one
+    while(it!=ptsIndex.begin() && (it-1)->pts==before) --it;
+    *frame=it->frame;
+    return true;
+}
+/**
+    \fn TimeToFrame
+    \brief return the frameno whose PTS==time
+*/
+static bool TimeToFrame(_VIDEOS *v,uint64_t time,uint32_t *frame,uint32_t *oflags)
+{
+    if(!v->ptsToFrame(time,frame))
+        return false;
+    v->_aviheader->getFlags(*frame,oflags);
+    return true;
 }
 /**
     \fn intraTimeToFrame
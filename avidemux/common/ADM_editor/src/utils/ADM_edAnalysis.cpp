@@ -0,0 +1,570 @@
+/***************************************************************************
+    \file ADM_edAnalysis.cpp
+    \brief Headless black frame / scene change search
+
+    The range is cut into groups of GOPs, each group is demuxed by the caller
+    then decoded by one slice of the thread pool with its own decoder.
+    Only a decimated luma plane is looked at, there is no postprocessing,
+    no color conversion and nothing is displayed.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_edit.hxx"
+#include "ADM_threadPool.h"
+#include "ADM_vidMisc.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+#define ANALYSIS_DECIMATE       4   // Look at one luma sample out of 4 horizontally and vertically
+#define ANALYSIS_HIST_BINS      32
+#define ANALYSIS_MIN_JOB_FRAMES 24  // Merge short GOPs (intra only codecs...) so that a job is worth a decoder flush
+#define ANALYSIS_PACKET_PADDING 64  // lavc reads (and mpeg4 writes) a bit past the end of the packet
+#define ANALYSIS_MAX_DRAIN      128
+
+/**
+    \struct analysisFrame
+    \brief What we keep from a decoded picture
+*/
+typedef struct
+{
+    uint64_t pts;
+    uint32_t nonBlack;  // weighted count of samples brighter than darkness
+    uint32_t samples;   // weighted count of samples
+    uint32_t hist[ANALYSIS_HIST_BINS];
+}analysisFrame;
+
+/**
+    \struct analysisPacket
+*/
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+    uint32_t flags;
+    uint32_t frame;
+    uint64_t pts;
+    uint64_t dts;
+}analysisPacket;
+
+/**
+    \class analysisJob
+    \brief A group of GOPs, demuxed, to be decoded by one slice
+*/
+class analysisJob
+{
+public:
+    std::vector <uint8_t>        data;
+    std::vector <analysisPacket> packets;
+    uint64_t                     windowStart; // Ref time, pictures outside [start,end[ are decoded but ignored
+    uint64_t                     windowEnd;
+    std::vector <analysisFrame>  frames;
+    bool                         error;
+    void reset(void)
+    {
+        data.clear();
+        packets.clear();
+        frames.clear();
+        error=false;
+    }
+};
+
+/**
+    \class analysisBatch
+    \brief Cookie given to the thread pool, slice i uses job i, decoder i and image i
+*/
+class analysisBatch
+{
+public:
+    analysisJob  *jobs;
+    decoders    **codecs;
+    ADMImage    **images;
+    ADMImage    **hwImages;
+    uint32_t      width;
+    uint32_t      height;
+    uint32_t      darkness;
+};
+
+/**
+    \fn measureFrame
+    \brief Histogram and black level of the decimated luma plane
+            As in fastIsNotBlack, the top and bottom 8th of the picture are allowed
+            twice as many bright samples (subtitles, logo...)
+*/
+static bool measureFrame(ADMImage *img,uint32_t darkness,analysisFrame *frame)
+{
+    bool wide=false;
+    int  shift=0;
+    switch(img->_colorspace & ADM_COLOR_MASK)
+    {
+        case ADM_COLOR_YV12:
+        case ADM_COLOR_YUV422P:
+        case ADM_COLOR_YUV411:
+        case ADM_COLOR_YUV444:
+        case ADM_COLOR_Y8:
+                break;
+        case ADM_COLOR_YV12_10BITS:
+        case ADM_COLOR_YUV444_10BITS:
+        case ADM_COLOR_YUV422_10BITS:
+                wide=true;
+                shift=2;
+                break;
+        case ADM_COLOR_NV12_10BITS: // 10 bits in the MSBs
+                wide=true;
+                shift=8;
+                break;
+        default:
+                ADM_warning("Colorspace 0x%x not supported\n",img->_colorspace);
+                return false;
+    }
+    uint32_t w=img->_width;
+    uint32_t h=img->_height;
+    uint32_t edge=h>>3;
+    int      pitch=img->GetPitch(PLANAR_Y);
+    uint8_t *base=img->GetReadPtr(PLANAR_Y);
+    uint32_t nonBlack=0,samples=0;
+
+    memset(frame->hist,0,sizeof(frame->hist));
+    for(uint32_t y=0;y<h;y+=ANALYSIS_DECIMATE)
+    {
+        uint8_t *row=base+pitch*y;
+        uint32_t weight=(y<edge || y>=h-edge)? 1 : 2;
+        uint32_t bright=0,count=0;
+        for(uint32_t x=0;x<w;x+=ANALYSIS_DECIMATE)
+        {
+            uint32_t v;
+            if(wide)
+            {
+                v=((uint16_t *)row)[x]>>shift;
+                if(v>255) v=255;
+            }else
+            {
+                v=row[x];
+            }
+            frame->hist[v>>3]++;
+            if(v>darkness) bright++;
+            count++;
+        }
+        nonBlack+=bright*weight;
+        samples+=count*2;
+    }
+    frame->pts=img->Pts;
+    frame->nonBlack=nonBlack;
+    frame->samples=samples;
+    return true;
+}
+/**
+    \fn isBlack
+*/
+static bool isBlack(const analysisFrame &f)
+{
+    return (uint64_t)f.nonBlack*256 < (uint64_t)f.samples;
+}
+/**
+    \fn sceneDistance
+    \brief 0 : same luma distribution, 1 : nothing in common
+*/
+static float sceneDistance(const analysisFrame &a,const analysisFrame &b)
+{
+    uint32_t na=0,nb=0;
+    for(int i=0;i<ANALYSIS_HIST_BINS;i++)
+    {
+        na+=a.hist[i];
+        nb+=b.hist[i];
+    }
+    if(!na || !nb) return 0;
+    float sum=0;
+    for(int i=0;i<ANALYSIS_HIST_BINS;i++)
+    {
+        float d=(float)a.hist[i]/na-(float)b.hist[i]/nb;
+        sum+=(d<0)? -d : d;
+    }
+    return sum/2;
+}
+/**
+    \fn collectPicture
+*/
+static void collectPicture(analysisBatch *batch,int slice,ADMImage *out)
+{
+    analysisJob *job=batch->jobs+slice;
+    if(out->_noPicture || out->Pts==ADM_NO_PTS)
+        return;
+    if(out->Pts<job->windowStart || out->Pts>=job->windowEnd)
+        return;
+    if(job->frames.size() && job->frames.back().pts>=out->Pts)
+        return; // Already seen
+    if(out->refType!=ADM_HW_NONE) // need a plain copy to read it
+    {
+        if(!batch->hwImages[slice])
+            batch->hwImages[slice]=new ADMImageDefault(batch->width,batch->height);
+        ADMImage *copy=batch->hwImages[slice];
+        if(!copy->duplicate(out))
+        {
+            job->error=true;
+            return;
+        }
+        out=copy;
+    }
+    analysisFrame frame;
+    if(!measureFrame(out,batch->darkness,&frame))
+    {
+        job->error=true;
+        return;
+    }
+    job->frames.push_back(frame);
+}
+/**
+    \fn decodeJob
+    \brief Slice of the thread pool, decode a group of GOPs from a fresh decoder state
+*/
+static void decodeJob(void *cookie,int slice)
+{
+    analysisBatch *batch=(analysisBatch *)cookie;
+    analysisJob   *job=batch->jobs+slice;
+    decoders      *codec=batch->codecs[slice];
+    ADMImage      *out=batch->images[slice];
+    ADMCompressedImage img;
+
+    if(!job->packets.size())
+        return;
+    codec->flush();
+    codec->setEndOfStream(false);
+    for(int i=0;i<job->packets.size() && !job->error;i++)
+    {
+        analysisPacket &p=job->packets[i];
+        img.data=&(job->data[p.offset]);
+        img.dataLength=p.length;
+        img.flags=p.flags;
+        img.demuxerFrameNo=p.frame;
+        img.demuxerPts=p.pts;
+        img.demuxerDts=p.dts;
+        out->_colorspace=ADM_COLOR_YV12;
+        if(codec->uncompress(&img,out))
+            collectPicture(batch,slice,out);
+    }
+    // Get the pictures still held by the decoder
+    codec->setDrainingState(true);
+    if(codec->getDrainingState())
+    {
+        img.demuxerPts=ADM_NO_PTS;
+        img.demuxerDts=ADM_NO_PTS;
+        for(int i=0;i<ANALYSIS_MAX_DRAIN && !job->error;i++)
+        {
+            out->_colorspace=ADM_COLOR_YV12;
+            if(codec->uncompress(&img,out))
+            {
+                collectPicture(batch,slice,out);
+                continue;
+            }
+            if(codec->endOfStreamReached())
+                break;
+        }
+    }
+    codec->flush();
+    codec->setEndOfStream(false);
+}
+
+/**
+    \class analysisContext
+    \brief Decoders & pictures for one reference video + the state that spans batches
+*/
+class analysisContext
+{
+public:
+    const ADM_analysisParams *params;
+    ADM_analysisResult       *result;
+    ADM_analysisProgress     *progress;
+    void                     *cookie;
+    uint8_t                  *buffer;      // demuxer output
+    uint64_t                  startTime;   // linear
+    uint64_t                  total;
+    int                       nbSlices;
+    analysisFrame             previous;
+    bool                      havePrevious;
+    bool                      aborted;
+    bool                      done;
+};
+
+/**
+    \fn mergeBatch
+    \brief Turn the measures of the jobs into candidates, in presentation order
+*/
+static void mergeBatch(analysisContext *ctx,analysisJob *jobs,int nbJobs,int64_t toLinear)
+{
+    const ADM_analysisParams *params=ctx->params;
+    for(int j=0;j<nbJobs && !ctx->done;j++)
+    {
+        std::vector <analysisFrame> &frames=jobs[j].frames;
+        for(int i=0;i<frames.size();i++)
+        {
+            analysisFrame &f=frames[i];
+            ADM_analysisCandidate c;
+            c.pts=(uint64_t)((int64_t)f.pts+toLinear);
+            if(params->what & ADM_ANALYSIS_SCENE)
+            {
+                if(ctx->havePrevious)
+                {
+                    float score=sceneDistance(ctx->previous,f);
+                    if(score>params->sceneThreshold)
+                    {
+                        c.what=ADM_ANALYSIS_SCENE;
+                        c.score=score;
+                        ctx->result->push_back(c);
+                    }
+                }
+                ctx->previous=f;
+                ctx->havePrevious=true;
+            }
+            if((params->what & ADM_ANALYSIS_BLACK) && isBlack(f))
+            {
+                c.what=ADM_ANALYSIS_BLACK;
+                c.score=(float)f.nonBlack/(float)f.samples;
+                ctx->result->push_back(c);
+            }
+            if(params->stopAtFirst && ctx->result->size())
+            {
+                ctx->done=true;
+                break;
+            }
+        }
+    }
+}
+
+/**
+    \fn framePts
+*/
+static uint64_t framePts(vidHeader *demuxer,uint32_t frame)
+{
+    uint64_t pts,dts;
+    if(demuxer->getPtsDts(frame,&pts,&dts) && pts!=ADM_NO_PTS)
+        return pts;
+    return demuxer->estimatePts(frame);
+}
+/**
+    \fn isKeyFrame
+*/
+static bool isKeyFrame(vidHeader *demuxer,uint32_t frame)
+{
+    uint32_t flags=0;
+    demuxer->getFlags(frame,&flags);
+    return !!(flags & AVI_KEY_FRAME);
+}
+
+/**
+    \fn analyzeRange
+    \brief Scan [refFrom,refTo[ of one reference video
+    @param toLinear offset to add to a reference time to get the linear (editor) time
+*/
+static bool analyzeRange(analysisContext *ctx,_VIDEOS *vid,uint64_t refFrom,uint64_t refTo,int64_t toLinear)
+{
+    vidHeader *demuxer=vid->_aviheader;
+    aviInfo info;
+    uint32_t extraLen;
+    uint8_t *extraData;
+    demuxer->getVideoInfo(&info);
+    demuxer->getExtraHeaderData(&extraLen,&extraData);
+    uint32_t nbFrames=info.nb_frames;
+    if(!nbFrames)
+        return true;
+    // Start from the keyframe before refFrom, one more if refFrom is a leading B frame of that GOP
+    uint32_t first=0;
+    if(!vid->ptsToFrameOrBefore(refFrom,&first))
+        first=0;
+    while(first && !isKeyFrame(demuxer,first)) first--;
+    if(first && refFrom<framePts(demuxer,first))
+    {
+        first--;
+        while(first && !isKeyFrame(demuxer,first)) first--;
+    }
+    // One decoder & picture per slice
+    int nb=ctx->nbSlices;
+    analysisBatch batch;
+    batch.width=info.width;
+    batch.height=info.height;
+    batch.darkness=ctx->params->darkness;
+    batch.jobs=new analysisJob[nb];
+    batch.codecs=new decoders *[nb];
+    batch.images=new ADMImage *[nb];
+    batch.hwImages=new ADMImage *[nb];
+    bool r=true;
+    for(int i=0;i<nb;i++)
+    {
+        batch.codecs[i]=ADM_getDecoder(info.fcc,info.width,info.height,extraLen,extraData,info.bpp);
+        batch.images[i]=NULL;
+        batch.hwImages[i]=NULL;
+        if(!batch.codecs[i])
+        {
+            ADM_warning("Cannot create decoder %d\n",i);
+            r=false;
+            continue;
+        }
+        if(batch.codecs[i]->dontcopy())
+            batch.images[i]=new ADMImageRef(info.width,info.height);
+        else
+            batch.images[i]=new ADMImageDefault(info.width,info.height);
+    }
+
+    ADMCompressedImage img;
+    img.data=ctx->buffer;
+    uint32_t cur=first;
+    uint64_t windowStart=refFrom;
+    while(r && cur<nbFrames && windowStart<refTo && !ctx->done)
+    {
+        // Demux up to nb jobs
+        int nbJobs=0;
+        while(nbJobs<nb && cur<nbFrames && windowStart<refTo)
+        {
+            analysisJob *job=batch.jobs+nbJobs;
+            job->reset();
+            uint32_t next=cur+1;
+            while(next<nbFrames && (next-cur<ANALYSIS_MIN_JOB_FRAMES || !isKeyFrame(demuxer,next)))
+                next++;
+            // Also feed the leading B frames of the next GOP, they need our reference pictures
+            uint32_t last=next;
+            uint64_t windowEnd=refTo;
+            if(next<nbFrames)
+            {
+                uint32_t flags;
+                windowEnd=framePts(demuxer,next);
+                if(windowEnd==ADM_NO_PTS || windowEnd>refTo)
+                    windowEnd=refTo;
+                last=next+1;
+                while(last<nbFrames)
+                {
+                    flags=0;
+                    demuxer->getFlags(last,&flags);
+                    if(!(flags & AVI_B_FRAME)) break;
+                    last++;
+                }
+            }
+            job->windowStart=windowStart;
+            job->windowEnd=windowEnd;
+            for(uint32_t f=cur;f<last && f<nbFrames;f++)
+            {
+                img.cleanup(f);
+                if(!demuxer->getFrame(f,&img))
+                {
+                    ADM_warning("getFrame failed for frame %" PRIu32"\n",f);
+                    continue;
+                }
+                if(!img.dataLength)
+                    continue;
+                analysisPacket p;
+                p.offset=job->data.size();
+                p.length=img.dataLength;
+                p.flags=img.flags;
+                p.frame=f;
+                p.pts=img.demuxerPts;
+                p.dts=img.demuxerDts;
+                job->data.insert(job->data.end(),img.data,img.data+img.dataLength);
+                job->data.resize(job->data.size()+ANALYSIS_PACKET_PADDING,0);
+                job->packets.push_back(p);
+            }
+            aprintf("[analysis] job %d : frames %u to %u, window %s",nbJobs,cur,last,ADM_us2plain(windowStart));
+            aprintf(" -> %s\n",ADM_us2plain(windowEnd));
+            nbJobs++;
+            cur=next;
+            windowStart=windowEnd;
+        }
+        if(!nbJobs)
+            break;
+        // Decode them in parallel
+        ADM_threadPool::getInstance()->run(nbJobs,decodeJob,&batch);
+        for(int i=0;i<nbJobs;i++)
+            if(batch.jobs[i].error)
+                r=false;
+        if(!r)
+            break;
+        mergeBatch(ctx,batch.jobs,nbJobs,toLinear);
+        // Free the packets now
+        for(int i=0;i<nbJobs;i++)
+            batch.jobs[i].reset();
+        if(ctx->progress)
+        {
+            uint64_t doneUs=(uint64_t)((int64_t)windowStart+toLinear);
+            doneUs=(doneUs>ctx->startTime)? doneUs-ctx->startTime : 0;
+            if(ctx->progress(ctx->cookie,doneUs,ctx->total))
+            {
+                ctx->aborted=true;
+                ctx->done=true;
+            }
+        }
+    }
+    for(int i=0;i<nb;i++)
+    {
+        if(batch.codecs[i]) delete batch.codecs[i];
+        if(batch.images[i]) delete batch.images[i];
+        if(batch.hwImages[i]) delete batch.hwImages[i];
+    }
+    delete [] batch.codecs;
+    delete [] batch.images;
+    delete [] batch.hwImages;
+    delete [] batch.jobs;
+    return r;
+}
+
+/**
+    \fn analyzeVideo
+    \brief Look for black frames / scene changes between startTime and endTime (linear time)
+            Does not change the current position nor use the decoder of the editor
+    @return false on error or if aborted through progress, result contains what has been found so far
+*/
+bool ADM_Composer::analyzeVideo(uint64_t startTime,uint64_t endTime,const ADM_analysisParams &params,ADM_analysisResult &result,
+                                ADM_analysisProgress *progress,void *cookie)
+{
+    result.clear();
+    uint64_t duration=getVideoDuration();
+    if(endTime>duration) endTime=duration;
+    if(startTime>=endTime)
+        return true;
+
+    analysisContext ctx;
+    ctx.params=&params;
+    ctx.result=&result;
+    ctx.progress=progress;
+    ctx.cookie=cookie;
+    ctx.buffer=compBuffer;
+    ctx.startTime=startTime;
+    ctx.total=endTime-startTime;
+    ctx.nbSlices=ADM_threadPool::getInstance()->getNbSlices();
+    ctx.havePrevious=false;
+    ctx.aborted=false;
+    ctx.done=false;
+
+    ADM_info("Analyzing %s",ADM_us2plain(startTime));
+    ADM_info(" to %s with %d slices\n",ADM_us2plain(endTime),ctx.nbSlices);
+    bool r=true;
+    int nbSeg=_segments.getNbSegments();
+    for(int i=0;i<nbSeg && r && !ctx.done;i++)
+    {
+        _SEGMENT *seg=_segments.getSegment(i);
+        uint64_t segStart=seg->_startTimeUs;
+        uint64_t segEnd=segStart+seg->_durationUs;
+        if(segEnd<=startTime) continue;
+        if(segStart>=endTime) break;
+        uint64_t from=(startTime>segStart)? startTime : segStart;
+        uint64_t to=(endTime<segEnd)? endTime : segEnd;
+        int64_t toLinear=(int64_t)segStart-(int64_t)seg->_refStartTimeUs;
+        ctx.havePrevious=false; // An edit point is not a scene change
+        r=analyzeRange(&ctx,_segments.getRefVideo(seg->_reference),
+                       (uint64_t)((int64_t)from-toLinear),(uint64_t)((int64_t)to-toLinear),toLinear);
+    }
+    ADM_info("Analysis done, %d candidates found\n",(int)result.size());
+    if(ctx.aborted)
+        return false;
+    return r;
+}
+//EOF
@@ -76,7 +76,9 @@ bool ADM_Composer::checkForValidPts (_SEGMENT *seg)
     if(!stats.nbBFrames && hdr->providePts()==false)
     {
         ADM_info("No B-frames and no PTS, setting PTS equal DTS\n");
-        return setPtsEqualDts(hdr,inc);
+        bool r=setPtsEqualDts(hdr,inc);
+        _segments.updateRefVideo(); // rebuild the PTS lookup table from the new PTS
+        return r;
     }
     // check whether DTS are completely missing, ignore the first frame
     bool noDts=true;
@@ -93,7 +95,9 @@ bool ADM_Composer::checkForValidPts (_SEGMENT *seg)
     if(!stats.nbBFrames && !stats.nbPtsgoingBack && hdr->providePts() && noDts)
     {
         ADM_info("No B-frames and no DTS, setting DTS equal PTS\n");
-        return setPtsEqualDts(hdr,inc);
+        bool r=setPtsEqualDts(hdr,inc);
+        _segments.updateRefVideo(); // rebuild the PTS lookup table from the new PTS
+        return r;
     }
 
     if(stats.nbPtsgoingBack>1 || (stats.nbBFrames && hdr->providePts()==false))
@@ -282,6 +286,7 @@ bool ADM_Composer::checkForValidPts (_SEGMENT *seg)
             }
         }
         ADM_info("Cancelled %d pts as unreliable \n",processed);
+        vid->rebuildPtsIndex();
 #endif
     }
     goToTimeVideo(from);
@@ -205,6 +205,21 @@ int ADM_Composer::saveFile(const char *name)
 	return A_Save(name);
 }
 
+int ADM_Composer::addRendition(const char *name,uint32_t width,uint32_t height)
+{
+	return A_AddRendition(name,width,height);
+}
+
+void ADM_Composer::clearRenditions(void)
+{
+	A_ClearRenditions();
+}
+
+int ADM_Composer::saveRenditions(void)
+{
+	return A_SaveRenditions();
+}
+
 ADM_dynMuxer* ADM_Composer::getCurrentMuxer()
 {
 	return ListOfMuxers[UI_GetCurrentFormat()];
@@ -528,6 +543,53 @@ void ADM_Composer::seekBlackFrame(int count)
 	}
 }
 
+/**
+    \fn searchBlackFrames
+    \brief Look for all the black frames between start and end, the result is kept for getSearchResult
+*/
+int ADM_Composer::searchBlackFrames(uint64_t start, uint64_t end)
+{
+	ADM_analysisParams params;
+	params.what = ADM_ANALYSIS_BLACK;
+	params.darkness = ADM_ANALYSIS_DEFAULT_DARKNESS;
+	params.sceneThreshold = ADM_ANALYSIS_DEFAULT_SCENE;
+	params.stopAtFirst = false;
+
+	if (!analyzeVideo(start, end, params, lastSearch))
+		ADM_warning("Black frame search failed\n");
+
+	return lastSearch.size();
+}
+
+/**
+    \fn searchSceneChanges
+    \brief Look for all the scene changes between start and end, the result is kept for getSearchResult
+*/
+int ADM_Composer::searchSceneChanges(uint64_t start, uint64_t end, float threshold)
+{
+	ADM_analysisParams params;
+	params.what = ADM_ANALYSIS_SCENE;
+	params.darkness = ADM_ANALYSIS_DEFAULT_DARKNESS;
+	params.sceneThreshold = (threshold > 0) ? threshold : ADM_ANALYSIS_DEFAULT_SCENE;
+	params.stopAtFirst = false;
+
+	if (!analyzeVideo(start, end, params, lastSearch))
+		ADM_warning("Scene change search failed\n");
+
+	return lastSearch.size();
+}
+
+/**
+    \fn getSearchResult
+*/
+uint64_t ADM_Composer::getSearchResult(int index)
+{
+	if (index < 0 || index >= lastSearch.size())
+		return ADM_NO_PTS;
+
+	return lastSearch[index].pts;
+}
+
 void ADM_Composer::updateDefaultAudioTrack(void)
 {
 	EditableAudioTrack *ed = this->getDefaultEditableAudioTrack();
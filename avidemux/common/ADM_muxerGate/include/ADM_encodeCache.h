@@ -0,0 +1,65 @@
+/**
+    \file ADM_encodeCache.h
+    \brief On disk cache of encoded chunks, used to re-export only what changed
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_ENCODE_CACHE_H
+#define ADM_ENCODE_CACHE_H
+#include <string>
+#include <vector>
+#include "ADM_bitstream.h"
+
+#define ADM_ENCODE_CACHE_MAX_MB  4096   // Older entries are deleted above that, new ones are no longer stored
+
+/**
+    \struct ADM_encodedPacketInfo
+*/
+typedef struct
+{
+    uint64_t    offset;     // in payload, not stored
+    uint32_t    len;
+    uint32_t    flags;
+    uint32_t    quantizer;
+    uint64_t    pts;        // relative to the beginning of the chunk
+    uint64_t    dts;
+}ADM_encodedPacketInfo;
+
+/**
+    \class ADM_encodedChunk
+    \brief Everything the encoder produced for one chunk, plus what is needed
+            to check it can be spliced in the current stream
+*/
+class ADM_encodedChunk
+{
+public:
+        std::string                     key;
+        std::string                     fourCC;
+        uint32_t                        width;
+        uint32_t                        height;
+        uint32_t                        frameIncrement;
+        uint32_t                        timeBaseNum;
+        uint32_t                        timeBaseDen;
+        uint64_t                        encoderDelay;
+        std::vector <uint8_t>           extraData;
+        std::vector <ADM_encodedPacketInfo> packets;
+        std::vector <uint8_t>           payload;
+
+                ADM_encodedChunk() {clear();}
+        void    clear(void);
+        void    addPacket(const ADMBitstream *in);
+        bool    getPacket(uint32_t index,ADMBitstream *out);
+        uint32_t nbPackets(void) {return packets.size();}
+};
+
+bool        ADM_encodeCacheLoad(const std::string &key,ADM_encodedChunk *chunk);
+bool        ADM_encodeCacheStore(const ADM_encodedChunk *chunk);
+bool        ADM_encodeCachePrune(const std::vector <std::string> &keep,uint64_t maxBytes);
+#endif
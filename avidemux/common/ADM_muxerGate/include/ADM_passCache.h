@@ -0,0 +1,88 @@
+/**
+    \file ADM_passCache.h
+    \brief Keep the filtered pictures of the first pass on disk so that the second pass
+            does not decode and filter the source again
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_PASS_CACHE_H
+#define ADM_PASS_CACHE_H
+#include <string>
+#include "ADM_coreVideoFilter.h"
+#include "ADM_fileio.h"
+
+#define ADM_PASS_CACHE_MAX_MB (64*1024) // Give up caching above that, the second pass will filter again
+
+/**
+    \struct ADM_passCacheFrame
+    \brief Header of each picture in the cache, followed by the Y, U and V planes without padding.
+            The file only lives for the duration of the export, it is in native byte order.
+*/
+typedef struct
+{
+    uint32_t    frameNumber;
+    uint32_t    flags;
+    uint32_t    qp;
+    uint32_t    bitDepth;
+    uint64_t    pts;
+}ADM_passCacheFrame;
+
+/**
+    \class ADM_passCacheWriter
+    \brief Last filter of the first pass, stores every picture it passes to the encoder
+*/
+class ADM_passCacheWriter : public ADM_coreVideoFilter
+{
+protected:
+                FILE                *file;
+                ADMFile             *out;
+                uint64_t            written;
+                uint32_t            storedDepth;    // bit depth of the stored pictures, 0 until the first one
+                bool                failed;
+                bool                complete;
+                bool                writeFrame(uint32_t frameNumber,ADMImage *image);
+                void                close(void);
+public:
+                            ADM_passCacheWriter(ADM_coreVideoFilter *previous,const std::string &fileName);
+       virtual              ~ADM_passCacheWriter();
+                bool        isComplete(void);   /// true if the whole stream was stored
+                void        getStoredInfo(FilterInfo *stored);
+
+       virtual const char   *getConfiguration(void) {return "pass cache writer";}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek) {return false;}
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+       virtual bool         setQueueDepth(uint32_t frames) {return previousFilter->setQueueDepth(frames);}
+};
+
+/**
+    \class ADM_passCacheReader
+    \brief Replaces the whole filter chain in the second pass, reads the pictures stored by the writer
+*/
+class ADM_passCacheReader : public ADM_coreVideoFilter
+{
+protected:
+                FILE                *file;
+public:
+                            ADM_passCacheReader(const std::string &fileName,const FilterInfo *streamInfo);
+       virtual              ~ADM_passCacheReader();
+                bool        isOpen(void) {return file!=NULL;}
+
+       virtual const char   *getConfiguration(void) {return "pass cache reader";}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek) {return false;}
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+       virtual FilterInfo  *getInfo(void) {return &info;}
+       virtual uint64_t     getAbsoluteStartTime(void) {return 0;}
+       virtual bool         getTimeRange(uint64_t *start, uint64_t *end) {*start=0;*end=info.totalDuration;return true;}
+};
+#endif
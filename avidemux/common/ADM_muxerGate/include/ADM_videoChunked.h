@@ -0,0 +1,111 @@
+/**
+    \file ADM_videoChunked.h
+    \brief Encode the video as independent chunks, reusing the ones already encoded by a previous export
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_VIDEOCHUNKED_H
+#define ADM_VIDEOCHUNKED_H
+#include "ADM_muxer.h"
+#include "ADM_coreVideoEncoder.h"
+#include "ADM_filterChain.h"
+#include "ADM_stageStats.h"
+#include "ADM_encodeCache.h"
+
+class ADM_Composer;
+
+#define ADM_CHUNK_GRID_US (20*1000*1000LL) // Chunks start on the first source keyframe after each multiple of that
+
+/**
+    \struct ADM_encodeChunkDesc
+    \brief One chunk of the output, times are relative to the beginning of the export
+*/
+typedef struct
+{
+    uint64_t    start;
+    uint64_t    end;        // start of the next chunk
+    std::string key;        // identifies the source frames and the filter and encoder settings
+}ADM_encodeChunkDesc;
+
+/**
+    \class ADM_videoChunkGate
+    \brief Last filter before the encoder, ends the stream at the end of the current chunk
+            and rebases the timestamps to its start. The first frame of the next chunk is kept.
+*/
+class ADM_videoChunkGate : public ADM_coreVideoFilter
+{
+protected:
+                uint64_t            chunkStart;
+                uint64_t            chunkEnd;
+                ADMImage            *pending;
+                bool                hasPending;
+public:
+                            ADM_videoChunkGate(ADM_coreVideoFilter *previous);
+       virtual              ~ADM_videoChunkGate();
+                void        setRange(uint64_t start,uint64_t end);
+
+       virtual const char   *getConfiguration(void) {return "chunk gate";}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek) {return false;}
+       virtual bool         setQueueDepth(uint32_t frames) {return previousFilter->setQueueDepth(frames);}
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+};
+
+/**
+    \class ADM_videoStreamChunked
+    \brief Each chunk is encoded by a new encoder, starting with a keyframe, and stored
+            in the encode cache. The chunks already in the cache are copied from it.
+            Consecutive chunks to encode share the same filter chain.
+*/
+class ADM_videoStreamChunked: public ADM_videoStream
+{
+protected:
+            uint64_t                markerA;
+            uint64_t                markerB;
+            int                     encoderIndex;
+            bool                    globalHeader;
+            std::vector <ADM_encodeChunkDesc> chunks;
+            int                     current;        // chunk being sent
+            bool                    currentCached;
+            uint32_t                packetIndex;    // next packet of the cached chunk
+            ADM_encodedChunk        chunk;          // read from the cache or being recorded
+            ADM_encodedChunk        reference;      // parameters of the first chunk, the others must match
+            ADM_videoFilterChain    *chain;
+            ADM_videoChunkGate      *gate;
+            uint64_t                chainBase;      // start of the chain, its timestamps are relative to it
+            int                     chainNext;      // chunk the chain will produce next, -1 if none
+            ADM_coreVideoEncoder    *encoder;
+            uint64_t                chunkDelay;     // encoder delay of the current chunk
+            bool                    firstPacket;
+            uint64_t                lastDts;
+            uint32_t                hits;
+            uint32_t                misses;
+            ADM_stageStats          *stats;
+
+                                    ADM_videoStreamChunked(uint64_t markerA,uint64_t markerB,int encoderIndex,bool globalHeader,
+                                                            const std::vector <ADM_encodeChunkDesc> &chunks);
+            bool                    openChunk(int index);
+            bool                    startEncoder(int index);
+            void                    closeChunk(void);
+            void                    destroyChain(void);
+            bool                    matchesReference(ADM_encodedChunk *c);
+public:
+    static  ADM_videoStreamChunked  *create(ADM_Composer *editor,uint64_t markerA,uint64_t markerB,int encoderIndex,bool globalHeader);
+    virtual                         ~ADM_videoStreamChunked();
+
+virtual     bool                    getPacket(ADMBitstream *out);
+virtual     bool                    getExtraData(uint32_t *extraLen, uint8_t **extraData) ;
+virtual     bool                    providePts(void) {return true;}
+virtual     uint64_t                getVideoDuration(void) {return markerB-markerA;}
+virtual     bool                    isDualPass(void) {return false;}
+};
+
+#endif
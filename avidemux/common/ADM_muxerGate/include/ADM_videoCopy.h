@@ -9,6 +9,7 @@
 
 */
 #include "ADM_compressedImage.h"
+#include "ADM_packetPrefetch.h"
 
 class ADM_videoStreamCopy: public ADM_videoStream
 {
@@ -21,8 +22,11 @@ protected:
             bool sanitizeDts;
             uint64_t  rescaleTs(uint64_t in);
             uint64_t  rewindTime;
+            ADM_packetPrefetch *prefetch; // created on the first packet, reads ahead of the muxer
+            bool      prefetchDone; // set by the prefetch thread once it has read past endTimePts
 
             bool      rewind(void);
+     static bool      prefetchReader(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet);
 public:
              ADM_videoStreamCopy(uint64_t startTime,uint64_t endTime);
     virtual ~ADM_videoStreamCopy();
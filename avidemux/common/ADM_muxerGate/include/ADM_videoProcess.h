@@ -20,6 +20,7 @@
 */
 #include "ADM_compressedImage.h"
 #include "ADM_coreVideoEncoder.h"
+#include "ADM_stageStats.h"
 /**
     \class ADM_videoStreamProcess
     \brief Wrapper around encoder
@@ -31,6 +32,7 @@ class ADM_videoStreamProcess: public ADM_videoStream
 protected:
             ADM_coreVideoEncoder *encoder;
             bool    firstPacket;
+            ADM_stageStats *stats;
 public:
              ADM_videoStreamProcess(ADM_coreVideoEncoder *encoder);
     virtual ~ADM_videoStreamProcess();
@@ -0,0 +1,52 @@
+/**
+    \file ADM_videoSpool.h
+    \brief Encode a video stream to a scratch file now, mux it later
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_VIDEOSPOOL_H
+#define ADM_VIDEOSPOOL_H
+#include <string>
+#include <vector>
+#include "ADM_muxer.h"
+#include "ADM_encodeCache.h"
+
+#define ADM_VIDEO_SPOOL_MIN_BUFFER (1024*1024) // packet buffer for very small pictures
+
+/**
+    \class ADM_videoStreamSpool
+    \brief record() pulls every packet from the source stream and stores it in a scratch file,
+            it can run on its own thread. The spool then replays the packets as they were,
+            with the parameters of the source. The source is deleted by record().
+*/
+class ADM_videoStreamSpool: public ADM_videoStream
+{
+protected:
+            ADM_videoStream                     *source;
+            std::string                         fileName;
+            FILE                                *file;
+            std::vector <ADM_encodedPacketInfo> packets;
+            std::vector <uint8_t>               extraData;
+            uint64_t                            duration;
+            uint32_t                            next;
+            bool                                recorded;
+public:
+                                    ADM_videoStreamSpool(ADM_videoStream *source,const std::string &fileName);
+    virtual                         ~ADM_videoStreamSpool();
+            bool                    record(volatile bool *abort);
+            bool                    isRecorded(void) {return recorded;}
+
+virtual     bool                    getPacket(ADMBitstream *out);
+virtual     bool                    getExtraData(uint32_t *extraLen, uint8_t **extraData);
+virtual     bool                    providePts(void) {return true;}
+virtual     uint64_t                getVideoDuration(void) {return duration;}
+};
+
+#endif
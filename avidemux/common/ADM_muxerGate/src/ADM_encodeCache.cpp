@@ -0,0 +1,350 @@
+/**
+    \file ADM_encodeCache
+    \brief On disk cache of encoded chunks
+
+    Each chunk is stored in ~/.avidemux6/encodeCache/<hash of its key>.chunk
+    The full key is stored in the file, so that a hash collision is a miss.
+    Everything is written in little endian.
+
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_encodeCache.h"
+#include <set>
+
+#define CACHE_MAGIC     "ADMCHNK1"
+#define CACHE_EXT       "chunk"
+#define CACHE_MAX_FILES 8192
+#define CACHE_MAX_EXTRA (1024*1024)
+#define CACHE_MAX_PACKETS (16*1024*1024)
+
+static uint64_t cacheBytes=0; // Set by ADM_encodeCachePrune, grows with each ADM_encodeCacheStore
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+/**
+    \fn clear
+*/
+void ADM_encodedChunk::clear(void)
+{
+    key.clear();
+    fourCC.clear();
+    width=height=0;
+    frameIncrement=0;
+    timeBaseNum=timeBaseDen=0;
+    encoderDelay=0;
+    extraData.clear();
+    packets.clear();
+    payload.clear();
+}
+/**
+    \fn addPacket
+*/
+void ADM_encodedChunk::addPacket(const ADMBitstream *in)
+{
+    ADM_encodedPacketInfo info;
+    info.offset=payload.size();
+    info.len=in->len;
+    info.flags=in->flags;
+    info.quantizer=in->out_quantizer;
+    info.pts=in->pts;
+    info.dts=in->dts;
+    packets.push_back(info);
+    payload.insert(payload.end(),in->data,in->data+in->len);
+}
+/**
+    \fn getPacket
+*/
+bool ADM_encodedChunk::getPacket(uint32_t index,ADMBitstream *out)
+{
+    if(index>=packets.size())
+        return false;
+    ADM_encodedPacketInfo &info=packets[index];
+    if(out->acceptRef)
+    {
+        // The chunk is kept until the next packet is requested
+        out->setRef(new ADM_bitstreamRef,payload.data()+info.offset,info.len);
+    }else
+    {
+        if(info.len>out->bufferSize)
+        {
+            ADM_error("Cached packet too big (%" PRIu32" vs %" PRIu32")\n",info.len,out->bufferSize);
+            return false;
+        }
+        memcpy(out->data,payload.data()+info.offset,info.len);
+        out->len=info.len;
+    }
+    out->flags=info.flags;
+    out->out_quantizer=info.quantizer;
+    out->pts=info.pts;
+    out->dts=info.dts;
+    return true;
+}
+
+/**
+    \fn cacheFileName
+    \brief FNV-1a hash of the key
+*/
+static std::string cacheFileName(const std::string &key)
+{
+    uint64_t h=0xcbf29ce484222325ULL;
+    for(int i=0;i<key.size();i++)
+    {
+        h^=(uint8_t)key[i];
+        h*=0x100000001b3ULL;
+    }
+    char name[32];
+    snprintf(name,sizeof(name),"%016" PRIx64"." CACHE_EXT,h);
+    return std::string(name);
+}
+/**
+    \fn cacheDir
+*/
+static std::string cacheDir(void)
+{
+    char *dir=ADM_getHomeRelativePath("encodeCache");
+    std::string s(dir);
+    delete [] dir;
+    return s;
+}
+
+static void write32(FILE *f,uint32_t v)
+{
+    uint8_t b[4];
+    for(int i=0;i<4;i++)
+        b[i]=(uint8_t)(v>>(8*i));
+    fwrite(b,4,1,f);
+}
+static void write64(FILE *f,uint64_t v)
+{
+    write32(f,(uint32_t)v);
+    write32(f,(uint32_t)(v>>32));
+}
+static bool read32(FILE *f,uint32_t *v)
+{
+    uint8_t b[4];
+    if(fread(b,4,1,f)!=1)
+        return false;
+    *v=b[0]+(b[1]<<8)+(b[2]<<16)+((uint32_t)b[3]<<24);
+    return true;
+}
+static bool read64(FILE *f,uint64_t *v)
+{
+    uint32_t lo,hi;
+    if(!read32(f,&lo) || !read32(f,&hi))
+        return false;
+    *v=((uint64_t)hi<<32)+lo;
+    return true;
+}
+static void writeString(FILE *f,const std::string &s)
+{
+    write32(f,s.size());
+    fwrite(s.data(),s.size(),1,f);
+}
+static bool readString(FILE *f,std::string &s)
+{
+    uint32_t l;
+    if(!read32(f,&l) || l>CACHE_MAX_EXTRA)
+        return false;
+    s.resize(l);
+    if(l && fread(&(s[0]),l,1,f)!=1)
+        return false;
+    return true;
+}
+
+/**
+    \fn readChunk
+*/
+static bool readChunk(FILE *f,const std::string &key,ADM_encodedChunk *chunk)
+{
+    char magic[8];
+    if(fread(magic,8,1,f)!=1 || memcmp(magic,CACHE_MAGIC,8))
+        return false;
+    if(!readString(f,chunk->key) || chunk->key!=key)
+        return false;
+    if(!readString(f,chunk->fourCC))
+        return false;
+    if(!read32(f,&chunk->width) || !read32(f,&chunk->height) || !read32(f,&chunk->frameIncrement))
+        return false;
+    if(!read32(f,&chunk->timeBaseNum) || !read32(f,&chunk->timeBaseDen) || !read64(f,&chunk->encoderDelay))
+        return false;
+    uint32_t extraLen,nb;
+    if(!read32(f,&extraLen) || extraLen>CACHE_MAX_EXTRA)
+        return false;
+    chunk->extraData.resize(extraLen);
+    if(extraLen && fread(chunk->extraData.data(),extraLen,1,f)!=1)
+        return false;
+    if(!read32(f,&nb) || nb>CACHE_MAX_PACKETS)
+        return false;
+    chunk->packets.resize(nb);
+    uint64_t total=0;
+    for(uint32_t i=0;i<nb;i++)
+    {
+        ADM_encodedPacketInfo &p=chunk->packets[i];
+        if(!read32(f,&p.len) || !read32(f,&p.flags) || !read32(f,&p.quantizer) || !read64(f,&p.pts) || !read64(f,&p.dts))
+            return false;
+        p.offset=total;
+        total+=p.len;
+    }
+    uint64_t payloadLen;
+    if(!read64(f,&payloadLen) || payloadLen!=total)
+        return false;
+    chunk->payload.resize(total);
+    if(total && fread(chunk->payload.data(),total,1,f)!=1)
+        return false;
+    return true;
+}
+/**
+    \fn ADM_encodeCacheLoad
+    \return false if the chunk is not in the cache or cannot be read
+*/
+bool ADM_encodeCacheLoad(const std::string &key,ADM_encodedChunk *chunk)
+{
+    std::string name=cacheDir()+std::string(ADM_SEPARATOR)+cacheFileName(key);
+    FILE *f=ADM_fopen(name.c_str(),"rb");
+    if(!f)
+        return false;
+    chunk->clear();
+    bool r=readChunk(f,key,chunk);
+    fclose(f);
+    if(!r)
+    {
+        ADM_warning("Cannot use cached chunk %s\n",name.c_str());
+        chunk->clear();
+    }
+    return r;
+}
+/**
+    \fn ADM_encodeCacheStore
+    \brief Write to a temporary file first so that an interrupted write never looks valid.
+            Nothing is stored once the cache reached ADM_ENCODE_CACHE_MAX_MB, the next prune makes room.
+*/
+bool ADM_encodeCacheStore(const ADM_encodedChunk *chunk)
+{
+    std::string name=cacheDir()+std::string(ADM_SEPARATOR)+cacheFileName(chunk->key);
+    std::string tmp=name+std::string(".tmp");
+    uint64_t size=chunk->payload.size()+chunk->packets.size()*sizeof(ADM_encodedPacketInfo);
+    if(cacheBytes+size>((uint64_t)ADM_ENCODE_CACHE_MAX_MB<<20))
+    {
+        ADM_warning("Encode cache is full (%" PRIu64" MB), not storing %s\n",cacheBytes>>20,name.c_str());
+        return false;
+    }
+    FILE *f=ADM_fopen(tmp.c_str(),"wb");
+    if(!f)
+    {
+        ADM_warning("Cannot create %s\n",tmp.c_str());
+        return false;
+    }
+    fwrite(CACHE_MAGIC,8,1,f);
+    writeString(f,chunk->key);
+    writeString(f,chunk->fourCC);
+    write32(f,chunk->width);
+    write32(f,chunk->height);
+    write32(f,chunk->frameIncrement);
+    write32(f,chunk->timeBaseNum);
+    write32(f,chunk->timeBaseDen);
+    write64(f,chunk->encoderDelay);
+    write32(f,chunk->extraData.size());
+    if(chunk->extraData.size())
+        fwrite(chunk->extraData.data(),chunk->extraData.size(),1,f);
+    write32(f,chunk->packets.size());
+    for(int i=0;i<chunk->packets.size();i++)
+    {
+        const ADM_encodedPacketInfo &p=chunk->packets[i];
+        write32(f,p.len);
+        write32(f,p.flags);
+        write32(f,p.quantizer);
+        write64(f,p.pts);
+        write64(f,p.dts);
+    }
+    write64(f,chunk->payload.size());
+    if(chunk->payload.size())
+        fwrite(chunk->payload.data(),chunk->payload.size(),1,f);
+    bool r=!ferror(f);
+    r&=!fclose(f);
+    if(r)
+    {
+        int64_t old=ADM_fileSize(name.c_str());
+        if(old>0 && ADM_eraseFile(name.c_str()))
+            cacheBytes-=((uint64_t)old>cacheBytes)? cacheBytes : old;
+        r=ADM_renameFile(tmp.c_str(),name.c_str());
+        if(r)
+        {
+            int64_t stored=ADM_fileSize(name.c_str());
+            if(stored>0)
+                cacheBytes+=stored;
+        }
+    }
+    if(!r)
+    {
+        ADM_warning("Cannot write %s\n",name.c_str());
+        ADM_eraseFile(tmp.c_str());
+    }
+    aprintf("[encodeCache] Stored %s, %d packets\n",name.c_str(),(int)chunk->packets.size());
+    return r;
+}
+/**
+    \fn ADM_encodeCachePrune
+    \brief Create the cache if needed. If it is bigger than maxBytes, delete the entries not in keep until it fits
+*/
+bool ADM_encodeCachePrune(const std::vector <std::string> &keep,uint64_t maxBytes)
+{
+    std::string dir=cacheDir();
+    if(!ADM_mkdir(dir.c_str()))
+    {
+        ADM_warning("Cannot create %s\n",dir.c_str());
+        return false;
+    }
+    std::set <std::string> kept;
+    for(int i=0;i<keep.size();i++)
+        kept.insert(dir+std::string(ADM_SEPARATOR)+cacheFileName(keep[i]));
+
+    char **files=new char *[CACHE_MAX_FILES];
+    uint32_t nb=0;
+    memset(files,0,sizeof(char *)*CACHE_MAX_FILES);
+    if(!buildDirectoryContent(&nb,dir.c_str(),files,CACHE_MAX_FILES,CACHE_EXT))
+    {
+        delete [] files;
+        cacheBytes=0;
+        return true;
+    }
+    std::vector <int64_t> sizes(nb);
+    uint64_t total=0;
+    for(uint32_t i=0;i<nb;i++)
+    {
+        sizes[i]=ADM_fileSize(files[i]);
+        if(sizes[i]>0)
+            total+=sizes[i];
+    }
+    uint32_t deleted=0;
+    for(uint32_t i=0;i<nb && total>maxBytes;i++)
+    {
+        if(kept.count(std::string(files[i])))
+            continue;
+        if(!ADM_eraseFile(files[i]))
+            continue;
+        if(sizes[i]>0)
+            total-=sizes[i];
+        deleted++;
+    }
+    if(deleted)
+        ADM_info("Deleted %" PRIu32" cached chunks, the cache now uses %" PRIu64" MB\n",deleted,total>>20);
+    clearDirectoryContent(nb,files);
+    delete [] files;
+    cacheBytes=total;
+    return true;
+}
+// EOF
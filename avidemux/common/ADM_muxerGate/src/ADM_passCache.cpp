@@ -0,0 +1,305 @@
+/**
+    \file ADM_passCache
+    \brief Keep the filtered pictures of the first pass on disk
+
+    The writer sits between the filter chain and the first pass encoder and stores
+    every picture the encoder gets, through a write-behind ADMFile so that the
+    encoder does not wait for the disk. If the whole stream was stored, the second
+    pass reads the pictures back instead of decoding and filtering the source again.
+    The pictures are stored raw, i.e. lossless.
+
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_passCache.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+static const ADM_PLANE cachePlanes[3]={PLANAR_Y,PLANAR_U,PLANAR_V};
+
+/**
+    \fn rowBytes
+    \brief Size of one row of the plane, without padding
+*/
+static uint32_t rowBytes(ADMImage *image,ADM_PLANE plane)
+{
+    uint32_t w=image->GetWidth(plane);
+    if(image->_bitDepth>8)
+        w*=2;
+    return w;
+}
+/**
+    \fn frameBytes
+*/
+static uint64_t frameBytes(ADMImage *image)
+{
+    uint64_t total=sizeof(ADM_passCacheFrame);
+    for(int i=0;i<3;i++)
+        total+=(uint64_t)rowBytes(image,cachePlanes[i])*image->GetHeight(cachePlanes[i]);
+    return total;
+}
+
+/**
+    \fn estimatedBytes
+    \brief Expected size of the cache for the whole stream, from the filter chain output
+*/
+static uint64_t estimatedBytes(const FilterInfo *info)
+{
+    if(!info->frameIncrement)
+        return 0;
+    uint64_t frames=info->totalDuration/info->frameIncrement+1;
+    uint64_t size=(uint64_t)info->width*info->height;
+    size+=2*(uint64_t)((info->width+1)>>1)*((info->height+1)>>1);
+    if(info->bitDepth>8)
+        size*=2;
+    return frames*(size+sizeof(ADM_passCacheFrame));
+}
+/**
+    \fn ADM_passCacheWriter
+    \brief Nothing is stored if the stream would not fit, either within ADM_PASS_CACHE_MAX_MB
+            or on the disk
+*/
+ADM_passCacheWriter::ADM_passCacheWriter(ADM_coreVideoFilter *previous,const std::string &fileName) :
+        ADM_coreVideoFilter(previous,NULL)
+{
+    myName="passCacheWriter";
+    written=0;
+    storedDepth=0;
+    failed=false;
+    complete=false;
+    out=NULL;
+    file=NULL;
+    uint64_t estimate=estimatedBytes(&info);
+    uint64_t mb=estimate>>20;
+    if(mb>ADM_PASS_CACHE_MAX_MB)
+    {
+        ADM_warning("The first pass pictures would need about %" PRIu64" MB, more than %d MB, not caching them\n",
+                    mb,ADM_PASS_CACHE_MAX_MB);
+        failed=true;
+        return;
+    }
+    std::string folder=ADM_extractPath(fileName);
+    if(folder.empty() || folder==fileName)
+        folder=std::string(".");
+    int64_t freeSpace=ADM_diskFreeSpace(folder.c_str());
+    if(freeSpace>=0 && estimate>(uint64_t)freeSpace)
+    {
+        ADM_warning("The first pass pictures would need about %" PRIu64" MB, only %" PRId64" MB free in %s, not caching them\n",
+                    mb,freeSpace>>20,folder.c_str());
+        failed=true;
+        return;
+    }
+    file=ADM_fopen(fileName.c_str(),"wb");
+    if(!file)
+    {
+        ADM_warning("Cannot create %s, the second pass will filter the video again\n",fileName.c_str());
+        failed=true;
+        return;
+    }
+    out=new ADMFile;
+    out->open(file,true);
+    ADM_info("Storing the first pass pictures in %s\n",fileName.c_str());
+}
+/**
+    \fn ~ADM_passCacheWriter
+*/
+ADM_passCacheWriter::~ADM_passCacheWriter()
+{
+    close();
+}
+/**
+    \fn close
+    \brief Wait for the pending writes, the cache is only valid if they all succeeded
+*/
+void ADM_passCacheWriter::close(void)
+{
+    if(out)
+    {
+        if(!out->flush())
+            failed=true;
+        delete out;
+        out=NULL;
+    }
+    if(file)
+    {
+        if(ferror(file))
+            failed=true;
+        if(fclose(file))
+            failed=true;
+        file=NULL;
+    }
+}
+/**
+    \fn isComplete
+*/
+bool ADM_passCacheWriter::isComplete(void)
+{
+    close();
+    if(failed)
+        return false;
+    return complete;
+}
+/**
+    \fn getStoredInfo
+    \brief Stream description for the reader. The pictures are stored as the encoder got them,
+            their bit depth can differ from the one of the filter chain.
+*/
+void ADM_passCacheWriter::getStoredInfo(FilterInfo *stored)
+{
+    memcpy(stored,&info,sizeof(info));
+    if(storedDepth)
+        stored->bitDepth=storedDepth;
+}
+/**
+    \fn writeFrame
+*/
+bool ADM_passCacheWriter::writeFrame(uint32_t frameNumber,ADMImage *image)
+{
+    uint64_t size=frameBytes(image);
+    if(written+size>((uint64_t)ADM_PASS_CACHE_MAX_MB<<20))
+    {
+        ADM_warning("The first pass pictures exceed %d MB, not caching them\n",ADM_PASS_CACHE_MAX_MB);
+        return false;
+    }
+    if(!storedDepth)
+        storedDepth=image->_bitDepth;
+    if(storedDepth!=image->_bitDepth)
+    {
+        ADM_warning("The bit depth of the first pass pictures changed, not caching them\n");
+        return false;
+    }
+    ADM_passCacheFrame hdr;
+    hdr.frameNumber=frameNumber;
+    hdr.flags=image->flags;
+    hdr.qp=image->_Qp;
+    hdr.bitDepth=image->_bitDepth;
+    hdr.pts=image->Pts;
+    if(!out->write((uint8_t *)&hdr,sizeof(hdr)))
+    {
+        ADM_warning("Cannot write to the first pass cache, not caching the pictures\n");
+        return false;
+    }
+    for(int i=0;i<3;i++)
+    {
+        ADM_PLANE plane=cachePlanes[i];
+        uint32_t row=rowBytes(image,plane);
+        uint32_t pitch=image->GetPitch(plane);
+        int h=image->GetHeight(plane);
+        uint8_t *src=image->GetReadPtr(plane);
+        bool r=true;
+        if(pitch==row)
+        {
+            r=!!out->write(src,row*h);
+        }else
+        {
+            for(int y=0;r && y<h;y++)
+            {
+                r=!!out->write(src,row);
+                src+=pitch;
+            }
+        }
+        if(!r)
+        {
+            ADM_warning("Cannot write to the first pass cache, not caching the pictures\n");
+            return false;
+        }
+    }
+    written+=size;
+    aprintf("[passCache] Stored frame %" PRIu32", pts %" PRIu64"\n",frameNumber,image->Pts);
+    return true;
+}
+/**
+    \fn getNextFrame
+*/
+bool ADM_passCacheWriter::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    if(!previousFilter->getNextFrame(frameNumber,image))
+    {
+        complete=true;
+        return false;
+    }
+    if(!failed && !writeFrame(*frameNumber,image))
+    {
+        failed=true;
+        close();
+    }
+    return true;
+}
+
+/**
+    \fn ADM_passCacheReader
+*/
+ADM_passCacheReader::ADM_passCacheReader(const std::string &fileName,const FilterInfo *streamInfo) :
+        ADM_coreVideoFilter(NULL,NULL)
+{
+    myName="passCacheReader";
+    memcpy(&info,streamInfo,sizeof(info));
+    file=ADM_fopen(fileName.c_str(),"rb");
+    if(!file)
+        ADM_warning("Cannot open %s\n",fileName.c_str());
+}
+/**
+    \fn ~ADM_passCacheReader
+*/
+ADM_passCacheReader::~ADM_passCacheReader()
+{
+    if(file)
+        fclose(file);
+    file=NULL;
+}
+/**
+    \fn getNextFrame
+*/
+bool ADM_passCacheReader::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    if(!file)
+        return false;
+    ADM_passCacheFrame hdr;
+    if(fread(&hdr,sizeof(hdr),1,file)!=1)
+        return false;
+    if(hdr.bitDepth!=image->_bitDepth)
+    {
+        ADM_error("Cached picture is %" PRIu32" bits, expected %" PRIu32"\n",hdr.bitDepth,image->_bitDepth);
+        return false;
+    }
+    for(int i=0;i<3;i++)
+    {
+        ADM_PLANE plane=cachePlanes[i];
+        uint32_t row=rowBytes(image,plane);
+        uint32_t pitch=image->GetPitch(plane);
+        int h=image->GetHeight(plane);
+        uint8_t *dst=image->GetWritePtr(plane);
+        if(pitch==row)
+        {
+            if(fread(dst,row*h,1,file)!=1)
+                return false;
+            continue;
+        }
+        for(int y=0;y<h;y++)
+        {
+            if(fread(dst,row,1,file)!=1)
+                return false;
+            dst+=pitch;
+        }
+    }
+    *frameNumber=hdr.frameNumber;
+    image->flags=hdr.flags;
+    image->_Qp=hdr.qp;
+    image->Pts=hdr.pts;
+    nextFrame++;
+    return true;
+}
+// EOF
@@ -0,0 +1,591 @@
+/**
+    \file ADM_videoChunked
+    \brief Encode the video as independent chunks, reusing the ones already encoded by a previous export
+
+    The output is cut at the first source keyframe after every ADM_CHUNK_GRID_US
+    of each source video, and at segment boundaries. The grid is in source time,
+    so that cutting or moving a part of the video only changes the chunks
+    around the edit, the others keep the same source frames.
+
+    Each chunk is encoded by its own encoder instance, i.e. it starts with a
+    keyframe and does not reference any other chunk. The key of a chunk
+    describes everything the encoded data depends on: the source frames,
+    the post processing, the filters and the encoder settings. When the key
+    is already in the cache, the packets are read from there instead.
+
+    Only filters working on one frame at a time without looking at its
+    timestamp are allowed, the others would give a different result depending
+    on where the chunk starts. Two pass encoding is not supported.
+
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_videoChunked.h"
+#include "ADM_edit.hxx"
+#include "ADM_videoEncoderApi.h"
+#include "ADM_videoFilterApi.h"
+#include "ADM_vidMisc.h"
+#include "ADM_trace.h"
+#include "fourcc.h"
+#include <algorithm>
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf ADM_info
+#endif
+
+/**
+    Filters whose output only depends on the current picture and their settings
+*/
+static const char *chunkSafeFilters[]=
+{
+    "crop","swscale","addBorder","blackenBorder","rotate","hflip","vflip","swapUV",
+    "lumaonly","rplane","contrast","eq2","hue","chromashift",NULL
+};
+
+/**
+    \fn ADM_videoChunkGate
+*/
+ADM_videoChunkGate::ADM_videoChunkGate(ADM_coreVideoFilter *previous) : ADM_coreVideoFilter(previous,NULL)
+{
+    myName="chunkGate";
+    chunkStart=0;
+    chunkEnd=0;
+    pending=new ADMImageDefault(info.width,info.height,info.bitDepth);
+    hasPending=false;
+}
+/**
+    \fn ~ADM_videoChunkGate
+*/
+ADM_videoChunkGate::~ADM_videoChunkGate()
+{
+    delete pending;
+    pending=NULL;
+}
+/**
+    \fn setRange
+    \brief Next chunk, times are relative to the start of the chain
+*/
+void ADM_videoChunkGate::setRange(uint64_t start,uint64_t end)
+{
+    chunkStart=start;
+    chunkEnd=end;
+    info.totalDuration=end-start;
+    nextFrame=0;
+}
+/**
+    \fn getNextFrame
+*/
+bool ADM_videoChunkGate::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    while(true)
+    {
+        if(hasPending)
+        {
+            image->duplicate(pending);
+            hasPending=false;
+        }else
+        {
+            uint32_t fn;
+            if(false==previousFilter->getNextFrame(&fn,image))
+                return false;
+        }
+        if(image->Pts==ADM_NO_PTS || image->Pts<chunkStart)
+        {
+            ADM_warning("[chunkGate] Dropping frame before the chunk (%s)\n",ADM_us2plain(image->Pts));
+            continue;
+        }
+        if(image->Pts>=chunkEnd)
+        {
+            pending->duplicate(image);
+            hasPending=true;
+            return false;
+        }
+        break;
+    }
+    image->Pts-=chunkStart;
+    *frameNumber=nextFrame++;
+    return true;
+}
+
+/**
+    \fn addCouples
+*/
+static void addCouples(std::string &key,CONFcouple *c)
+{
+    if(!c)
+        return;
+    for(uint32_t i=0;i<c->getSize();i++)
+    {
+        char *name,*value;
+        c->getInternalName(i,&name,&value);
+        key+=std::string(name)+std::string("=")+std::string(value)+std::string(",");
+    }
+}
+/**
+    \fn settingsKey
+    \brief Everything but the source frames, false if a filter prevents chunked encoding
+*/
+static bool settingsKey(ADM_Composer *editor,int encoderIndex,bool globalHeader,std::string &key)
+{
+    char str[256];
+    for(int i=0;i<ADM_VideoFilters.size();i++)
+    {
+        uint32_t tag=ADM_VideoFilters[i].tag;
+        const char *name=ADM_vf_getInternalNameFromTag(tag);
+        bool safe=false;
+        for(int j=0;name && chunkSafeFilters[j];j++)
+            if(!strcmp(name,chunkSafeFilters[j]))
+                safe=true;
+        if(!safe)
+        {
+            ADM_info("The %s filter depends on the other frames or on time, encoding the whole video\n",name? name : "?");
+            return false;
+        }
+        CONFcouple *c=NULL;
+        ADM_VideoFilters[i].instance->getCoupledConf(&c);
+        key+=std::string("filter:")+std::string(name)+std::string(":");
+        addCouples(key,c);
+        if(c) delete c;
+        key+=std::string("|");
+    }
+    key+=std::string("encoder:")+std::string(videoEncoder6_GetCurrentEncoderName())+std::string(":");
+    CONFcouple *c=NULL;
+    if(videoEncoder6_GetConfiguration(&c))
+    {
+        addCouples(key,c);
+        if(c) delete c;
+    }
+    uint32_t ppType=0,ppStrength=0,num=0,den=0;
+    bool swapUv=false;
+    editor->getPostProc(&ppType,&ppStrength,&swapUv);
+    editor->getTimeBase(&num,&den);
+    snprintf(str,sizeof(str),"|index:%d|global:%d|pp:%" PRIu32",%" PRIu32",%d|timebase:%" PRIu32"/%" PRIu32"|increment:%" PRIu64,
+                encoderIndex,(int)globalHeader,ppType,ppStrength,(int)swapUv,num,den,editor->getFrameIncrement());
+    key+=std::string(str);
+    return true;
+}
+/**
+    \fn sourceKeyFrames
+    \brief Sorted pts of the keyframes of a source video
+*/
+static void sourceKeyFrames(_VIDEOS *v,std::vector <uint64_t> &list)
+{
+    list.clear();
+    for(uint32_t i=0;i<v->_nb_video_frames;i++)
+    {
+        uint32_t flags;
+        uint64_t pts,dts;
+        v->_aviheader->getFlags(i,&flags);
+        if(!(flags & AVI_KEY_FRAME))
+            continue;
+        v->_aviheader->getPtsDts(i,&pts,&dts);
+        if(pts==ADM_NO_PTS)
+            continue;
+        list.push_back(pts);
+    }
+    std::sort(list.begin(),list.end());
+}
+/**
+    \fn sourceKey
+    \brief Identify the file of a source video: name, size, modification time and a hash
+            of its first and last MB, so that a file replaced by another one is a miss.
+*/
+#define CHUNK_HASH_SIZE (1024*1024)
+static std::string sourceKey(_VIDEOS *v)
+{
+    char str[256];
+    std::string name=std::string(v->_aviheader->getMyName());
+    int64_t size=ADM_fileSize(name.c_str());
+    uint64_t h=0xcbf29ce484222325ULL; // FNV-1a
+    FILE *f=ADM_fopen(name.c_str(),"rb");
+    if(f)
+    {
+        uint8_t *buffer=new uint8_t[CHUNK_HASH_SIZE];
+        for(int part=0;part<2;part++)
+        {
+            if(part)
+            {
+                if(size<=2*CHUNK_HASH_SIZE) // already hashed or overlapping
+                    break;
+                fseeko(f,size-CHUNK_HASH_SIZE,SEEK_SET);
+            }
+            size_t n=fread(buffer,1,CHUNK_HASH_SIZE,f);
+            for(size_t i=0;i<n;i++)
+            {
+                h^=buffer[i];
+                h*=0x100000001b3ULL;
+            }
+        }
+        delete [] buffer;
+        fclose(f);
+    }
+    snprintf(str,sizeof(str),"|size:%" PRId64"|mtime:%" PRId64"|hash:%016" PRIx64"|frames:%" PRIu32,
+                size,ADM_fileMtime(name.c_str()),h,v->_nb_video_frames);
+    return name+std::string(str);
+}
+/**
+    \fn splitInChunks
+    \brief Cut [markerA,markerB] in chunks, on segment boundaries and on the source keyframes following the grid
+*/
+static bool splitInChunks(ADM_Composer *editor,uint64_t markerA,uint64_t markerB,const std::string &settings,std::vector <ADM_encodeChunkDesc> &chunks)
+{
+    char str[256];
+    uint64_t exportEnd=markerB+1; // the frame at markerB is included
+    std::vector < std::vector <uint64_t> > keyFrames(editor->getVideoCount());
+    std::vector <std::string> sources(editor->getVideoCount());
+    std::vector <bool> scanned(editor->getVideoCount(),false);
+    chunks.clear();
+    for(int i=0;i<editor->getNbSegment();i++)
+    {
+        _SEGMENT *seg=editor->getSegment(i);
+        uint64_t segStart=seg->_startTimeUs;
+        uint64_t segEnd=segStart+seg->_durationUs;
+        uint64_t ls=std::max(segStart,markerA);
+        uint64_t le=std::min(segEnd,exportEnd);
+        if(ls>=le)
+            continue;
+        uint32_t ref=seg->_reference;
+        _VIDEOS *v=editor->getRefVideo(ref);
+        if(!scanned[ref])
+        {
+            sourceKeyFrames(v,keyFrames[ref]);
+            sources[ref]=sourceKey(v);
+            scanned[ref]=true;
+        }
+        std::vector <uint64_t> &kf=keyFrames[ref];
+        // Same range in the source
+        uint64_t ra=ls-segStart+seg->_refStartTimeUs;
+        uint64_t rb=le-segStart+seg->_refStartTimeUs;
+        std::vector <uint64_t> cuts;
+        cuts.push_back(ra);
+        for(uint64_t grid=(ra/ADM_CHUNK_GRID_US+1)*ADM_CHUNK_GRID_US;grid<rb;grid+=ADM_CHUNK_GRID_US)
+        {
+            std::vector <uint64_t>::iterator it=std::lower_bound(kf.begin(),kf.end(),grid);
+            if(it==kf.end() || *it>=rb)
+                break;
+            if(*it>cuts.back())
+                cuts.push_back(*it);
+        }
+        cuts.push_back(rb);
+        const std::string &source=sources[ref];
+        for(int j=0;j+1<cuts.size();j++)
+        {
+            ADM_encodeChunkDesc desc;
+            desc.start=cuts[j]-ra+ls-markerA;
+            desc.end=cuts[j+1]-ra+ls-markerA;
+            snprintf(str,sizeof(str),"|range:%" PRIu64"-%" PRIu64,cuts[j],cuts[j+1]);
+            desc.key=settings+std::string("|source:")+source+std::string(str);
+            chunks.push_back(desc);
+        }
+    }
+    return chunks.size()>0;
+}
+
+/**
+    \fn create
+    \brief Returns NULL if the current settings do not allow chunked encoding or if the first chunk cannot be opened
+*/
+ADM_videoStreamChunked *ADM_videoStreamChunked::create(ADM_Composer *editor,uint64_t markerA,uint64_t markerB,int encoderIndex,bool globalHeader)
+{
+    std::string settings;
+    if(!settingsKey(editor,encoderIndex,globalHeader,settings))
+        return NULL;
+    std::vector <ADM_encodeChunkDesc> chunks;
+    if(!splitInChunks(editor,markerA,markerB,settings,chunks))
+        return NULL;
+    std::vector <std::string> keys;
+    for(int i=0;i<chunks.size();i++)
+        keys.push_back(chunks[i].key);
+    if(!ADM_encodeCachePrune(keys,(uint64_t)ADM_ENCODE_CACHE_MAX_MB<<20))
+        return NULL;
+    ADM_info("Encoding in %d chunks\n",(int)chunks.size());
+    ADM_videoStreamChunked *s=new ADM_videoStreamChunked(markerA,markerB,encoderIndex,globalHeader,chunks);
+    if(s->current<0)
+    {
+        delete s;
+        return NULL;
+    }
+    return s;
+}
+/**
+    \fn ADM_videoStreamChunked
+    \brief Open the first chunk, the muxer needs its parameters. current is set to -1 on failure.
+*/
+ADM_videoStreamChunked::ADM_videoStreamChunked(uint64_t markerA,uint64_t markerB,int encoderIndex,bool globalHeader,
+                                                const std::vector <ADM_encodeChunkDesc> &chunks)
+{
+    this->markerA=markerA;
+    this->markerB=markerB;
+    this->encoderIndex=encoderIndex;
+    this->globalHeader=globalHeader;
+    this->chunks=chunks;
+    chain=NULL;
+    gate=NULL;
+    chainBase=0;
+    chainNext=-1;
+    encoder=NULL;
+    lastDts=ADM_NO_PTS;
+    hits=misses=0;
+    packetIndex=0;
+    currentCached=false;
+    chunkDelay=0;
+    firstPacket=true;
+    stats=NULL;
+    current=0;
+    if(!openChunk(0))
+    {
+        current=-1;
+        return;
+    }
+    if(encoder && encoder->isDualPass())
+    {
+        ADM_info("Two pass encoding, encoding the whole video\n");
+        current=-1;
+        return;
+    }
+    width=reference.width;
+    height=reference.height;
+    ADM_info("[StreamChunked] Stream %" PRIu32"x%" PRIu32", codec : %s\n",width,height,reference.fourCC.c_str());
+    fourCC=fourCC::get((uint8_t *)reference.fourCC.c_str());
+    frameIncrement=reference.frameIncrement;
+    float f=frameIncrement;
+    if(f) f=1000000000./f;
+        else f=25000;
+    averageFps1000=(uint32_t)f;
+    timeBaseDen=reference.timeBaseDen;
+    timeBaseNum=reference.timeBaseNum;
+    isCFR=false;
+    videoDelay=reference.encoderDelay;
+    stats=ADM_stageStatsCreate((std::string("encode ")+reference.fourCC+std::string(" (chunks)")).c_str());
+}
+/**
+    \fn ~ADM_videoStreamChunked
+*/
+ADM_videoStreamChunked::~ADM_videoStreamChunked()
+{
+    if(encoder)
+        delete encoder;
+    encoder=NULL;
+    destroyChain();
+    if(current>=0)
+        ADM_info("[StreamChunked] %" PRIu32" chunks reused, %" PRIu32" encoded\n",hits,misses);
+}
+/**
+    \fn destroyChain
+    \brief The gate is not part of the chain, it must go first
+*/
+void ADM_videoStreamChunked::destroyChain(void)
+{
+    if(gate)
+        delete gate;
+    gate=NULL;
+    if(chain)
+        destroyVideoFilterChain(chain);
+    chain=NULL;
+    chainNext=-1;
+}
+/**
+    \fn matchesReference
+    \brief Can this chunk be spliced after the first one ?
+*/
+bool ADM_videoStreamChunked::matchesReference(ADM_encodedChunk *c)
+{
+    return c->fourCC==reference.fourCC && c->width==reference.width && c->height==reference.height
+            && c->frameIncrement==reference.frameIncrement && c->timeBaseNum==reference.timeBaseNum
+            && c->timeBaseDen==reference.timeBaseDen && c->extraData==reference.extraData;
+}
+/**
+    \fn startEncoder
+    \brief Encode the chunk, reusing the filter chain if it stopped right before it
+*/
+bool ADM_videoStreamChunked::startEncoder(int index)
+{
+    ADM_encodeChunkDesc &desc=chunks[index];
+    if(chainNext!=index)
+    {
+        destroyChain();
+        chain=createVideoFilterChain(markerA+desc.start,markerB,true);
+        if(!chain)
+        {
+            ADM_error("Cannot create the filter chain\n");
+            return false;
+        }
+        gate=new ADM_videoChunkGate((*chain)[chain->size()-1]);
+        chainBase=desc.start;
+    }
+    gate->setRange(desc.start-chainBase,desc.end-chainBase);
+    chainNext=index+1;
+    encoder=createVideoEncoderFromIndex(gate,encoderIndex,globalHeader);
+    if(!encoder)
+    {
+        ADM_error("Cannot create the encoder\n");
+        return false;
+    }
+    if(false==encoder->setup())
+    {
+        ADM_error("Cannot setup the encoder\n");
+        delete encoder;
+        encoder=NULL;
+        return false;
+    }
+    encoder->prefetchLookahead();
+    chunk.fourCC=std::string(encoder->getFourcc());
+    chunk.width=encoder->getWidth();
+    chunk.height=encoder->getHeight();
+    chunk.frameIncrement=encoder->getFrameIncrement();
+    chunk.timeBaseNum=encoder->getTimeBaseNum();
+    chunk.timeBaseDen=encoder->getTimeBaseDen();
+    chunk.encoderDelay=encoder->getEncoderDelay();
+    uint32_t extraLen=0;
+    uint8_t *extra=NULL;
+    encoder->getExtraData(&extraLen,&extra);
+    if(extraLen)
+        chunk.extraData.assign(extra,extra+extraLen);
+    return true;
+}
+/**
+    \fn openChunk
+*/
+bool ADM_videoStreamChunked::openChunk(int index)
+{
+    ADM_encodeChunkDesc &desc=chunks[index];
+    chunk.clear();
+    packetIndex=0;
+    currentCached=ADM_encodeCacheLoad(desc.key,&chunk);
+    if(currentCached && index && !matchesReference(&chunk))
+    {
+        ADM_info("Cached chunk %d does not match the stream, encoding it again\n",index);
+        chunk.clear();
+        currentCached=false;
+    }
+    if(currentCached)
+    {
+        hits++;
+        chunkDelay=chunk.encoderDelay;
+        destroyChain(); // it cannot be used past this chunk, don't let it decode ahead for nothing
+        ADM_info("[StreamChunked] Chunk %d (%s) reused\n",index,ADM_us2plain(markerA+desc.start));
+    }else
+    {
+        misses++;
+        ADM_info("[StreamChunked] Encoding chunk %d (%s)\n",index,ADM_us2plain(markerA+desc.start));
+        if(!startEncoder(index))
+            return false;
+        chunkDelay=chunk.encoderDelay;
+        if(index && !matchesReference(&chunk))
+        {
+            ADM_error("Chunk %d cannot be spliced with the previous ones\n",index);
+            return false;
+        }
+    }
+    chunk.key=desc.key;
+    if(!index)
+    {
+        reference=chunk;
+        reference.packets.clear();
+        reference.payload.clear();
+    }
+    return true;
+}
+/**
+    \fn closeChunk
+    \brief Store a chunk that was completely encoded
+*/
+void ADM_videoStreamChunked::closeChunk(void)
+{
+    if(currentCached)
+        return;
+    chunk.encoderDelay=chunkDelay;
+    if(chunk.nbPackets())
+        ADM_encodeCacheStore(&chunk);
+    chunk.clear();
+    delete encoder;
+    encoder=NULL;
+    if(chainNext>=chunks.size())
+        destroyChain();
+}
+/**
+    \fn getExtraData
+*/
+bool ADM_videoStreamChunked::getExtraData(uint32_t *extraLen, uint8_t **extraData)
+{
+    *extraLen=reference.extraData.size();
+    *extraData=*extraLen? reference.extraData.data() : NULL;
+    return true;
+}
+/**
+    \fn getPacket
+    \brief Timestamps are moved to the position of the chunk, and to the encoder delay of the first one
+*/
+bool ADM_videoStreamChunked::getPacket(ADMBitstream *out)
+{
+    ADM_TRACE_SCOPE("video","encode");
+    ADM_stageTimer timer;
+    bool r=false;
+    out->releaseRef(); // the previous packet is no longer used
+    while(current>=0 && current<chunks.size())
+    {
+        if(currentCached)
+        {
+            r=chunk.getPacket(packetIndex++,out);
+        }else
+        {
+            r=encoder->encode(out);
+            if(r)
+            {
+                if(!chunk.nbPackets())
+                    chunkDelay=encoder->getEncoderDelay(); // final value, known after the first packet
+                chunk.addPacket(out);
+            }
+        }
+        if(r)
+            break;
+        closeChunk();
+        current++;
+        if(current<chunks.size() && !openChunk(current))
+            current=chunks.size();
+    }
+    if(stats)
+        stats->addCall(timer.stop(),r);
+    if(!r)
+        return false;
+    if(!out->ref && out->len>out->bufferSize)
+    {
+        ADM_error("[StreamChunked] Packet too big (%" PRIu32" bytes, buffer is %" PRIu32")\n",out->len,out->bufferSize);
+        return false;
+    }
+    if(firstPacket)
+    {
+        videoDelay=chunkDelay;
+        reference.encoderDelay=chunkDelay;
+        ADM_info("[StreamChunked] Final video encoder delay: %" PRIu64" ms\n",videoDelay/1000);
+        firstPacket=false;
+    }
+    int64_t shift=(int64_t)chunks[current].start+(int64_t)videoDelay-(int64_t)chunkDelay;
+    if(out->pts!=ADM_NO_PTS)
+        out->pts+=shift;
+    if(out->dts!=ADM_NO_PTS)
+    {
+        out->dts+=shift;
+        if(lastDts!=ADM_NO_PTS && out->dts<=lastDts)
+        {
+            aprintf("[StreamChunked] Fixing dts %s\n",ADM_us2plain(out->dts));
+            out->dts=lastDts+1;
+            if(out->pts!=ADM_NO_PTS && out->pts<out->dts)
+                out->pts=out->dts; // never decode after display
+        }
+        lastDts=out->dts;
+    }
+    return true;
+}
+// EOF
@@ -93,6 +93,8 @@ ADM_videoStreamCopy::ADM_videoStreamCopy(uint64_t startTime,uint64_t endTime)
     this->startTimePts=ptsStart;
     this->endTimePts=endTime;
     rewindTime=ptsStart;
+    prefetch=NULL;
+    prefetchDone=false;
     rewind();
     
     ADM_info(" Fixating start time by %d\n",abs((int)(startTime-startTimeDts)));
@@ -103,6 +105,12 @@ ADM_videoStreamCopy::ADM_videoStreamCopy(uint64_t startTime,uint64_t endTime)
 */
 bool      ADM_videoStreamCopy::rewind(void)
 {
+    if(prefetch) // the editor must not be used by two threads
+    {
+        delete prefetch;
+        prefetch=NULL;
+    }
+    prefetchDone=false;
     return video_body->GoToIntraTime_noDecoding(rewindTime);
 }
 /**
@@ -110,7 +118,31 @@ bool      ADM_videoStreamCopy::rewind(void)
 */
 ADM_videoStreamCopy::~ADM_videoStreamCopy()
 {
-
+    if(prefetch)
+        delete prefetch;
+    prefetch=NULL;
+}
+/**
+    \fn prefetchReader
+    \brief Runs on the prefetch thread, read the next compressed picture from the editor
+*/
+bool ADM_videoStreamCopy::prefetchReader(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet)
+{
+    ADM_videoStreamCopy *me=(ADM_videoStreamCopy *)cookie;
+    if(me->prefetchDone) // the previous picture was past the end marker, getPacket stops there
+        return false;
+    ADMCompressedImage img;
+    img.data=buffer;
+    img.cleanup(0);
+    if(false==video_body->getCompressedPicture(me->rewindTime,me->videoDelay,&img))
+        return false;
+    if(img.demuxerPts!=ADM_NO_PTS && img.demuxerPts>me->endTimePts)
+        me->prefetchDone=true;
+    packet->len=img.dataLength;
+    packet->flags=img.flags;
+    packet->pts=img.demuxerPts;
+    packet->dts=img.demuxerDts;
+    return true;
 }
 /**
     \fn getExtraData
@@ -147,11 +179,18 @@ bool  ADM_videoStreamCopy::getPacket(ADMBitstream *out)
     if(true==eofMet) return false;
 again:
     image.data=out->data;
-    if(false==video_body->getCompressedPicture(rewindTime,videoDelay,&image))
+    if(!prefetch)
+        prefetch=new ADM_packetPrefetch("demux (copy)",prefetchReader,this,out->bufferSize);
+    ADM_prefetchPacket packet;
+    if(false==prefetch->getPacket(out->data,out->bufferSize,&packet))
     {
             ADM_warning("Get packet failed\n");
             return false;
     }
+    image.dataLength=packet.len;
+    image.flags=packet.flags;
+    image.demuxerPts=packet.pts;
+    image.demuxerDts=packet.dts;
     out->len=image.dataLength;
     ADM_assert(out->len<=out->bufferSize);
 #if 0
@@ -17,6 +17,7 @@
 #include "ADM_videoProcess.h"
 #include "fourcc.h"
 #include "ADM_bitstream.h"
+#include "ADM_trace.h"
 /**
     \fn ADM_videoStreamProcess
 */
@@ -42,6 +43,8 @@ ADM_videoStreamProcess::ADM_videoStreamProcess(ADM_coreVideoEncoder *encoder)
     videoDelay=encoder->getEncoderDelay();
     ADM_info("[StreamProcess] Initial video encoder delay: %" PRIu64" ms\n",videoDelay/1000);
     firstPacket=true;
+    std::string stage=std::string("encode ")+std::string(fcc);
+    stats=ADM_stageStatsCreate(stage.c_str());
 }
 /**
     \fn ADM_videoStreamProcess
@@ -65,8 +68,19 @@ bool     ADM_videoStreamProcess::getExtraData(uint32_t *extraLen, uint8_t **extr
 */
 bool  ADM_videoStreamProcess::getPacket(ADMBitstream *out)
 {
-    if(false==encoder->encode(out)) return false;
-    ADM_assert(out->len<out->bufferSize);
+    ADM_TRACE_SCOPE("video","encode");
+    ADM_stageTimer timer;
+    out->releaseRef(); // the previous packet is no longer used
+    bool r=encoder->encode(out);
+    if(stats)
+        stats->addCall(timer.stop(),r);
+    if(false==r) return false;
+    // A packet handed over by reference is not bound by our buffer
+    if(!out->ref && out->len>out->bufferSize)
+    {
+        ADM_error("[StreamProcess] Packet too big (%" PRIu32" bytes, buffer is %" PRIu32")\n",out->len,out->bufferSize);
+        return false;
+    }
     if(firstPacket)
     {
         videoDelay=encoder->getEncoderDelay();
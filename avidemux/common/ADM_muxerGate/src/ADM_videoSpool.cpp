@@ -0,0 +1,182 @@
+/**
+    \file ADM_videoSpool
+    \brief Encode a video stream to a scratch file now, mux it later
+
+    Used when several renditions are encoded from the same filtered pictures:
+    only one muxer can drive its encoder at a time, the others encode into a
+    spool and are muxed afterwards, with their audio, from the spool.
+    The file is deleted with the spool.
+
+*/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_fileio.h"
+#include "ADM_videoSpool.h"
+#include "ADM_trace.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+/**
+    \fn ADM_videoStreamSpool
+*/
+ADM_videoStreamSpool::ADM_videoStreamSpool(ADM_videoStream *source,const std::string &fileName)
+{
+    this->source=source;
+    this->fileName=fileName;
+    file=NULL;
+    next=0;
+    recorded=false;
+    width=source->getWidth();
+    height=source->getHeight();
+    fourCC=source->getFCC();
+    averageFps1000=source->getAvgFps1000();
+    timeBaseDen=source->getTimeBaseDen();
+    timeBaseNum=source->getTimeBaseNum();
+    isCFR=source->getIsCfr();
+    videoDelay=source->getVideoDelay();
+    frameIncrement=source->getFrameIncrement();
+    duration=source->getVideoDuration();
+}
+/**
+    \fn ~ADM_videoStreamSpool
+*/
+ADM_videoStreamSpool::~ADM_videoStreamSpool()
+{
+    if(source)
+        delete source;
+    source=NULL;
+    if(file)
+        fclose(file);
+    file=NULL;
+    if(ADM_fileExist(fileName.c_str()))
+        ADM_eraseFile(fileName.c_str());
+}
+/**
+    \fn record
+    \brief Encode the whole source stream, stop early if *abort becomes true
+*/
+bool ADM_videoStreamSpool::record(volatile bool *abort)
+{
+    ADM_assert(source);
+    FILE *f=ADM_fopen(fileName.c_str(),"wb");
+    if(!f)
+    {
+        ADM_error("Cannot create %s\n",fileName.c_str());
+        return false;
+    }
+    uint32_t bufferSize=width*height*3;
+    if(bufferSize<ADM_VIDEO_SPOOL_MIN_BUFFER)
+        bufferSize=ADM_VIDEO_SPOOL_MIN_BUFFER;
+    uint8_t *buffer=new uint8_t[bufferSize];
+    uint64_t offset=0;
+    bool r=true;
+    {
+        ADMFile out;
+        out.open(f);
+        ADMBitstream bitstream;
+        bitstream.data=buffer;
+        bitstream.bufferSize=bufferSize;
+        bitstream.acceptRef=true;
+        while(!*abort && source->getPacket(&bitstream))
+        {
+            ADM_encodedPacketInfo info;
+            info.offset=offset;
+            info.len=bitstream.len;
+            info.flags=bitstream.flags;
+            info.quantizer=bitstream.out_quantizer;
+            info.pts=bitstream.pts;
+            info.dts=bitstream.dts;
+            packets.push_back(info);
+            if(!out.write(bitstream.data,bitstream.len))
+            {
+                ADM_error("Cannot write packet %d to %s\n",(int)packets.size(),fileName.c_str());
+                r=false;
+                break;
+            }
+            offset+=bitstream.len;
+        }
+        bitstream.releaseRef();
+        if(r && !out.flush())
+        {
+            ADM_error("Cannot flush %s\n",fileName.c_str());
+            r=false;
+        }
+        // The delay and the extra data are only final once the encoder ran
+        videoDelay=source->getVideoDelay();
+        uint32_t extraLen;
+        uint8_t *extra;
+        if(source->getExtraData(&extraLen,&extra) && extraLen)
+            extraData.assign(extra,extra+extraLen);
+    }
+    delete source;
+    source=NULL;
+    delete [] buffer;
+    r&=!ferror(f);
+    r&=!fclose(f);
+    if(*abort || !r)
+    {
+        ADM_warning("Spooling to %s did not complete\n",fileName.c_str());
+        return false;
+    }
+    file=ADM_fopen(fileName.c_str(),"rb");
+    if(!file)
+    {
+        ADM_error("Cannot read back %s\n",fileName.c_str());
+        return false;
+    }
+    ADM_info("Spooled %d packets, %" PRIu64" bytes, to %s\n",(int)packets.size(),offset,fileName.c_str());
+    recorded=true;
+    return true;
+}
+/**
+    \fn getPacket
+*/
+bool ADM_videoStreamSpool::getPacket(ADMBitstream *out)
+{
+    ADM_assert(recorded);
+    out->releaseRef();
+    if(next>=packets.size())
+        return false;
+    ADM_encodedPacketInfo &info=packets[next];
+    if(info.len>out->bufferSize)
+    {
+        ADM_error("Spooled packet too big (%" PRIu32" vs %" PRIu32")\n",info.len,out->bufferSize);
+        return false;
+    }
+    if(info.len && fread(out->data,info.len,1,file)!=1)
+    {
+        ADM_error("Cannot read spooled packet %" PRIu32"\n",next);
+        return false;
+    }
+    out->len=info.len;
+    out->flags=info.flags;
+    out->out_quantizer=info.quantizer;
+    out->pts=info.pts;
+    out->dts=info.dts;
+    aprintf("[spool] packet %" PRIu32", %" PRIu32" bytes\n",next,info.len);
+    next++;
+    return true;
+}
+/**
+    \fn getExtraData
+*/
+bool ADM_videoStreamSpool::getExtraData(uint32_t *extraLen, uint8_t **extra)
+{
+    *extraLen=extraData.size();
+    *extra=extraData.size() ? extraData.data() : NULL;
+    return true;
+}
+// EOF
@@ -22,7 +22,8 @@
 #include <vector>
 typedef std::vector <ADM_coreVideoFilter *>ADM_videoFilterChain;
 ADM_videoFilterChain *createEmptyVideoFilterChain(uint64_t startAt,uint64_t endAt);
-ADM_videoFilterChain *createVideoFilterChain(uint64_t startAt,uint64_t endAt);
+ADM_videoFilterChain *createVideoFilterChain(uint64_t startAt,uint64_t endAt,bool decodeAhead=false);
+ADM_videoFilterChain *createVideoFilterBranch(ADM_coreVideoFilter *first,uint32_t width,uint32_t height);
 bool                 destroyVideoFilterChain(ADM_videoFilterChain *chain);
 
 
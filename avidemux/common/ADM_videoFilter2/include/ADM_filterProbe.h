@@ -0,0 +1,44 @@
+/**
+        \file  ADM_filterProbe.h
+        \brief Transparent filter timing the filter just before it (export statistics)
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#ifndef ADM_FILTER_PROBE_H
+#define ADM_FILTER_PROBE_H
+#include "ADM_coreVideoFilter.h"
+#include "ADM_stageStats.h"
+
+/**
+ *  \class ADM_videoFilterProbe
+ *  \brief Everything is forwarded to the previous filter, getNextFrame(As) is timed
+ *          and traced. stats can be NULL, name must outlive the chain
+ */
+class ADM_videoFilterProbe : public ADM_coreVideoFilter
+{
+protected:
+                ADM_stageStats      *stats;
+                const char          *traceName;
+
+public:
+                            ADM_videoFilterProbe(ADM_coreVideoFilter *previous,ADM_stageStats *stats,const char *name);
+       virtual              ~ADM_videoFilterProbe() {}
+
+       virtual const char   *getConfiguration(void) {return previousFilter->getConfiguration();}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek) {return previousFilter->goToTime(usSeek);}
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+       virtual bool         getNextFrameAs(ADM_HW_IMAGE type,uint32_t *frameNumber,ADMImage *image);
+       virtual FilterInfo  *getInfo(void) {return previousFilter->getInfo();}
+       virtual bool         getTimeRange(uint64_t *start, uint64_t *end) {return previousFilter->getTimeRange(start,end);}
+};
+
+#endif
@@ -0,0 +1,87 @@
+/**
+        \file  ADM_filterSplit.h
+        \brief Feed the pictures of one filter to several consumers, each with its own filters
+                and encoder, so that the source is decoded and filtered only once
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#ifndef ADM_FILTER_SPLIT_H
+#define ADM_FILTER_SPLIT_H
+#include <pthread.h>
+#include <vector>
+#include "ADM_coreVideoFilter.h"
+#include "ADM_stageStats.h"
+
+#define ADM_SPLIT_QUEUE_SIZE 8 // pictures the fastest output can be ahead of the slowest one
+
+class ADM_videoFilterSplit;
+
+/**
+ *  \class ADM_videoSplitOutput
+ *  \brief One output of the split, to be used as the first filter of a branch
+ */
+class ADM_videoSplitOutput : public ADM_coreVideoFilter
+{
+protected:
+                ADM_videoFilterSplit    *split;
+                int                     index;
+public:
+                            ADM_videoSplitOutput(ADM_videoFilterSplit *split,ADM_coreVideoFilter *source,int index);
+       virtual              ~ADM_videoSplitOutput();
+
+       virtual const char   *getConfiguration(void) {return "split output";}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek);
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+};
+
+/**
+ *  \class ADM_videoFilterSplit
+ *  \brief A thread reads the source and keeps the last ADM_SPLIT_QUEUE_SIZE pictures until every
+ *          attached output got them. The source must outlive the split, the outputs are owned
+ *          by the caller and detach themselves when deleted.
+ */
+class ADM_videoFilterSplit
+{
+protected:
+        typedef struct
+        {
+            ADMImage        *image;
+            uint32_t        frameNumber;
+        }splitSlot;
+
+        ADM_coreVideoFilter     *source;
+        splitSlot               slots[ADM_SPLIT_QUEUE_SIZE];
+        uint64_t                produced;       // number of pictures read from the source
+        std::vector <uint64_t>  consumed;       // per output
+        std::vector <bool>      attached;       // per output
+        std::vector <ADM_videoSplitOutput *> outputs;
+        bool                    eof;
+        bool                    quit;
+        bool                    started;
+        pthread_t               thread;
+        pthread_mutex_t         lock;
+        pthread_cond_t          wakeProducer;
+        pthread_cond_t          wakeConsumers;
+        ADM_stageStats          *stats;
+
+static  void                    *producerEntry(void *me);
+        void                    producerLoop(void);
+        uint64_t                slowest(void);
+public:
+                                ADM_videoFilterSplit(ADM_coreVideoFilter *source,int nbOutputs);
+                                ~ADM_videoFilterSplit();
+        ADM_videoSplitOutput    *getOutput(int index);
+        bool                    getFrame(int index,uint32_t *frameNumber,ADMImage *image);
+        void                    detach(int index);      /// The output does not want more pictures
+        void                    abort(void);            /// Stop reading, all the outputs are at the end
+};
+#endif
@@ -16,12 +16,17 @@
 #define ADM_FILTER_THREAD_H
 #include "ADM_coreVideoFilter.h"
 #include "ADM_threadQueue.h"
+#include "ADM_stageStats.h"
 
 // From the UX POV, it is nice to have the currently displayed frame still
 // in the editor cache so that a seek back to the current frame succeeds
 // instantly when stopping playback. The fixed size of the queue should not
 // exceed the minimum cache size - 2 for this purpose.
 #define ADM_THREAD_QUEUE_SIZE 6
+// When exporting, the queue before the encoder grows to the lookahead of the codec
+// within these limits
+#define ADM_THREAD_QUEUE_MAX_SIZE 64
+#define ADM_THREAD_QUEUE_MAX_MB   512
 
 /**
  *  \class ADM_videoFilterQueue
@@ -30,9 +35,16 @@
 class ADM_videoFilterQueue : public ADM_coreVideoFilter,public ADM_threadQueue
 {
 protected:
+                admCond             *dataCond; // signaled when a frame is queued or the thread is done
+                bool                eof;
+                ADM_stageStats      *stats; // NULL unless an export is collecting statistics
+                const char          *queueName; // must outlive the trace, i.e. a string literal
+                uint32_t            depth;  // number of allocated pictures
+                ADM_HW_IMAGE        pullType; // what the producer asks upstream, ADM_HW_NONE not to hold the decoder hw surfaces
 
 public:
-                            ADM_videoFilterQueue(ADM_coreVideoFilter *son,CONFcouple *conf=NULL);
+                            ADM_videoFilterQueue(ADM_coreVideoFilter *son,CONFcouple *conf=NULL,const char *name="video queue",
+                                                 ADM_HW_IMAGE pull=ADM_HW_ANY);
        virtual              ~ADM_videoFilterQueue();
 
        virtual const char   *getConfiguration(void) {return "NONE";}
@@ -44,6 +56,7 @@ public:
        virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
        virtual bool         getNextFrameAs( ADM_HW_IMAGE type,uint32_t *frameNumber,ADMImage *image) ;
        virtual FilterInfo  *getInfo(void)    ;
+       virtual bool         setQueueDepth(uint32_t frames);
 
 protected:
         virtual bool                runAction(void);
@@ -0,0 +1,52 @@
+/**
+        \file  ADM_filterProbe.cpp
+        \brief Transparent filter timing the filter just before it (export statistics)
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_filterProbe.h"
+#include "ADM_trace.h"
+
+/**
+    \fn     ADM_videoFilterProbe
+*/
+ADM_videoFilterProbe::ADM_videoFilterProbe(ADM_coreVideoFilter *previous,ADM_stageStats *s,const char *name) :
+                ADM_coreVideoFilter(previous,NULL)
+{
+    myName="probe";
+    stats=s;
+    traceName=name;
+}
+/**
+    \fn     getNextFrame
+*/
+bool ADM_videoFilterProbe::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    ADM_TRACE_SCOPE("filter",traceName);
+    ADM_stageTimer timer;
+    bool r=previousFilter->getNextFrame(frameNumber,image);
+    if(stats)
+        stats->addCall(timer.stop(),r);
+    return r;
+}
+/**
+    \fn     getNextFrameAs
+*/
+bool ADM_videoFilterProbe::getNextFrameAs(ADM_HW_IMAGE type,uint32_t *frameNumber,ADMImage *image)
+{
+    ADM_TRACE_SCOPE("filter",traceName);
+    ADM_stageTimer timer;
+    bool r=previousFilter->getNextFrameAs(type,frameNumber,image);
+    if(stats)
+        stats->addCall(timer.stop(),r);
+    return r;
+}
+//EOF
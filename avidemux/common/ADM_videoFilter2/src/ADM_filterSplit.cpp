@@ -0,0 +1,268 @@
+/**
+        \file  ADM_filterSplit.cpp
+        \brief Feed the pictures of one filter to several consumers
+
+        The pictures are kept in a small ring. A slot is reused once every attached
+        output went past it, so the source runs at the speed of the slowest branch.
+        An output that stops early, e.g. its encoder failed, must be detached so
+        that it does not block the others.
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_filterSplit.h"
+#include "ADM_trace.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+/**
+    \fn ADM_videoSplitOutput
+*/
+ADM_videoSplitOutput::ADM_videoSplitOutput(ADM_videoFilterSplit *split,ADM_coreVideoFilter *source,int index) :
+        ADM_coreVideoFilter(source,NULL)
+{
+    myName="splitOutput";
+    this->split=split;
+    this->index=index;
+}
+/**
+    \fn ~ADM_videoSplitOutput
+*/
+ADM_videoSplitOutput::~ADM_videoSplitOutput()
+{
+    split->detach(index);
+}
+/**
+    \fn goToTime
+    \brief The branches share the source, they cannot seek
+*/
+bool ADM_videoSplitOutput::goToTime(uint64_t usSeek)
+{
+    return false;
+}
+/**
+    \fn getNextFrame
+*/
+bool ADM_videoSplitOutput::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    if(!split->getFrame(index,frameNumber,image))
+        return false;
+    nextFrame++;
+    return true;
+}
+
+/**
+    \fn ADM_videoFilterSplit
+*/
+ADM_videoFilterSplit::ADM_videoFilterSplit(ADM_coreVideoFilter *source,int nbOutputs)
+{
+    ADM_assert(nbOutputs>0);
+    this->source=source;
+    FilterInfo *info=source->getInfo();
+    for(int i=0;i<ADM_SPLIT_QUEUE_SIZE;i++)
+    {
+        slots[i].image=new ADMImageDefault(info->width,info->height,info->bitDepth);
+        slots[i].frameNumber=0;
+    }
+    produced=0;
+    consumed.resize(nbOutputs,0);
+    attached.resize(nbOutputs,true);
+    outputs.resize(nbOutputs,NULL);
+    eof=false;
+    quit=false;
+    started=false;
+    stats=ADM_stageStatsCreate("split queue");
+    if(stats)
+        stats->setQueueSize(ADM_SPLIT_QUEUE_SIZE);
+    pthread_mutex_init(&lock,NULL);
+    pthread_cond_init(&wakeProducer,NULL);
+    pthread_cond_init(&wakeConsumers,NULL);
+}
+/**
+    \fn ~ADM_videoFilterSplit
+*/
+ADM_videoFilterSplit::~ADM_videoFilterSplit()
+{
+    abort();
+    if(started)
+        pthread_join(thread,NULL);
+    started=false;
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&wakeProducer);
+    pthread_cond_destroy(&wakeConsumers);
+    for(int i=0;i<ADM_SPLIT_QUEUE_SIZE;i++)
+    {
+        delete slots[i].image;
+        slots[i].image=NULL;
+    }
+}
+/**
+    \fn getOutput
+    \brief Create the filter for the given output, the caller owns it
+*/
+ADM_videoSplitOutput *ADM_videoFilterSplit::getOutput(int index)
+{
+    ADM_assert(index<outputs.size());
+    ADM_assert(!outputs[index]);
+    outputs[index]=new ADM_videoSplitOutput(this,source,index);
+    return outputs[index];
+}
+/**
+    \fn slowest
+    \brief Number of pictures consumed by the slowest attached output, must be called locked
+*/
+uint64_t ADM_videoFilterSplit::slowest(void)
+{
+    uint64_t low=produced;
+    for(int i=0;i<consumed.size();i++)
+        if(attached[i] && consumed[i]<low)
+            low=consumed[i];
+    return low;
+}
+/**
+    \fn producerEntry
+*/
+void *ADM_videoFilterSplit::producerEntry(void *me)
+{
+    ((ADM_videoFilterSplit *)me)->producerLoop();
+    return NULL;
+}
+/**
+    \fn producerLoop
+*/
+void ADM_videoFilterSplit::producerLoop(void)
+{
+    ADM_traceSetThreadName("split producer");
+    pthread_mutex_lock(&lock);
+    while(!quit)
+    {
+        bool wanted=false;
+        for(int i=0;i<attached.size();i++)
+            wanted|=attached[i];
+        if(!wanted)
+        {
+            aprintf("[split] all the outputs are detached\n");
+            break;
+        }
+        if(produced-slowest()>=ADM_SPLIT_QUEUE_SIZE)
+        {
+            if(stats)
+                stats->addBlocked();
+            ADM_TRACE_INSTANT("split queue","full");
+            pthread_cond_wait(&wakeProducer,&lock);
+            continue;
+        }
+        // Nobody reads this slot anymore, fill it unlocked
+        splitSlot *slot=slots+(produced%ADM_SPLIT_QUEUE_SIZE);
+        pthread_mutex_unlock(&lock);
+        bool got;
+        {
+            ADM_TRACE_SCOPE("split","read");
+            got=source->getNextFrame(&(slot->frameNumber),slot->image);
+        }
+        pthread_mutex_lock(&lock);
+        if(!got)
+        {
+            aprintf("[split] end of stream after %" PRIu64" pictures\n",produced);
+            break;
+        }
+        produced++;
+        ADM_TRACE_COUNTER("split queue",produced-slowest());
+        pthread_cond_broadcast(&wakeConsumers);
+    }
+    eof=true;
+    pthread_cond_broadcast(&wakeConsumers);
+    pthread_mutex_unlock(&lock);
+}
+/**
+    \fn getFrame
+    \brief Copy the next picture of the output in image
+    \return false at the end of the stream
+*/
+bool ADM_videoFilterSplit::getFrame(int index,uint32_t *frameNumber,ADMImage *image)
+{
+    ADM_TRACE_SCOPE("queue wait","split queue");
+    ADM_stageTimer timer;
+    bool waited=false;
+    pthread_mutex_lock(&lock);
+    ADM_assert(index<consumed.size());
+    if(!started && !quit)
+    {
+        started=!pthread_create(&thread,NULL,producerEntry,this);
+        if(!started)
+        {
+            ADM_error("Cannot create the split thread\n");
+            eof=true;
+        }
+    }
+    while(consumed[index]>=produced && !eof && attached[index])
+    {
+        waited=true;
+        pthread_cond_wait(&wakeConsumers,&lock);
+    }
+    if(consumed[index]>=produced || !attached[index])
+    {
+        pthread_mutex_unlock(&lock);
+        if(stats)
+            stats->addCall(timer.stop(),false);
+        return false;
+    }
+    if(stats)
+    {
+        stats->sampleQueue(produced-consumed[index]);
+        if(waited)
+            stats->addStarved();
+    }
+    // The producer does not touch the slot until we are done with it
+    splitSlot *slot=slots+(consumed[index]%ADM_SPLIT_QUEUE_SIZE);
+    pthread_mutex_unlock(&lock);
+
+    image->duplicateFull(slot->image);
+    *frameNumber=slot->frameNumber;
+
+    pthread_mutex_lock(&lock);
+    consumed[index]++;
+    pthread_cond_signal(&wakeProducer);
+    pthread_mutex_unlock(&lock);
+    if(stats)
+        stats->addCall(timer.stop(),true);
+    return true;
+}
+/**
+    \fn detach
+*/
+void ADM_videoFilterSplit::detach(int index)
+{
+    pthread_mutex_lock(&lock);
+    ADM_assert(index<attached.size());
+    attached[index]=false;
+    outputs[index]=NULL;
+    pthread_cond_signal(&wakeProducer);
+    pthread_cond_broadcast(&wakeConsumers);
+    pthread_mutex_unlock(&lock);
+}
+/**
+    \fn abort
+*/
+void ADM_videoFilterSplit::abort(void)
+{
+    pthread_mutex_lock(&lock);
+    quit=true;
+    for(int i=0;i<attached.size();i++)
+        attached[i]=false;
+    pthread_cond_signal(&wakeProducer);
+    pthread_cond_broadcast(&wakeConsumers);
+    pthread_mutex_unlock(&lock);
+}
+// EOF
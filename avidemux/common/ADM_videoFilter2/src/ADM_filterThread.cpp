@@ -16,22 +16,75 @@
 #include "ADM_videoFilterApi.h"
 #include "ADM_videoFilters.h"
 #include "ADM_filterThread.h"
+#include "ADM_trace.h"
 /**
     \fn     ADM_videoFilterQueue
-    \brief
+    \brief  The hw decoders only have surfaces for one queue of ADM_THREAD_QUEUE_SIZE pictures,
+            the other queues must pull with ADM_HW_NONE.
 */
-ADM_videoFilterQueue::ADM_videoFilterQueue(ADM_coreVideoFilter *previous,CONFcouple *conf ):
+ADM_videoFilterQueue::ADM_videoFilterQueue(ADM_coreVideoFilter *previous,CONFcouple *conf,const char *name,ADM_HW_IMAGE pull):
                 ADM_coreVideoFilter(previous,conf)
 {
     // 
     myName="threadQueue";
+    dataCond=new admCond(mutex);
+    eof=false;
+    queueName=name;
+    pullType=pull;
+    depth=ADM_THREAD_QUEUE_SIZE;
+    stats=ADM_stageStatsCreate(name);
+    if(stats)
+        stats->setQueueSize(depth);
     // Allocate buffer
-    for(int i=0;i<ADM_THREAD_QUEUE_SIZE;i++)
+    for(int i=0;i<depth;i++)
+    {
+        ADM_queuePacket item;
+        item.data=(uint8_t *)new ADMImageDefault(info.width,info.height,info.bitDepth);
+        freeList.append(item);
+    }
+}
+/**
+    \fn     setQueueDepth
+    \brief  Grow the queue so that up to frames pictures are ready ahead of the consumer.
+            The queue never shrinks, it can be called while the thread is running.
+            The hw decoders cannot lend that many surfaces, a grown queue stores downloaded pictures.
+*/
+bool ADM_videoFilterQueue::setQueueDepth(uint32_t frames)
+{
+    uint64_t pictureSize=(uint64_t)info.width*info.height*3/2;
+    if(info.bitDepth>8)
+        pictureSize*=2;
+    uint32_t maxDepth=ADM_THREAD_QUEUE_MAX_SIZE;
+    if(pictureSize)
+    {
+        uint64_t fit=((uint64_t)ADM_THREAD_QUEUE_MAX_MB<<20)/pictureSize;
+        if(fit<maxDepth)
+            maxDepth=(uint32_t)fit;
+    }
+    if(frames>maxDepth)
+        frames=maxDepth;
+    if(frames<=depth)
+        return false;
+    ADM_info("Growing %s from %" PRIu32" to %" PRIu32" pictures\n",queueName,depth,frames);
+    mutex->lock();
+    for(uint32_t i=depth;i<frames;i++)
     {
         ADM_queuePacket item;
-        item.data=(uint8_t *)new ADMImageDefault(info.width,info.height);
+        item.data=(uint8_t *)new ADMImageDefault(info.width,info.height,info.bitDepth);
         freeList.append(item);
     }
+    depth=frames;
+    if(pullType!=ADM_HW_NONE)
+    {
+        ADM_info("%s now pulls plain pictures, not hw surfaces\n",queueName);
+        pullType=ADM_HW_NONE;
+    }
+    if(stats)
+        stats->setQueueSize(depth);
+    if(cond->iswaiting())
+        cond->wakeup();
+    mutex->unlock();
+    return true;
 }
 /**
     \fn ~ADM_videoFilterQueue
@@ -40,6 +93,8 @@ ADM_videoFilterQueue::ADM_videoFilterQueue(ADM_coreVideoFilter *previous,CONFcou
 ADM_videoFilterQueue::~ADM_videoFilterQueue()
 {
         stopThread();
+        delete dataCond;
+        dataCond=NULL;
         int fCount;
         fCount=freeList.size();
         for(int j=0;j<fCount;j++)
@@ -59,12 +114,27 @@ ADM_videoFilterQueue::~ADM_videoFilterQueue()
 }
 /**
     \fn     goToTime
-    \brief
+    \brief  Stop the producer, recycle whatever was queued and seek upstream.
+            The thread is restarted by the next getNextFrame.
 */
 bool         ADM_videoFilterQueue::goToTime(uint64_t usSeek)
 {
-        ADM_assert(0);
-        return false;
+        if(started)
+        {
+            stopThread();
+            pthread_join(myThread,NULL); // the producer may still be inside previousFilter
+            started=false;
+        }
+        mutex->lock();
+        int count=list.size();
+        for(int j=0;j<count;j++)
+            freeList.append(list[j]);
+        list.clear();
+        eof=false;
+        threadState=RunStateIdle;
+        ADM_TRACE_COUNTER(queueName,0);
+        mutex->unlock();
+        return previousFilter->goToTime(usSeek);
 }
 /**
     \fn     getNextFrame
@@ -81,11 +151,21 @@ bool         ADM_videoFilterQueue::getNextFrameAs( ADM_HW_IMAGE type,uint32_t *f
         {
             startThread();      
         }
+        ADM_stageTimer timer;
+        ADM_TRACE_SCOPE("queue wait",queueName);
+        bool waited=false;
         while(1)
         {
             mutex->lock();
             if(list.size())
             {
+                if(stats)
+                {
+                    stats->sampleQueue(list.size());
+                    if(waited)
+                        stats->addStarved();
+                }
+                ADM_TRACE_COUNTER(queueName,list.size()-1);
                 //
                 // Dequeue one item
                 ADM_queuePacket pkt=(list[0]);
@@ -102,17 +182,23 @@ bool         ADM_videoFilterQueue::getNextFrameAs( ADM_HW_IMAGE type,uint32_t *f
                     cond->wakeup();
                 }
                 mutex->unlock();
+                if(stats)
+                    stats->addCall(timer.stop(),true);
                 return true;
             }
             // If no item, thread still alive ?
-            if(threadState==RunStateStopped)
+            if(eof || threadState==RunStateStopped)
             {
                 ADM_info("Video thread stopped, no more data\n");
                 mutex->unlock();
+                if(stats)
+                    stats->addCall(timer.stop(),false);
                 return false;
             }
-            mutex->unlock();
-            ADM_usleep(10*1000); // wait 10 ms
+            if(!waited)
+                ADM_TRACE_INSTANT(queueName,"empty");
+            waited=true;
+            dataCond->wait(); // Will unlock mutex
         }
         return false;
 }
@@ -130,6 +216,7 @@ FilterInfo   *ADM_videoFilterQueue::getInfo(void)
 */
 bool         ADM_videoFilterQueue::runAction(void)
 {
+    ADM_traceSetThreadName((std::string(queueName)+" producer").c_str());
     while(1)
     {
         if(threadState==RunStateStopOrder)  
@@ -140,6 +227,9 @@ bool         ADM_videoFilterQueue::runAction(void)
         mutex->lock();
         if(!freeList.size())
         {
+            if(stats)
+                stats->addBlocked();
+            ADM_TRACE_INSTANT(queueName,"full");
             cond->wait(); // Will unlock mutex
             continue;
         }
@@ -154,9 +244,10 @@ bool         ADM_videoFilterQueue::runAction(void)
         ADM_assert(pkt.data);
         ADMImage *source=(ADMImage *)pkt.data;
         freeList.popFront();
+        ADM_HW_IMAGE pull=pullType;
         mutex->unlock();
 
-        if(false==previousFilter->getNextFrameAs(ADM_HW_ANY,&fn,source))
+        if(false==previousFilter->getNextFrameAs(pull,&fn,source))
         {
            
             ADM_info("Video Thread, no more data\n");
@@ -169,10 +260,18 @@ bool         ADM_videoFilterQueue::runAction(void)
         mutex->lock();
         pkt.pts=fn;
         list.append(pkt);
+        ADM_TRACE_COUNTER(queueName,list.size());
+        if(dataCond->iswaiting())
+            dataCond->wakeup();
         mutex->unlock();
 
     }
 theEnd:
+        mutex->lock();
+        eof=true;
+        if(dataCond->iswaiting())
+            dataCond->wakeup();
+        mutex->unlock();
         ADM_info("Exiting video thread loop\n");
         return true;
 }
@@ -43,12 +43,13 @@ extern ADM_vf_plugin *getFakePartialPlugin();
 
 ADM_vf_plugin::ADM_vf_plugin(const char *file) : ADM_LibWrapper()
 {
-	initialised = (loadLibrary(file) && getSymbols(11,
+	initialised = (loadLibrary(file) && getSymbols(12,
 		&create, "create",
 		&destroy, "destroy",
 		&getApiVersion, "getApiVersion",
 		&supportedUI, "supportedUI",
         &neededFeatures,"neededFeatures",
+        &capabilities,"capabilities",
 		&getFilterVersion, "getFilterVersion",
 		&getDesc, "getDesc",
 		&getInternalName, "getInternalName",
@@ -372,5 +373,4 @@ bool ADM_vf_canBePartialized(uint32_t tag)
   return plugin->partializable();
 
 }
-
 //EOF
@@ -461,6 +461,7 @@ namespace admPartial
       return ADM_UI_ALL;
     }
     int               neededFeatures(void) {return 0;}
+    int               capabilities(void) {return 0;}
     uint32_t          apiVersion()
     {
       return VF_API_VERSION;
@@ -493,6 +494,7 @@ public:
         destroy=admPartial::destroy;
         supportedUI=admPartial::supportedUI;
         neededFeatures=admPartial::neededFeatures;
+        capabilities=admPartial::capabilities;
         getApiVersion=admPartial::apiVersion;
         getFilterVersion=admPartial::getPluginVersion;
         getDesc=admPartial::getString;
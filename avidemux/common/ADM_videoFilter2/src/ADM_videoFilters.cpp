@@ -20,6 +20,9 @@
 #include "ADM_videoFilterBridge.h"
 #include "ADM_filterChain.h"
 #include "ADM_filterThread.h"
+#include "ADM_filterProbe.h"
+#include "ADM_filterDepth.h"
+#include "ADM_trace.h"
 #include "ADM_coreVideoFilterFunc.h"
 
 extern ADM_coreVideoFilter *bridge;
@@ -140,35 +143,68 @@ bool ADM_vf_partialize(int index)
     return ADM_vf_recreateChain();
 }
 
+/**
+    \fn addProbe
+    \brief When export statistics are collected or tracing is on, time the last filter of the chain
+*/
+static ADM_coreVideoFilter *addProbe(ADM_videoFilterChain *chain,ADM_coreVideoFilter *f,const char *name)
+{
+    ADM_stageStats *stats=ADM_stageStatsCreate(name);
+    if(!stats && !admTraceEnabled.load())
+        return f;
+    ADM_videoFilterProbe *probe=new ADM_videoFilterProbe(f,stats,name);
+    chain->push_back(probe);
+    return probe;
+}
 /**
     \fn createVideoFilterChain
     \brief Create a filter chain
+    \param decodeAhead if true, demuxing/decoding runs on its own thread, ahead of the filters (export)
 */
-ADM_videoFilterChain *createVideoFilterChain(uint64_t startAt,uint64_t endAt)
+ADM_videoFilterChain *createVideoFilterChain(uint64_t startAt,uint64_t endAt,bool decodeAhead)
 {
     ADM_videoFilterChain *chain=new ADM_videoFilterChain;
     // 1- Add bridge always # 1
     ADM_videoFilterBridge *bridge=new ADM_videoFilterBridge(video_body, startAt,endAt);
     chain->push_back(bridge);
-    ADM_coreVideoFilter *f=bridge;
+    ADM_coreVideoFilter *f=addProbe(chain,bridge,"demux+decode");
     // Now create a clone of the videoFilterChain we have here
     int nb=ADM_VideoFilters.size();
     bool openGl=false;
     for(int i=0;i<nb;i++)
+    {
+        if(ADM_vf_getFilterCategoryFromTag(ADM_VideoFilters[i].tag)==VF_OPENGL)
+            openGl=true;
+    }
+    // Decode in a separate thread, the filters will then run in parallel with the decoder.
+    // Not needed if there is no filter, the queue at the end already does that.
+    // Only the first filter may get hw images, the decoder has no spare surfaces for this queue else.
+    if(decodeAhead && nb && !openGl)
+    {
+        ADM_HW_IMAGE pull=ADM_vf_acceptsHwImages(ADM_VideoFilters[0].tag)? ADM_HW_ANY : ADM_HW_NONE;
+        ADM_videoFilterQueue *ahead=new ADM_videoFilterQueue(f,NULL,"decode queue",pull);
+        chain->push_back(ahead);
+        f=ahead;
+        ADM_info("Decode-ahead thread enabled\n");
+    }
+    for(int i=0;i<nb;i++)
     {
             // Get configuration
             CONFcouple *c;
             ADM_coreVideoFilter *old=ADM_VideoFilters[i].instance;
             uint32_t tag=ADM_VideoFilters[i].tag;
             old->getCoupledConf(&c);
+            // Only convert the high bit depth images for the filters that cannot deal with them
+            if(f->getInfo()->bitDepth>8 && !ADM_vf_acceptsHighBitDepth(tag))
+            {
+                ADM_videoFilterDepth *depth=new ADM_videoFilterDepth(f,8);
+                chain->push_back(depth);
+                f=addProbe(chain,depth,"bit depth");
+            }
             ADM_coreVideoFilter *nw=ADM_vf_createFromTag(tag,f,c);
             if(c) delete c;
-            f=nw;
             chain->push_back(nw);
-
-            VF_CATEGORY type=ADM_vf_getFilterCategoryFromTag(tag);
-            if(type== VF_OPENGL) openGl=true;
-
+            f=addProbe(chain,nw,ADM_vf_getInternalNameFromTag(tag));
     }
     // Last create the thread
 #if 1
@@ -187,6 +223,44 @@ ADM_videoFilterChain *createVideoFilterChain(uint64_t startAt,uint64_t endAt)
 #endif
     return chain;
 }
+/**
+    \fn createVideoFilterBranch
+    \brief Chain starting at first, e.g. an output of a split, resized to width x height unless they
+            are 0. It ends with a queue so that each branch runs on its own thread.
+            first belongs to the branch and is destroyed with it.
+*/
+ADM_videoFilterChain *createVideoFilterBranch(ADM_coreVideoFilter *first,uint32_t width,uint32_t height)
+{
+    ADM_videoFilterChain *chain=new ADM_videoFilterChain;
+    chain->push_back(first);
+    ADM_coreVideoFilter *f=first;
+    FilterInfo *info=f->getInfo();
+    if(width && height && (width!=info->width || height!=info->height))
+    {
+        uint32_t tag=ADM_vf_getTagFromInternalName("swscale");
+        if(info->bitDepth>8 && !ADM_vf_acceptsHighBitDepth(tag))
+        {
+            ADM_videoFilterDepth *depth=new ADM_videoFilterDepth(f,8);
+            chain->push_back(depth);
+            f=addProbe(chain,depth,"bit depth");
+        }
+        CONFcouple c(7);
+        c.writeAsUint32("width",width);
+        c.writeAsUint32("height",height);
+        c.writeAsUint32("algo",1); // bicubic
+        c.writeAsUint32("sourceAR",0);
+        c.writeAsUint32("targetAR",0);
+        c.writeAsBool("lockAR",false);
+        c.writeAsBool("roundup",false);
+        ADM_coreVideoFilter *resize=ADM_vf_createFromTag(tag,f,&c);
+        chain->push_back(resize);
+        f=addProbe(chain,resize,"resize");
+        ADM_info("Branch resized to %" PRIu32"x%" PRIu32"\n",width,height);
+    }
+    ADM_videoFilterQueue *thread=new ADM_videoFilterQueue(f,NULL,"branch queue");
+    chain->push_back(thread);
+    return chain;
+}
 /**
     \fn createEmptyVideoFilterChain
     \brief Create an empty filter chain
@@ -49,6 +49,9 @@ int  A_audioSave(const char *name);
 int  A_SaveWrapper(const char *name);
 int  A_saveAudioProcessed (const char *name);
 int  A_Save(const char *name);
+int  A_AddRendition(const char *name,uint32_t width,uint32_t height);
+void A_ClearRenditions(void);
+int  A_SaveRenditions(void);
 
 void A_queueJob(const char *jobName,const char *outputFile);
 
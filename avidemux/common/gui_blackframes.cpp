@@ -106,27 +106,36 @@ void GUI_PrevBlackFrame(void)
 }
 
 /**
-    \fn GUI_NextBlackFrame
-    \brief lookup for a black frame
+    \struct blackSearchProgress
 */
-void GUI_NextBlackFrame(void)
+typedef struct
+{
+    DIA_processingBase *work;
+    bool                aborted;
+}blackSearchProgress;
+
+/**
+    \fn blackFrameProgress
+    \brief Called by the analysis between two batches of GOPs
+*/
+static bool blackFrameProgress(void *cookie,uint64_t doneUs,uint64_t totalUs)
+{
+    blackSearchProgress *p=(blackSearchProgress *)cookie;
+    UI_purge();
+    if(p->work->update(1,doneUs))
+        p->aborted=true;
+    return p->aborted;
+}
+
+/**
+    \fn nextBlackFrameSlow
+    \brief Fallback when the video cannot be analyzed in the background, go through the preview
+*/
+static void nextBlackFrameSlow(int darkness,uint64_t duration,uint64_t startTime)
 {
-    if (playing)
-		return;
-    if (! avifileinfo)
-       return;
-    const int darkness=40;
-    admPreview::deferDisplay(true);
     ADMImage *rdr;
-    
-//#warning set real fps
-    
-    // guess ~ number of frames
-    uint64_t duration=video_body->getVideoDuration();    
-    uint64_t startTime=admPreview::getCurrentPts();
     DIA_processingBase *work=createProcessing(QT_TRANSLATE_NOOP("blackframes", "Searching black frame.."),duration-startTime);
 
-    uint32_t count=0;
     while(1)
     {
         UI_purge();
@@ -151,6 +160,46 @@ void GUI_NextBlackFrame(void)
               break;
     }
     delete work;
+}
+
+/**
+    \fn GUI_NextBlackFrame
+    \brief lookup for a black frame
+            The frames are decoded in parallel away from the preview, we only seek once found
+*/
+void GUI_NextBlackFrame(void)
+{
+    if (playing)
+		return;
+    if (! avifileinfo)
+       return;
+    const int darkness=ADM_ANALYSIS_DEFAULT_DARKNESS;
+    admPreview::deferDisplay(true);
+
+    uint64_t duration=video_body->getVideoDuration();
+    uint64_t startTime=admPreview::getCurrentPts();
+
+    ADM_analysisParams params;
+    params.what=ADM_ANALYSIS_BLACK;
+    params.darkness=darkness;
+    params.sceneThreshold=ADM_ANALYSIS_DEFAULT_SCENE;
+    params.stopAtFirst=true;
+
+    ADM_analysisResult found;
+    blackSearchProgress progress;
+    progress.work=createProcessing(QT_TRANSLATE_NOOP("blackframes", "Searching black frame.."),duration-startTime);
+    progress.aborted=false;
+    bool r=video_body->analyzeVideo(startTime+1,duration,params,found,blackFrameProgress,&progress);
+    delete progress.work;
+
+    if(found.size())
+    {
+        admPreview::seekToTime(found[0].pts);
+    }else if(!r && !progress.aborted)
+    {
+        ADM_warning("Cannot analyze the video, searching through the preview\n");
+        nextBlackFrameSlow(darkness,duration,startTime);
+    }
     admPreview::deferDisplay(false);
     admPreview::samePicture();
     GUI_setCurrentFrameAndTime();
@@ -48,6 +48,7 @@
 
 #include "ADM_edAudioTrackExternal.h"
 #include "ADM_threads.h"
+#include "ADM_threadPool.h"
 #include "ADM_muxerProto.h"
 admMutex singleThread;
 
@@ -1133,7 +1134,7 @@ void cleanUp (void)
 
     currentaudiostream=NULL;
 //    filterCleanUp();
-
+    ADM_threadPool::destroyInstance();
 }
 
 //#warning fixme
@@ -1708,6 +1709,7 @@ uint8_t GUI_close(void)
       avifileinfo = NULL;
       video_body->clearUndoQueue();
       video_body->cleanup ();
+      audioFilterClearScanCache();
       UI_setAudioTrackCount(0);
       UI_setTimeShift(false,0);
 //      filterCleanUp ();
@@ -32,11 +32,19 @@
 #include "ADM_muxerGate/include/ADM_videoCopy.h"
 #include "ADM_filterChain.h"
 #include "ADM_muxerGate/include/ADM_videoProcess.h"
+#include "ADM_muxerGate/include/ADM_videoChunked.h"
+#include "ADM_muxerGate/include/ADM_passCache.h"
+#include "ADM_muxerGate/include/ADM_videoSpool.h"
+#include "ADM_filterThread.h"
+#include "ADM_filterSplit.h"
 #include "ADM_bitstream.h"
 #include "ADM_filterChain.h"
 #include "ADM_videoEncoderApi.h"
 #include "ADM_vidMisc.h"
 #include "ADM_slave.h"
+#include "ADM_stageStats.h"
+#include "ADM_trace.h"
+#include "prefs.h"
 
 #define ADM_MAX_AUDIO_STREAM 10
 /*
@@ -60,10 +68,13 @@ protected:
         uint64_t             startAudioTime; // Actual start time (for both audio & video) can differ from markerA
         std::string          fileName;
         std::string          logFileName;
+        std::string          passCacheName;  // first pass pictures, deleted at the end
         ADM_muxer            *muxer;
         ADM_videoFilterChain *chain;
         ADM_audioStream      *audio;
         ADM_videoStream      *video;
+        ADM_videoStream      *presetVideo;   // prepared by setupRendition or given by setVideo
+        bool                 statsStarted;   // the caller already started collecting the stage stats
         uint64_t             markerA,markerB;
         int                  muxerIndex;
         int                  videoEncoderIndex;
@@ -81,6 +92,10 @@ public:
                               admSaver(const char *out);
                               ~admSaver();
         bool                  save(void);
+        bool                  setupRendition(ADM_coreVideoFilter *tail,int muxer,int encoder);
+        ADM_videoStream      *takeVideo(void);
+        void                  setVideo(ADM_videoStream *stream);
+        void                  keepStats(void) {statsStarted=true;}
 
 };
 
@@ -102,6 +117,257 @@ int A_Save(const char *name)
     return (int)r;
 }
 
+/**
+    \struct admRendition
+    \brief One output of A_SaveRenditions, the muxer and encoder are the ones selected when it was added
+*/
+typedef struct
+{
+    std::string     fileName;
+    uint32_t        width,height;   // 0 means the size of the filtered video
+    int             muxerIndex;
+    int             encoderIndex;
+    CONFcouple      *encoderConf;
+}admRendition;
+
+static std::vector <admRendition> renditions;
+
+/**
+    \struct admSpoolJob
+    \brief A rendition encoded on its own thread while the first one is saved
+*/
+typedef struct
+{
+    ADM_videoStreamSpool    *spool;
+    ADM_videoFilterSplit    *split;
+    int                     index;
+    volatile bool           *abort;
+    pthread_t               thread;
+    bool                    started;
+    bool                    result;
+}admSpoolJob;
+
+/**
+    \fn spoolWorker
+*/
+static void *spoolWorker(void *arg)
+{
+    admSpoolJob *job=(admSpoolJob *)arg;
+    ADM_traceSetThreadName("rendition");
+    job->result=job->spool->record(job->abort);
+    // Done, do not hold the other renditions back
+    job->split->detach(job->index);
+    return NULL;
+}
+
+/**
+    \fn A_AddRendition
+    \brief Add an output to the next A_SaveRenditions, using the current muxer, encoder and encoder settings
+*/
+int A_AddRendition(const char *name,uint32_t width,uint32_t height)
+{
+    int encoderIndex=UI_getCurrentVCodec();
+    if(!encoderIndex)
+    {
+        ADM_error("Renditions are encoded, the video cannot be in copy mode\n");
+        return 0;
+    }
+    char *fullpath=ADM_PathCanonize(name);
+    std::string fileName(fullpath);
+    delete [] fullpath;
+    fullpath=NULL;
+    for(int i=0;i<renditions.size();i++)
+    {
+        if(renditions[i].fileName==fileName)
+        {
+            ADM_error("%s is already a rendition\n",fileName.c_str());
+            return 0;
+        }
+    }
+    admRendition rendition;
+    rendition.fileName=fileName;
+    rendition.width=width&~1;
+    rendition.height=height&~1;
+    rendition.muxerIndex=UI_GetCurrentFormat();
+    rendition.encoderIndex=encoderIndex;
+    rendition.encoderConf=NULL;
+    videoEncoder6_SetCurrentEncoder(encoderIndex);
+    videoEncoder6_GetConfiguration(&rendition.encoderConf);
+    renditions.push_back(rendition);
+    ADM_info("Rendition %d: %s, %" PRIu32"x%" PRIu32", encoder %d\n",(int)renditions.size(),
+                fileName.c_str(),rendition.width,rendition.height,encoderIndex);
+    return 1;
+}
+/**
+    \fn A_ClearRenditions
+*/
+void A_ClearRenditions(void)
+{
+    for(int i=0;i<renditions.size();i++)
+    {
+        if(renditions[i].encoderConf)
+            delete renditions[i].encoderConf;
+        renditions[i].encoderConf=NULL;
+    }
+    renditions.clear();
+}
+/**
+    \fn A_SaveRenditions
+    \brief Decode and filter once, encode every rendition from the same pictures.
+            The first rendition is saved as usual, the others are encoded in parallel
+            to a spool file and muxed with their audio once the pictures are done.
+*/
+int A_SaveRenditions(void)
+{
+    int nb=renditions.size();
+    if(!nb)
+    {
+        ADM_warning("No rendition to save\n");
+        ADM_slaveSendResult(false);
+        return 0;
+    }
+    uint64_t current=video_body->getCurrentFramePts();
+    uint64_t markerA=video_body->getMarkerAPts();
+    uint64_t markerB=video_body->getMarkerBPts();
+    // The encoder settings are global, put back the ones of the UI at the end
+    int uiEncoder=UI_getCurrentVCodec();
+    CONFcouple *uiConf=NULL;
+    videoEncoder6_SetCurrentEncoder(uiEncoder);
+    videoEncoder6_GetConfiguration(&uiConf);
+
+    ADM_stageStatsStart();
+    bool ok=true;
+    ADM_videoFilterSplit *split=NULL;
+    std::vector <ADM_videoFilterChain *> branches;
+    std::vector <admSaver *> savers;
+    ADM_videoFilterChain *chain=createVideoFilterChain(markerA,markerB,true);
+    if(!chain)
+    {
+        GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Video"),QT_TRANSLATE_NOOP("adm","Cannot instantiate video chain"));
+        ok=false;
+    }else
+    {
+        ADM_coreVideoFilter *last=(*chain)[chain->size()-1];
+        split=new ADM_videoFilterSplit(last,nb);
+        for(int i=0;i<nb && ok;i++)
+        {
+            admRendition &rendition=renditions[i];
+            ADM_videoFilterChain *branch=createVideoFilterBranch(split->getOutput(i),rendition.width,rendition.height);
+            branches.push_back(branch);
+            ADM_coreVideoFilter *tail=(*branch)[branch->size()-1];
+            videoEncoder6_SetCurrentEncoder(rendition.encoderIndex);
+            videoEncoder6_SetConfiguration(rendition.encoderConf);
+            admSaver *saver=new admSaver(rendition.fileName.c_str());
+            savers.push_back(saver);
+            ok=saver->setupRendition(tail,rendition.muxerIndex,rendition.encoderIndex);
+        }
+    }
+    videoEncoder6_SetCurrentEncoder(uiEncoder);
+    if(uiConf)
+    {
+        videoEncoder6_SetConfiguration(uiConf);
+        delete uiConf;
+        uiConf=NULL;
+    }
+
+    bool r=false;
+    volatile bool abort=false;
+    std::vector <admSpoolJob> jobs(nb);
+    if(ok)
+    {
+        for(int i=1;i<nb;i++)
+        {
+            admSpoolJob &job=jobs[i];
+            std::string spoolName=renditions[i].fileName+std::string(".video");
+            job.spool=new ADM_videoStreamSpool(savers[i]->takeVideo(),spoolName);
+            job.split=split;
+            job.index=i;
+            job.abort=&abort;
+            job.result=false;
+            job.started=!pthread_create(&job.thread,NULL,spoolWorker,&job);
+            if(!job.started)
+            {
+                ADM_error("Cannot create the thread of rendition %d\n",i);
+                split->detach(i);
+            }
+        }
+        savers[0]->keepStats();
+        r=savers[0]->save();
+        if(!r)
+        {
+            abort=true;
+            split->abort();
+        }else
+        {
+            split->detach(0);
+        }
+        for(int i=1;i<nb;i++)
+        {
+            if(jobs[i].started)
+                pthread_join(jobs[i].thread,NULL);
+            if(!jobs[i].result)
+            {
+                delete jobs[i].spool;   // still holds the encoder if the thread did not run
+                jobs[i].spool=NULL;
+            }
+        }
+        delete savers[0];
+        savers[0]=NULL;
+    }else
+    {
+        ADM_stageStatsStop();
+        for(int i=0;i<savers.size();i++)
+        {
+            delete savers[i];
+            savers[i]=NULL;
+        }
+    }
+    // Nothing uses the pictures anymore
+    for(int i=0;i<branches.size();i++)
+        destroyVideoFilterChain(branches[i]);
+    branches.clear();
+    if(split)
+        delete split;
+    split=NULL;
+    if(chain)
+        destroyVideoFilterChain(chain);
+    chain=NULL;
+
+    // Mux the other renditions with their audio
+    if(ok)
+    {
+        bool first=r;
+        for(int i=1;i<nb;i++)
+        {
+            admSaver *saver=savers[i];
+            savers[i]=NULL;
+            if(first && jobs[i].spool)
+            {
+                saver->setVideo(jobs[i].spool);
+                jobs[i].spool=NULL;
+                if(!saver->save())
+                {
+                    ADM_warning("Cannot save rendition %s\n",renditions[i].fileName.c_str());
+                    r=false;
+                }
+            }else
+            {
+                if(first)
+                    ADM_warning("Rendition %s was not encoded\n",renditions[i].fileName.c_str());
+                r=false;
+                if(jobs[i].spool)
+                    delete jobs[i].spool;
+                jobs[i].spool=NULL;
+            }
+            delete saver;
+        }
+    }
+    ADM_slaveSendResult(r);
+    A_Rewind();
+    GUI_GoToTime(current);
+    return (int)r;
+}
+
 /**
     \fn admSaver
 */
@@ -116,10 +382,14 @@ int A_Save(const char *name)
         fileName=std::string(out);
         logFileName=fileName;
         logFileName+=std::string(".stats");
+        passCacheName=fileName;
+        passCacheName+=std::string(".pass1");
         muxer=NULL;
         chain=NULL;
         audio=NULL;
         video=NULL;
+        presetVideo=NULL;
+        statsStarted=false;
         for(int i=0;i<ADM_MAX_AUDIO_STREAM;i++)
             audioAccess[i]=NULL;
         markerA=video_body->getMarkerAPts();
@@ -147,11 +417,16 @@ admSaver::~admSaver()
  if(video)
         delete video;
  video=NULL;
+ if(presetVideo)
+        delete presetVideo;
+ presetVideo=NULL;
   if(chain)
   {
         destroyVideoFilterChain(chain);
    }
    chain=NULL;
+   if(ADM_fileExist(passCacheName.c_str()))
+        ADM_eraseFile(passCacheName.c_str());
 
     // encoder must not be destroyed, it will be destroyed with video
 }
@@ -166,6 +441,8 @@ ADM_coreVideoEncoder *admSaver::handleFirstPass(ADM_coreVideoEncoder *pass1)
 ADM_coreVideoFilter  *last;
 bool skip=false;
 bool abort=false;
+bool cached=false;
+FilterInfo cachedInfo;
     int sze=chain->size();
     ADM_assert(sze);
     last=(*chain)[sze-1]; // Grab last filter
@@ -184,6 +461,23 @@ bool abort=false;
     
     if(!skip)
     {
+        // Store the filtered pictures so that pass 2 does not decode and filter again ?
+        bool cachePass=false;
+        ADM_passCacheWriter *cacheWriter=NULL;
+        prefs->get(FEATURES_CACHE_FIRST_PASS,&cachePass);
+        if(cachePass)
+        {
+            cacheWriter=new ADM_passCacheWriter(last,passCacheName);
+            chain->push_back(cacheWriter);
+            // The encoder must read from the writer, create it again
+            delete pass1;
+            pass1=createVideoEncoderFromIndex(cacheWriter,videoEncoderIndex,muxer->useGlobalHeader());
+            if(!pass1)
+            {
+                printf("[Save] Cannot create encoder for pass 1\n");
+                return NULL;
+            }
+        }
         pass1->setPassAndLogFile(1,logFileName.c_str());
         if(false==pass1->setup())
         {
@@ -192,6 +486,7 @@ bool abort=false;
             pass1=NULL;
             return NULL;
         }
+        pass1->prefetchLookahead();
 
         if(!(muxer=ADM_MuxerSpawnFromIndex(muxerIndex)))
         {
@@ -244,9 +539,16 @@ bool abort=false;
         pass1=NULL;
 
         printf("[Save] Pass 1 done, encoded %d frames, restarting for pass 2\n",nbFrames);
+        if(cacheWriter && !abort)
+        {
+            cached=cacheWriter->isComplete();
+            cacheWriter->getStoredInfo(&cachedInfo);
+        }
         // Destroy filter chain & create the new encoder
         destroyVideoFilterChain(chain);
         chain=NULL;
+        if(cacheWriter && !cached)
+            ADM_eraseFile(passCacheName.c_str());
         
         if(abort)
         {
@@ -255,7 +557,23 @@ bool abort=false;
         }
         
     }
-    chain=createVideoFilterChain(markerA,markerB);
+    ADM_stageStatsStart(); // only keep the numbers of the pass producing the file
+    if(cached)
+    {
+        ADM_passCacheReader *reader=new ADM_passCacheReader(passCacheName,&cachedInfo);
+        if(reader->isOpen())
+        {
+            ADM_info("[Save] Pass 2 reads the pictures of pass 1 from %s\n",passCacheName.c_str());
+            chain=new ADM_videoFilterChain;
+            chain->push_back(reader);
+            chain->push_back(new ADM_videoFilterQueue(reader,NULL,"pass cache queue"));
+        }else
+        {
+            delete reader;
+        }
+    }
+    if(!chain)
+        chain=createVideoFilterChain(markerA,markerB,true);
 
     if(!chain)
     {
@@ -313,6 +631,8 @@ ADM_videoStreamCopy *admSaver::dealWithH26x(bool isAnnexB)
 ADM_videoStream *admSaver::setupVideo(void)
 {
     ADM_videoStream *video=NULL;
+    if(presetVideo)
+        return takeVideo();
     // Video Stream
     if(!videoEncoderIndex) // Copy
     {
@@ -342,10 +662,21 @@ ADM_videoStream *admSaver::setupVideo(void)
         
     }else
     {
+        // 0- Reuse the chunks encoded by a previous export ?
+        //******************************
+        bool reuse=false;
+        prefs->get(FEATURES_REUSE_ENCODED_CHUNKS,&reuse);
+        if(reuse)
+        {
+            video=ADM_videoStreamChunked::create(video_body,markerA,markerB,videoEncoderIndex,muxer->useGlobalHeader());
+            if(video)
+                return video;
+            ADM_stageStatsStart(); // forget the stages of the attempt
+        }
         // 1- create filter chain
         //******************************
 
-        chain=createVideoFilterChain(markerA,markerB);
+        chain=createVideoFilterChain(markerA,markerB,true);
         if(!chain)
         {
                 GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Video"),QT_TRANSLATE_NOOP("adm","Cannot instantiate video chain"));
@@ -381,6 +712,7 @@ ADM_videoStream *admSaver::setupVideo(void)
             encoder=NULL;
             return NULL;
         }
+        encoder->prefetchLookahead();
         video= new ADM_videoStreamProcess(encoder);
         if(!video)
         {
@@ -391,6 +723,61 @@ ADM_videoStream *admSaver::setupVideo(void)
     }  
     return video;
 }
+/**
+    \fn setupRendition
+    \brief Create the encoder of one rendition on top of its own filters, it is used by the next save()
+*/
+bool admSaver::setupRendition(ADM_coreVideoFilter *tail,int muxer,int encoder)
+{
+    muxerIndex=muxer;
+    videoEncoderIndex=encoder;
+    if(!this->muxer && !(this->muxer=ADM_MuxerSpawnFromIndex(muxerIndex)))
+    {
+        GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Muxer"),QT_TRANSLATE_NOOP("adm","Cannot instantiate muxer"));
+        return false;
+    }
+    ADM_coreVideoEncoder *enc=createVideoEncoderFromIndex(tail,videoEncoderIndex,this->muxer->useGlobalHeader());
+    if(!enc)
+    {
+        GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Video"),QT_TRANSLATE_NOOP("adm","Cannot create encoder"));
+        return false;
+    }
+    // The first pass would need the pictures twice
+    if(enc->isDualPass())
+    {
+        GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Video"),QT_TRANSLATE_NOOP("adm","Two pass encoding is not supported when saving several renditions"));
+        delete enc;
+        return false;
+    }
+    if(enc->setup()==false)
+    {
+        GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Video"),QT_TRANSLATE_NOOP("adm","Cannot setup codec. Bitrate too low?"));
+        delete enc;
+        return false;
+    }
+    enc->prefetchLookahead();
+    presetVideo=new ADM_videoStreamProcess(enc);
+    return true;
+}
+/**
+    \fn takeVideo
+    \brief The caller becomes the owner of the prepared video stream
+*/
+ADM_videoStream *admSaver::takeVideo(void)
+{
+    ADM_videoStream *v=presetVideo;
+    presetVideo=NULL;
+    return v;
+}
+/**
+    \fn setVideo
+    \brief Mux this stream instead of creating one, the saver becomes its owner
+*/
+void admSaver::setVideo(ADM_videoStream *stream)
+{
+    ADM_assert(!presetVideo);
+    presetVideo=stream;
+}
 /**
     \fn    setupAudio
     \brief create the audio streams we will use (copy/process)
@@ -486,9 +873,24 @@ bool admSaver::save(void)
         return 0;
     }
      
+    if(!statsStarted)
+        ADM_stageStatsStart();
+    // Unless the whole session is already traced, trace this export only
+    bool traceExport=false;
+    if(!admTraceEnabled.load() && prefs->get(FEATURES_SAVE_EXPORT_TRACE,&traceExport) && traceExport)
+    {
+        ADM_traceSetThreadName("export");
+        ADM_traceStart();
+    }else
+    {
+        traceExport=false;
+    }
     ADM_videoStream *video=setupVideo();
     if(!video)
     {
+        ADM_stageStatsStop();
+        if(traceExport)
+            ADM_traceStop();
         return false;
     }
     // adjust audio starting time
@@ -502,6 +904,9 @@ bool admSaver::save(void)
         if(video) delete video;
         if(muxer) delete muxer;
         muxer=NULL;
+        ADM_stageStatsStop();
+        if(traceExport)
+            ADM_traceStop();
         return false;
     }
    
@@ -511,10 +916,29 @@ bool admSaver::save(void)
         GUI_Error_HIG(QT_TRANSLATE_NOOP("adm","Muxer"),QT_TRANSLATE_NOOP("adm","Cannot open "));
     }else
     {
+        ADM_stageStats *muxStats=ADM_stageStatsCreate("mux");
+        ADM_stageTimer timer;
         ret=muxer->save();
+        if(muxStats)
+            muxStats->addCall(timer.stop(),ret);
         if(false==muxer->close())
             ret=false;
     }
+    ADM_stageStatsStop();
+    ADM_stageStatsDump();
+    bool saveStats=false;
+    if(prefs->get(FEATURES_SAVE_EXPORT_STATS,&saveStats) && saveStats)
+    {
+        std::string statsName=fileName+std::string(".perf.json");
+        if(!ADM_stageStatsWriteJson(statsName.c_str()))
+            ADM_warning("Cannot write %s\n",statsName.c_str());
+    }
+    if(traceExport)
+    {
+        ADM_traceStop();
+        std::string traceName=fileName+std::string(".trace.json");
+        ADM_traceDump(traceName.c_str());
+    }
 
     if(video)
         delete video;
@@ -20,6 +20,7 @@
 #include "ADM_win32.h"
 #include "ADM_crashdump.h"
 #include "ADM_memsupport.h"
+#include "ADM_trace.h"
 #include "ADM_script2/include/ADM_script.h"
 #include "ADM_ffmp43.h"
 #include "ADM_coreVideoFilterFunc.h"
@@ -344,11 +345,30 @@ int startAvidemux(int argc, char *argv[])
         listOfHwInit[i]();
     }
     atexit(abortExitHandler);
+#ifdef ADM_BENCHMARK_BUILD
+    extern int ADM_benchMain(int argc,char **argv);
+    int er=ADM_benchMain(argc,argv);
+    cleanUp();
+    return er;
+#else
+    // Trace the whole session, the timeline is written when leaving
+    const char *traceFile=getenv("ADM_TRACE");
+    if(traceFile)
+    {
+        ADM_traceSetThreadName("main");
+        ADM_traceStart();
+    }
     UI_RunApp();
+    if(traceFile)
+    {
+        ADM_traceStop();
+        ADM_traceDump(traceFile);
+    }
     cleanUp();
 
     printf("Normal exit\n");
     return 0;
+#endif
 }
 void abortExitHandler(void)
 {
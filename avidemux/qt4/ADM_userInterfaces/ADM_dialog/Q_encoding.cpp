@@ -287,6 +287,16 @@ void DIA_encodingQt4::setContainer(const char *container)
         ADM_assert(ui);
         WRITEM(labelContainer,container);
 }
+/**
+    \fn setSlowestStage(const char *n)
+    \brief Display the stage of the export taking the most time
+*/
+
+void DIA_encodingQt4::setSlowestStage(const char *n)
+{
+        ADM_assert(ui);
+        WRITEM(labelSlowestStage,n);
+}
 
 /**
     \fn setQuantIn(int size)
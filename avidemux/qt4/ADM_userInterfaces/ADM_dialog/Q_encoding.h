@@ -59,6 +59,7 @@ public:
     void setBitrate(uint32_t br,uint32_t globalbr);
     void setContainer(const char *container);
     void setQuantIn(int size);
+    void setSlowestStage(const char *n);
     bool isAlive( void );
     void keepOpen(void);
  public slots:
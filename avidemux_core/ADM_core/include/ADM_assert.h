@@ -45,6 +45,8 @@ ADM_CORE6_EXPORT uint8_t         ADM_fileExist(const char *name);
 ADM_CORE6_EXPORT uint8_t         ADM_mkdir(const char *name);
 ADM_CORE6_EXPORT uint8_t         ADM_eraseFile(const char *name);
 ADM_CORE6_EXPORT int64_t         ADM_fileSize(const char *file);
+ADM_CORE6_EXPORT int64_t         ADM_fileMtime(const char *file); // seconds since the epoch, -1 on error
+ADM_CORE6_EXPORT int64_t         ADM_diskFreeSpace(const char *folder); // bytes available to the user, -1 on error
 /* Replacements for memory allocation functions */
 ADM_CORE6_EXPORT void     *ADM_alloc(size_t size);
 ADM_CORE6_EXPORT void     *ADM_memalign(size_t align,size_t size);
@@ -0,0 +1,68 @@
+/** *************************************************************************
+    \file ADM_threadPool.h
+    \brief Fixed set of worker threads to split one job into independent slices
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_THREAD_POOL_H
+#define ADM_THREAD_POOL_H
+
+#include "ADM_core6_export.h"
+#include <pthread.h>
+
+/**
+    Run slice number "slice" of the job described by cookie
+*/
+typedef void ADM_threadPoolJob(void *cookie,int slice);
+
+/**
+    \class ADM_threadPool
+    \brief Split a job (bands of an image, channels of an audio block...) over worker threads
+            The calling thread also processes slices, run() returns once all of them are done.
+            Only one job runs at a time, if the pool is already busy (or called from within a slice)
+            run() executes the slices on the calling thread, one after the other, while tryRun() returns
+            false so that the caller can use a cheaper serial path. Such jobs are counted and reported
+            when the pool is destroyed.
+*/
+class ADM_CORE6_EXPORT ADM_threadPool
+{
+protected:
+            int             nbThreads;
+            pthread_t       *threads;
+            pthread_mutex_t lock;
+            pthread_mutex_t busy;
+            pthread_cond_t  wakeWorkers;
+            pthread_cond_t  wakeCaller;
+            bool            quit;
+            // Current job
+            ADM_threadPoolJob *job;
+            void            *cookie;
+            int             nbSlices;
+            int             nextSlice;
+            int             pending;
+            uint32_t        nbJobs;         // jobs given to the workers
+            uint32_t        nbSerialized;   // jobs not given to the workers because the pool was busy
+
+    static  void            *workerEntry(void *me);
+            void            workerLoop(void);
+public:
+                            ADM_threadPool(int nbWorkers);
+                            ~ADM_threadPool();
+            /// Number of slices that can run simultaneously (workers + caller)
+            int             getNbSlices(void) {return nbThreads+1;}
+            bool            run(int nbSlices, ADM_threadPoolJob *job, void *cookie);
+            /// Same as run but does nothing and returns false if the slices cannot go to the workers
+            bool            tryRun(int nbSlices, ADM_threadPoolJob *job, void *cookie);
+
+            /// Shared pool, one thread per core
+    static  ADM_threadPool  *getInstance(void);
+    static  void            destroyInstance(void);  /// Stop the workers, called at exit
+};
+#endif
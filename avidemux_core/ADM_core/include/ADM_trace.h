@@ -0,0 +1,76 @@
+/** *************************************************************************
+    \file ADM_trace.h
+    \brief Timeline of what each thread is doing, dumped in the Chrome trace event format
+
+    Load the dump in chrome://tracing or https://ui.perfetto.dev
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef ADM_TRACE_H
+#define ADM_TRACE_H
+
+#include "ADM_core6_export.h"
+#include <stdint.h>
+#include <atomic>
+
+#define ADM_TRACE_RING_SIZE 16384 // Events kept per thread, must be a power of 2, the oldest ones are overwritten
+
+/**
+    When not tracing, a traced scope costs one relaxed load
+*/
+extern ADM_CORE6_EXPORT std::atomic<bool> admTraceEnabled;
+
+ADM_CORE6_EXPORT uint64_t   ADM_traceNow(void);
+ADM_CORE6_EXPORT void       ADM_traceComplete(const char *category,const char *name,uint64_t startUs);
+ADM_CORE6_EXPORT void       ADM_traceInstant(const char *category,const char *name);
+ADM_CORE6_EXPORT void       ADM_traceCounter(const char *name,int64_t value);
+ADM_CORE6_EXPORT void       ADM_traceSetThreadName(const char *name);
+
+ADM_CORE6_EXPORT void       ADM_traceStart(void);
+ADM_CORE6_EXPORT void       ADM_traceStop(void);
+ADM_CORE6_EXPORT bool       ADM_traceDump(const char *file);
+
+/**
+    \class ADM_traceScope
+    \brief Record the time between its creation and its destruction
+            category and name must stay valid until the trace is dumped (string literals, plugin names...)
+*/
+class ADM_traceScope
+{
+protected:
+        const char  *category;
+        const char  *name;
+        uint64_t    start;
+public:
+        ADM_traceScope(const char *c,const char *n)
+        {
+            name=NULL;
+            if(!admTraceEnabled.load(std::memory_order_relaxed))
+                return;
+            category=c;
+            name=n;
+            start=ADM_traceNow();
+        }
+        ~ADM_traceScope()
+        {
+            if(name)
+                ADM_traceComplete(category,name,start);
+        }
+};
+
+#define ADM_TRACE_CONCAT2(a,b) a##b
+#define ADM_TRACE_CONCAT(a,b) ADM_TRACE_CONCAT2(a,b)
+
+#define ADM_TRACE_SCOPE(category,name)  ADM_traceScope ADM_TRACE_CONCAT(admTraceScope,__LINE__)(category,name)
+#define ADM_TRACE_INSTANT(category,name) {if(admTraceEnabled.load(std::memory_order_relaxed)) ADM_traceInstant(category,name);}
+#define ADM_TRACE_COUNTER(name,value)   {if(admTraceEnabled.load(std::memory_order_relaxed)) ADM_traceCounter(name,value);}
+
+#endif
+//EOF
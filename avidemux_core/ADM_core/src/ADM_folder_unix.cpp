@@ -15,6 +15,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/statvfs.h>
 #include <string>
 
 #if defined(__APPLE__)
@@ -77,6 +78,28 @@ uint8_t ADM_eraseFile(const char *file)
         return true;
     return false;
 }
+/**
+    \fn ADM_fileMtime
+    \brief Last modification time, -1 on error
+*/
+int64_t ADM_fileMtime(const char *file)
+{
+    struct stat st;
+    if(stat(file,&st))
+        return -1;
+    return (int64_t)st.st_mtime;
+}
+/**
+    \fn ADM_diskFreeSpace
+    \brief Space left on the volume holding folder, -1 on error
+*/
+int64_t ADM_diskFreeSpace(const char *folder)
+{
+    struct statvfs st;
+    if(statvfs(folder,&st))
+        return -1;
+    return (int64_t)st.f_bavail*(int64_t)st.f_frsize;
+}
 
 /*----------------------------------------
       Create a directory
@@ -15,6 +15,7 @@
 
 
 #include <errno.h>
+#include <sys/stat.h>
 #include <string>
 #include <io.h>
 #include <direct.h>
@@ -371,5 +372,41 @@ uint8_t ADM_eraseFile(const char *file)
         return 0;
     return 1;
 }
+/**
+    \fn ADM_fileMtime
+    \brief utf8-capable stat(), last modification time, -1 on error
+*/
+int64_t ADM_fileMtime(const char *file)
+{
+    int fileNameLength = utf8StringToWideChar(file, -1, NULL);
+    wchar_t *wcFile = new wchar_t[fileNameLength];
+
+    utf8StringToWideChar(file, -1, wcFile);
+
+    struct _stat64 st;
+    int r = _wstat64(wcFile, &st);
+    delete [] wcFile;
+    if(r)
+        return -1;
+    return (int64_t)st.st_mtime;
+}
+/**
+    \fn ADM_diskFreeSpace
+    \brief utf8-capable, space left to the user on the volume holding folder, -1 on error
+*/
+int64_t ADM_diskFreeSpace(const char *folder)
+{
+    int folderNameLength = utf8StringToWideChar(folder, -1, NULL);
+    wchar_t *wcFolder = new wchar_t[folderNameLength];
+
+    utf8StringToWideChar(folder, -1, wcFolder);
+
+    ULARGE_INTEGER avail;
+    BOOL r = GetDiskFreeSpaceExW(wcFolder, &avail, NULL, NULL);
+    delete [] wcFolder;
+    if(!r)
+        return -1;
+    return (int64_t)avail.QuadPart;
+}
 
 // EOF
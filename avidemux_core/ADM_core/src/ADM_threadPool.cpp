@@ -0,0 +1,188 @@
+/***************************************************************************
+    \file ADM_threadPool.cpp
+    \brief Fixed set of worker threads to split one job into independent slices
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_threadPool.h"
+
+#define ADM_THREAD_POOL_MAX_WORKERS 63
+
+static ADM_threadPool   *sharedPool=NULL;
+static pthread_mutex_t  sharedPoolLock=PTHREAD_MUTEX_INITIALIZER;
+
+/**
+    \fn workerEntry
+*/
+void *ADM_threadPool::workerEntry(void *me)
+{
+    ADM_threadPool *pool=(ADM_threadPool *)me;
+    pool->workerLoop();
+    return NULL;
+}
+/**
+    \fn ctor
+    @param nbWorkers : number of threads to spawn, the caller of run() is an extra one
+*/
+ADM_threadPool::ADM_threadPool(int nbWorkers)
+{
+    if(nbWorkers<0) nbWorkers=0;
+    if(nbWorkers>ADM_THREAD_POOL_MAX_WORKERS) nbWorkers=ADM_THREAD_POOL_MAX_WORKERS;
+    pthread_mutex_init(&lock,NULL);
+    pthread_mutex_init(&busy,NULL);
+    pthread_cond_init(&wakeWorkers,NULL);
+    pthread_cond_init(&wakeCaller,NULL);
+    quit=false;
+    job=NULL;
+    cookie=NULL;
+    nbSlices=nextSlice=pending=0;
+    nbJobs=nbSerialized=0;
+    nbThreads=0;
+    threads=NULL;
+    if(nbWorkers)
+        threads=new pthread_t[nbWorkers];
+    for(int i=0;i<nbWorkers;i++)
+    {
+        if(pthread_create(threads+i,NULL,workerEntry,this))
+        {
+            ADM_warning("[threadPool] Cannot create worker %d\n",i);
+            break;
+        }
+        nbThreads++;
+    }
+    ADM_info("[threadPool] Created with %d workers\n",nbThreads);
+}
+/**
+    \fn dtor
+*/
+ADM_threadPool::~ADM_threadPool()
+{
+    ADM_info("[threadPool] %u jobs on the workers, %u left to the caller because the pool was busy\n",nbJobs,nbSerialized);
+    pthread_mutex_lock(&lock);
+    quit=true;
+    pthread_cond_broadcast(&wakeWorkers);
+    pthread_mutex_unlock(&lock);
+    for(int i=0;i<nbThreads;i++)
+        pthread_join(threads[i],NULL);
+    if(threads) delete [] threads;
+    threads=NULL;
+    pthread_cond_destroy(&wakeCaller);
+    pthread_cond_destroy(&wakeWorkers);
+    pthread_mutex_destroy(&busy);
+    pthread_mutex_destroy(&lock);
+}
+/**
+    \fn workerLoop
+*/
+void ADM_threadPool::workerLoop(void)
+{
+    pthread_mutex_lock(&lock);
+    while(1)
+    {
+        while(!quit && (!job || nextSlice>=nbSlices))
+            pthread_cond_wait(&wakeWorkers,&lock);
+        if(quit) break;
+        int slice=nextSlice++;
+        ADM_threadPoolJob *todo=job;
+        void *arg=cookie;
+        pthread_mutex_unlock(&lock);
+        todo(arg,slice);
+        pthread_mutex_lock(&lock);
+        pending--;
+        if(!pending)
+            pthread_cond_signal(&wakeCaller);
+    }
+    pthread_mutex_unlock(&lock);
+}
+/**
+    \fn run
+    \brief Execute slices 0..nb-1 of the job, returns when all are done
+*/
+bool ADM_threadPool::run(int nb, ADM_threadPoolJob *todo, void *arg)
+{
+    if(tryRun(nb,todo,arg))
+        return true;
+    for(int i=0;i<nb;i++)
+        todo(arg,i);
+    return true;
+}
+/**
+    \fn tryRun
+    \brief Execute slices 0..nb-1 of the job on the workers and the caller, returns when all are done.
+            Returns false without running any slice if there is no worker or if the pool is busy.
+*/
+bool ADM_threadPool::tryRun(int nb, ADM_threadPoolJob *todo, void *arg)
+{
+    if(nb<=0) return true;
+    if(!nbThreads) return false;
+    if(nb==1)
+    {
+        todo(arg,0);
+        return true;
+    }
+    if(pthread_mutex_trylock(&busy))
+    {
+        pthread_mutex_lock(&lock);
+        nbSerialized++;
+        pthread_mutex_unlock(&lock);
+        return false;
+    }
+    pthread_mutex_lock(&lock);
+    nbJobs++;
+    job=todo;
+    cookie=arg;
+    nbSlices=nb;
+    nextSlice=0;
+    pending=nb;
+    pthread_cond_broadcast(&wakeWorkers);
+    // Take our share
+    while(nextSlice<nbSlices)
+    {
+        int slice=nextSlice++;
+        pthread_mutex_unlock(&lock);
+        todo(arg,slice);
+        pthread_mutex_lock(&lock);
+        pending--;
+    }
+    while(pending)
+        pthread_cond_wait(&wakeCaller,&lock);
+    job=NULL;
+    cookie=NULL;
+    pthread_mutex_unlock(&lock);
+    pthread_mutex_unlock(&busy);
+    return true;
+}
+/**
+    \fn getInstance
+*/
+ADM_threadPool *ADM_threadPool::getInstance(void)
+{
+    pthread_mutex_lock(&sharedPoolLock);
+    if(!sharedPool)
+    {
+        int nb=ADM_cpu_num_processors();
+        sharedPool=new ADM_threadPool(nb-1);
+    }
+    pthread_mutex_unlock(&sharedPoolLock);
+    return sharedPool;
+}
+/**
+    \fn destroyInstance
+*/
+void ADM_threadPool::destroyInstance(void)
+{
+    pthread_mutex_lock(&sharedPoolLock);
+    if(sharedPool)
+        delete sharedPool;
+    sharedPool=NULL;
+    pthread_mutex_unlock(&sharedPoolLock);
+}
+// EOF
@@ -0,0 +1,295 @@
+/***************************************************************************
+    \file ADM_trace.cpp
+    \brief Timeline of what each thread is doing, dumped in the Chrome trace event format
+
+    Each thread writes its events in its own ring, without any lock, the
+    registry lock is only taken the first time a thread records something,
+    when starting and when dumping.
+    The dump is consistent once tracing is stopped, while tracing the oldest
+    events of a busy thread may be overwritten as they are written out.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_threads.h"
+#include "ADM_trace.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define TRACE_MASK (ADM_TRACE_RING_SIZE-1)
+
+typedef enum
+{
+    TRACE_COMPLETE,
+    TRACE_INSTANT,
+    TRACE_COUNTER
+}traceType;
+
+/**
+    \struct traceEvent
+*/
+typedef struct
+{
+    const char  *category;
+    const char  *name;
+    uint64_t    startUs;
+    int64_t     value;      // duration for complete events, value for counters
+    traceType   type;
+}traceEvent;
+
+/**
+    \class traceRing
+    \brief Events of one thread, only written by that thread
+*/
+class traceRing
+{
+public:
+    uint32_t                tid;
+    std::string             threadName;     // protected by registryLock
+    uint64_t                firstKept;      // protected by registryLock, older events belong to a previous trace
+    std::atomic<uint64_t>   written;
+    std::atomic<bool>       finished;       // the thread is gone, the ring can be freed
+    traceEvent              events[ADM_TRACE_RING_SIZE];
+    traceRing()
+    {
+        tid=0;
+        firstKept=0;
+        written.store(0);
+        finished.store(false);
+    }
+};
+
+/**
+    \class traceThread
+    \brief Per thread handle, flags the ring as finished when the thread exits
+*/
+class traceThread
+{
+public:
+    traceRing   *ring;
+    std::string name;
+    traceThread()
+    {
+        ring=NULL;
+    }
+    ~traceThread()
+    {
+        if(ring)
+            ring->finished.store(true);
+    }
+};
+
+std::atomic<bool> admTraceEnabled(false);
+
+static thread_local traceThread             me;
+static admMutex                             registryLock;
+static std::vector <traceRing *>            registry;
+static uint32_t                             lastTid=0;
+static const std::chrono::steady_clock::time_point origin=std::chrono::steady_clock::now();
+
+/**
+    \fn ADM_traceNow
+    \brief Monotonic time in us
+*/
+uint64_t ADM_traceNow(void)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-origin).count();
+}
+/**
+    \fn getRing
+*/
+static traceRing *getRing(void)
+{
+    if(me.ring)
+        return me.ring;
+    traceRing *ring=new traceRing;
+    registryLock.lock();
+    ring->tid=++lastTid;
+    if(me.name.size())
+    {
+        ring->threadName=me.name;
+    }else
+    {
+        char str[32];
+        snprintf(str,sizeof(str),"thread %u",ring->tid);
+        ring->threadName=std::string(str);
+    }
+    registry.push_back(ring);
+    registryLock.unlock();
+    me.ring=ring;
+    return ring;
+}
+/**
+    \fn record
+*/
+static void record(traceType type,const char *category,const char *name,uint64_t startUs,int64_t value)
+{
+    traceRing *ring=getRing();
+    uint64_t w=ring->written.load(std::memory_order_relaxed);
+    traceEvent *e=ring->events+(w&TRACE_MASK);
+    e->type=type;
+    e->category=category;
+    e->name=name;
+    e->startUs=startUs;
+    e->value=value;
+    ring->written.store(w+1,std::memory_order_release);
+}
+/**
+    \fn ADM_traceComplete
+    \brief Record a span from startUs to now
+*/
+void ADM_traceComplete(const char *category,const char *name,uint64_t startUs)
+{
+    uint64_t now=ADM_traceNow();
+    record(TRACE_COMPLETE,category,name,startUs,(int64_t)(now-startUs));
+}
+/**
+    \fn ADM_traceInstant
+*/
+void ADM_traceInstant(const char *category,const char *name)
+{
+    record(TRACE_INSTANT,category,name,ADM_traceNow(),0);
+}
+/**
+    \fn ADM_traceCounter
+    \brief Record the value of name, e.g. the number of items in a queue
+*/
+void ADM_traceCounter(const char *name,int64_t value)
+{
+    record(TRACE_COUNTER,"counter",name,ADM_traceNow(),value);
+}
+/**
+    \fn ADM_traceSetThreadName
+    \brief Name displayed for the calling thread, the string is copied
+*/
+void ADM_traceSetThreadName(const char *name)
+{
+    me.name=std::string(name);
+    if(!me.ring)
+        return;
+    registryLock.lock();
+    me.ring->threadName=me.name;
+    registryLock.unlock();
+}
+/**
+    \fn ADM_traceStart
+    \brief Forget the previous events and start tracing
+*/
+void ADM_traceStart(void)
+{
+    registryLock.lock();
+    std::vector <traceRing *> alive;
+    for(int i=0;i<registry.size();i++)
+    {
+        traceRing *ring=registry[i];
+        if(ring->finished.load())
+        {
+            delete ring;
+            continue;
+        }
+        ring->firstKept=ring->written.load(std::memory_order_acquire);
+        alive.push_back(ring);
+    }
+    registry=alive;
+    admTraceEnabled.store(true);
+    registryLock.unlock();
+    ADM_info("Tracing started\n");
+}
+/**
+    \fn ADM_traceStop
+*/
+void ADM_traceStop(void)
+{
+    admTraceEnabled.store(false);
+}
+/**
+    \fn writeString
+    \brief Write s as a JSON string
+*/
+static void writeString(FILE *f,const char *s)
+{
+    fputc('"',f);
+    for(;s && *s;s++)
+    {
+        unsigned char c=(unsigned char)*s;
+        if(c=='"' || c=='\\')
+        {
+            fputc('\\',f);
+            fputc(c,f);
+        }else if(c<0x20)
+        {
+            fprintf(f,"\\u%04x",c);
+        }else
+        {
+            fputc(c,f);
+        }
+    }
+    fputc('"',f);
+}
+/**
+    \fn ADM_traceDump
+    \brief Write the events of all threads as a Chrome trace event JSON file
+*/
+bool ADM_traceDump(const char *file)
+{
+    FILE *f=ADM_fopen(file,"wt");
+    if(!f)
+    {
+        ADM_error("Cannot create trace file %s\n",file);
+        return false;
+    }
+    uint32_t nbEvents=0;
+    bool first=true;
+    fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    registryLock.lock();
+    for(int i=0;i<registry.size();i++)
+    {
+        traceRing *ring=registry[i];
+        fprintf(f,"%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",first? "":",\n",ring->tid);
+        writeString(f,ring->threadName.c_str());
+        fprintf(f,"}}");
+        first=false;
+        uint64_t w=ring->written.load(std::memory_order_acquire);
+        uint64_t from=ring->firstKept;
+        if(w>ADM_TRACE_RING_SIZE && w-ADM_TRACE_RING_SIZE>from)
+            from=w-ADM_TRACE_RING_SIZE;
+        for(uint64_t j=from;j<w;j++)
+        {
+            traceEvent e=ring->events[j&TRACE_MASK];
+            fprintf(f,",\n{\"name\":");
+            writeString(f,e.name);
+            fprintf(f,",\"cat\":");
+            writeString(f,e.category);
+            switch(e.type)
+            {
+                case TRACE_COMPLETE:
+                    fprintf(f,",\"ph\":\"X\",\"dur\":%" PRId64,e.value);
+                    break;
+                case TRACE_INSTANT:
+                    fprintf(f,",\"ph\":\"i\",\"s\":\"t\"");
+                    break;
+                case TRACE_COUNTER:
+                    fprintf(f,",\"ph\":\"C\",\"args\":{\"value\":%" PRId64"}",e.value);
+                    break;
+            }
+            fprintf(f,",\"ts\":%" PRIu64",\"pid\":1,\"tid\":%u}",e.startUs,ring->tid);
+            nbEvents++;
+        }
+    }
+    registryLock.unlock();
+    fprintf(f,"\n]}\n");
+    bool r=!ferror(f);
+    fclose(f);
+    ADM_info("Wrote %u trace events to %s\n",nbEvents,file);
+    return r;
+}
+//EOF
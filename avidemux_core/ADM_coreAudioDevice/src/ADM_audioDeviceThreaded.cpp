@@ -18,6 +18,7 @@
 #include "ADM_default.h"
 #include "ADM_audiodevice.h"
 #include "ADM_audioDeviceInternal.h"
+#include "ADM_trace.h"
 #include "math.h"
 
 const char *i2state(int a)
@@ -62,9 +63,10 @@ audioDeviceThreaded *device=(audioDeviceThreaded *)in;
 void audioDeviceThreaded::Loop(void)
 {
     printf("[AudioDeviceThreaded] Entering loop\n");
+    ADM_traceSetThreadName("audio device");
     while(stopRequest==AUDIO_DEVICE_STARTED)
     {
-
+        ADM_TRACE_SCOPE("audio device","sendData");
         sendData();
 
     }
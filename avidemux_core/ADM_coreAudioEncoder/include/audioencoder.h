@@ -59,6 +59,13 @@ class ADM_COREAUDIOENCODER6_EXPORT ADM_AudioEncoder
     bool            reorder(float *sample_in,float *sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut);
     bool            reorderToPlanar(float *sample_in,float *sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut);
     bool            reorderToPlanar2(float *sample_in,float **sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut);
+    // Source channel of each output channel, -1 if none. Recomputed only when the mapping changes
+    const int       *getReorderMap(CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut);
+    CHANNEL_TYPE    reorderMapIn[MAX_CHANNELS];
+    CHANNEL_TYPE    reorderMapOut[MAX_CHANNELS];
+    int             reorderSource[MAX_CHANNELS];
+    bool            reorderIdentity;
+    int             reorderChannels;
     // The encoder can remap the audio channel (or not). If so, let's store the the configuration here
     CHANNEL_TYPE    outputChannelMapping[MAX_CHANNELS];
     WAVHeader       wavheader;  /// To be filled by the encoder, especially byterate and codec Id.
@@ -21,6 +21,11 @@
 #include "ADM_audioCodecEnum.h"
 #include "BVector.h"
 #include "audioencoderInternal.h"
+#include "ADM_trace.h"
+
+#if defined( ADM_CPU_X86)
+extern "C"     void adm_deinterleave2_sse(const float *src,float *left,float *right, int count);
+#endif
 
 BVector <ADM_audioEncoder *> ListOfAudioEncoder;
 
@@ -36,6 +41,8 @@ ADM_AudioEncoder::ADM_AudioEncoder(AUDMAudioFilter *in, CONFcouple *setup)
     _incoming=in;
     memset(&wavheader,0,sizeof(wavheader));
     tmphead=tmptail=0;
+    reorderChannels=0;
+    reorderIdentity=false;
     WAVHeader  *info=in->getInfo();
     // Copy channels etc.. from incoming
     wavheader.channels=info->channels;
@@ -75,7 +82,10 @@ bool  ADM_AudioEncoder::refillBuffer(int minimum)
       tmphead=0;
     }
     ADM_assert(filler>tmptail);
-    nb=_incoming->fill( (filler-tmptail)/2,tmpbuffer.at(tmptail),&status);
+    {
+        ADM_TRACE_SCOPE("audio","filters+decode");
+        nb=_incoming->fill( (filler-tmptail)/2,tmpbuffer.at(tmptail),&status);
+    }
     if(!nb)
     {
       if(status!=AUD_END_OF_STREAM) ADM_assert(0);
@@ -93,9 +103,126 @@ bool  ADM_AudioEncoder::refillBuffer(int minimum)
   }
     return true;
 }
+/**
+    \fn getReorderMap
+    \brief For each output channel, the input channel it comes from (-1 if none).
+            The encoders pass the same mapping for every block, so it is only rebuilt when it changes.
+*/
+const int *ADM_AudioEncoder::getReorderMap(CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut)
+{
+    int channel=wavheader.channels;
+    ADM_assert(channel<=MAX_CHANNELS);
+    if(reorderChannels==channel
+        && !memcmp(reorderMapIn,mapIn,channel*sizeof(CHANNEL_TYPE))
+        && !memcmp(reorderMapOut,mapOut,channel*sizeof(CHANNEL_TYPE)))
+        return reorderSource;
+    memcpy(reorderMapIn,mapIn,channel*sizeof(CHANNEL_TYPE));
+    memcpy(reorderMapOut,mapOut,channel*sizeof(CHANNEL_TYPE));
+    reorderChannels=channel;
+    reorderIdentity=true;
+    for(int i=0;i<channel;i++)
+    {
+        reorderSource[i]=-1;
+        for(int z=0;z<channel;z++)
+            if(mapOut[i]==mapIn[z])
+            {
+                reorderSource[i]=z;
+                break;
+            }
+        if(reorderSource[i]==-1)
+            ADM_warning("Cannot map channel %d : %s\n",i,ADM_printChannel(mapOut[i]));
+        if(reorderSource[i]!=i)
+            reorderIdentity=false;
+    }
+    return reorderSource;
+}
+/**
+    \fn deinterleaveN
+    \brief One pass over the interleaved samples, the channel count is known at compile time
+            so that the inner loop is unrolled
+*/
+template <int CH>
+static void deinterleaveN(const float *in,float **out,const int *source,int nb)
+{
+    for(int j=0;j<nb;j++)
+    {
+        for(int c=0;c<CH;c++)
+            out[c][j]=in[source[c]];
+        in+=CH;
+    }
+}
+/**
+    \fn deinterleaveAny
+*/
+static void deinterleaveAny(const float *in,float **out,const int *source,int channel,int nb)
+{
+    for(int j=0;j<nb;j++)
+    {
+        for(int c=0;c<channel;c++)
+            out[c][j]=in[source[c]];
+        in+=channel;
+    }
+}
+/**
+    \fn deinterleave
+    \brief Split interleaved samples into one plane per output channel
+*/
+static void deinterleave(const float *in,float **out,const int *source,int channel,int nb)
+{
+    switch(channel)
+    {
+        case 1: memcpy(out[0],in,nb*sizeof(float));return;
+        case 2:
+        {
+#if defined( ADM_CPU_X86)
+            if(CpuCaps::hasSSE() && nb>=4)
+            {
+                float *left=out[0],*right=out[1];
+                if(source[0]==1)
+                {
+                    left=out[1];
+                    right=out[0];
+                }
+                int blocks=nb>>2;
+                adm_deinterleave2_sse(in,left,right,blocks);
+                blocks<<=2;
+                for(int j=blocks;j<nb;j++)
+                {
+                    left[j]=in[2*j];
+                    right[j]=in[2*j+1];
+                }
+                return;
+            }
+#endif
+            deinterleaveN<2>(in,out,source,nb);
+            return;
+        }
+        case 3: deinterleaveN<3>(in,out,source,nb);return;
+        case 4: deinterleaveN<4>(in,out,source,nb);return;
+        case 5: deinterleaveN<5>(in,out,source,nb);return;
+        case 6: deinterleaveN<6>(in,out,source,nb);return;
+        case 7: deinterleaveN<7>(in,out,source,nb);return;
+        case 8: deinterleaveN<8>(in,out,source,nb);return;
+        default: deinterleaveAny(in,out,source,channel,nb);return;
+    }
+}
+/**
+    \fn reorderN
+*/
+template <int CH>
+static void reorderN(const float *in,float *out,const int *source,int nb)
+{
+    for(int j=0;j<nb;j++)
+    {
+        for(int c=0;c<CH;c++)
+            out[c]=in[source[c]];
+        in+=CH;
+        out+=CH;
+    }
+}
 /**
  * \fn reorderToPlanar
- * 
+ * \brief Reorder and de-interleave, the planes are stored one after the other in sample_out
  * @param sample_in
  * @param sample_out
  * @param samplePerChannel
@@ -105,27 +232,20 @@ bool  ADM_AudioEncoder::refillBuffer(int minimum)
  */
 bool ADM_AudioEncoder::reorderToPlanar(float *sample_in,float *sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut)
 {
-        // build matrix 
     int channel=wavheader.channels;
+    const int *source=getReorderMap(mapIn,mapOut);
+    float *planes[MAX_CHANNELS];
     for(int i=0;i<channel;i++)
     {
-        int chanIn=-1;
-        for(int z=0;z<channel;z++)
-            if(mapOut[i]==mapIn[z]) chanIn=z;
-        ADM_assert(chanIn!=-1);
-        float *in=sample_in+chanIn;
-        float *out=sample_out+(i*samplePerChannel);
-        for(int j=0;j<samplePerChannel;j++)
-        {
-            *out++=*in;
-            in+=channel;
-        }
+        ADM_assert(source[i]!=-1);
+        planes[i]=sample_out+(i*samplePerChannel);
     }
+    deinterleave(sample_in,planes,source,channel,samplePerChannel);
     return true;
 }
 /**
- * \fn reorderToPlanar
- * 
+ * \fn reorderToPlanar2
+ * \brief Reorder and de-interleave, one buffer per output channel
  * @param sample_in
  * @param sample_out
  * @param samplePerChannel
@@ -135,31 +255,17 @@ bool ADM_AudioEncoder::reorderToPlanar(float *sample_in,float *sample_out,int sa
  */
 bool ADM_AudioEncoder::reorderToPlanar2(float *sample_in,float **sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut)
 {
-        // build matrix 
     int channel=wavheader.channels;
+    const int *source=getReorderMap(mapIn,mapOut);
     for(int i=0;i<channel;i++)
-    {
-        int chanIn=-1;
-        for(int z=0;z<channel;z++)        
-            if(mapOut[i]==mapIn[z]) 
-            {
-                chanIn=z;
-                break;
-            }
-        ADM_assert(chanIn!=-1);
-        float *in=sample_in+chanIn;
-        float *out=sample_out[i];
-        for(int j=0;j<samplePerChannel;j++)
-        {
-            *out++=*in;
-            in+=channel;
-        }
-    }
+        ADM_assert(source[i]!=-1);
+    deinterleave(sample_in,sample_out,source,channel,samplePerChannel);
     return true;
 }
 
 /**
- * 
+ * \fn reorder
+ * \brief Interleaved to interleaved. Output channels without a source are left untouched
  * @param sample_in
  * @param sample_out
  * @param samplePerChannel
@@ -169,35 +275,38 @@ bool ADM_AudioEncoder::reorderToPlanar2(float *sample_in,float **sample_out,int
  */
 bool ADM_AudioEncoder::reorder(float *sample_in,float *sample_out,int samplePerChannel,CHANNEL_TYPE *mapIn,CHANNEL_TYPE *mapOut)
 {
-        // build matrix 
-        int channel=wavheader.channels;
+    int channel=wavheader.channels;
+    const int *source=getReorderMap(mapIn,mapOut);
+    if(reorderIdentity)
+    {
+        memcpy(sample_out,sample_in,channel*samplePerChannel*sizeof(float));
+        return true;
+    }
+    bool complete=true;
     for(int i=0;i<channel;i++)
+        if(source[i]==-1)
+            complete=false;
+    if(complete)
     {
-        CHANNEL_TYPE chanin=mapIn[i];
-        int chanout=-1;
-        for(int j=0;j<channel;j++)
-        {
-            if(mapOut[j]==chanin)
-            {
-                chanout=j;
-                //printf("Channel %s in source at %d, at exit at %d\n",ADM_printChannel(chanin),i,j);
-                break;
-            }
-        }
-        if(chanout==-1)
+        switch(channel)
         {
-            ADM_warning("Cannot map channel %d : %s\n",i,ADM_printChannel(chanin));
-            continue; 
+            case 2: reorderN<2>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 3: reorderN<3>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 4: reorderN<4>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 5: reorderN<5>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 6: reorderN<6>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 7: reorderN<7>(sample_in,sample_out,source,samplePerChannel);return true;
+            case 8: reorderN<8>(sample_in,sample_out,source,samplePerChannel);return true;
+            default: break;
         }
-        float *xin=sample_in+i;
-        float *xout=sample_out+chanout;
-        for(int x=0;x<samplePerChannel;x++)
-        {
-            *xout=*xin;
-            xout+=channel;
-            xin+=channel;
-        }
-        
+    }
+    for(int x=0;x<samplePerChannel;x++)
+    {
+        for(int c=0;c<channel;c++)
+            if(source[c]!=-1)
+                sample_out[c]=sample_in[source[c]];
+        sample_in+=channel;
+        sample_out+=channel;
     }
     return true;
 }
@@ -0,0 +1,27 @@
+;
+;  Split interleaved stereo into two planes
+;  src, left and right can be unaligned
+;  count is the number of blocks of 4 samples per channel
+;
+%define private_prefix adm
+%define public_prefix  adm
+
+%include "admx86util.asm"
+
+section .text
+INIT_XMM sse
+cglobal deinterleave2, 4,4,3, src, left, right, l
+.again:
+        movups           m0,   [srcq]
+        movups           m1,   [srcq+16]
+        movaps           m2,   m0
+        shufps           m0,   m1, 0x88
+        shufps           m2,   m1, 0xDD
+        movups           [leftq],  m0
+        movups           [rightq], m2
+        add              srcq,  32
+        add              leftq, 16
+        add              rightq,16
+        sub              ld,    1
+        jnz             .again
+        RET
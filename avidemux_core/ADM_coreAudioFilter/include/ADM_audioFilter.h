@@ -21,6 +21,8 @@
 #include "ADM_coreAudioFilterAPI6_export.h"
 #include <string>
 #define AUD_PROCESS_BUFFER_SIZE 48000*4*4 // should be enougth 4 seconds of stereo
+#define AUD_BLOCK_SAMPLES       4096        // samples per channel in a processing block
+#define AUD_BLOCK_ALIGN         64          // in bytes, blocks start on a cache line
 #include "ADM_coreAudio.h"
 /**
   This enumerate is used to give a more accurate error when no audio is output from
@@ -64,6 +66,17 @@ class ADM_COREAUDIOFILTERAPI6_EXPORT AUDMAudioFilter
     virtual uint8_t fillIncomingBuffer(AUD_Status *status);
     //! length in float
     uint32_t        _length;
+
+    //! Output block, see getBlock. _block points inside _blockBuffer, aligned on AUD_BLOCK_ALIGN
+    ADM_floatBuffer _blockBuffer;
+    float           *_block;
+    //! Part of the last block not yet returned by fillFromBlocks
+    float           *_pendingBlock;
+    uint32_t        _pendingLen;
+    //! Allocate _block the first time, for the current number of channels
+    float           *getBlockBuffer(void);
+    //! fill() for the filters that work on blocks
+    uint32_t        fillFromBlocks(uint32_t max,float *output,AUD_Status *status);
     
   public:
 /** Constructor
@@ -82,6 +95,13 @@ class ADM_COREAUDIOFILTERAPI6_EXPORT AUDMAudioFilter
 //! \param output : Where to store output float
 //! \param status : Status of the fill operation
     virtual    uint32_t   fill(uint32_t max,float *output,AUD_Status *status)=0;
+
+//! Process the next block of interleaved samples and return a pointer to it in *data.
+//! The block holds up to AUD_BLOCK_SAMPLES samples per channel and starts on AUD_BLOCK_ALIGN bytes.
+//! It stays valid until the next call and the caller can modify it in place.
+//! By default the block is filled through fill(), filters that can work in place override it.
+//! \return number of float in the block, 0 at the end of the stream
+    virtual    uint32_t   getBlock(float **data,AUD_Status *status);
                                                                                      
 //! Returns the output wavheader infos field
         virtual    WAVHeader  *getInfo(void);
@@ -1,26 +1,59 @@
 /**
     \fn ADM_audioResample.h
-    \brief Wrapper around libsamplerate
+    \brief Polyphase FIR resampler, wrapper around libsamplerate for uncommon ratios
 
 
 */
 #ifndef ADM_audioResample_H
 #define ADM_audioResample_H
 
+/**
+    Quality presets, they select the filter length and its stop band attenuation
+*/
+typedef enum
+{
+    ADM_RESAMPLE_QUALITY_FAST=0,
+    ADM_RESAMPLE_QUALITY_MEDIUM=1,
+    ADM_RESAMPLE_QUALITY_HIGH=2
+}ADM_RESAMPLE_QUALITY;
+
 class ADM_resample
 {
 protected:
-      void *context;
+      void *context;  // libsamplerate context, only used if polyphase cannot be used
       uint32_t fromFrequency;
       uint32_t toFrequency;
       uint32_t nbChannels;
       double   ratio;
+      // Polyphase
+      uint32_t up;          // Output rate / gcd
+      uint32_t down;        // Input rate / gcd
+      uint32_t nbTaps;      // Filter length for one phase, multiple of 4
+      float    *coefs;      // up phases of nbTaps coefficients
+      uint32_t phase;       // Position of the next output between two input samples, in 1/up unit
+      uint32_t position;    // Start of the filter window for the next output in history
+      uint32_t filled;      // Nb of valid samples per channel in history
+      uint32_t historySize; // Allocated samples per channel
+      float    **history;   // Per channel incoming samples
+      float    **planar;    // Per channel output samples before interleaving
+      uint32_t planarSize;
+      uint64_t totalIn;     // Samples per channel given since the last reset
+      uint64_t totalOut;    // Samples per channel produced since the last reset
+      float    *silence;    // Fed to the filter to drain it at the end of the stream
+
+      bool     initPolyphase(ADM_RESAMPLE_QUALITY quality);
+      bool     processPolyphase(float *from, float *to, uint32_t nbSample,uint32_t maxOutSample, uint32_t *sampleProcessed, uint32_t *outNbSample);
+      void     cleanup(void);
 public:
                 ADM_resample(void);
                 ~ADM_resample();
        bool     reset(void);
        bool     process(float *from, float *to, uint32_t nbSample,uint32_t maxOutSample, uint32_t *sampleProcessed, uint32_t *outNbSample);
-       bool     init(uint32_t from, uint32_t to, uint32_t channel);
+       // End of the stream, produce the samples still in the filter. Call it until it returns 0 samples
+       bool     flush(float *to, uint32_t maxOutSample, uint32_t *outNbSample);
+       bool     init(uint32_t from, uint32_t to, uint32_t channel,ADM_RESAMPLE_QUALITY quality=ADM_RESAMPLE_QUALITY_MEDIUM);
+       // Used by the worker threads
+       void     processChannel(int channel,float *from,uint32_t take,uint32_t nbOut);
 
 };
 
@@ -26,5 +26,6 @@ class AUDMAudioFilterSrc : public AUDMAudioFilter
     ~AUDMAudioFilterSrc();
     AUDMAudioFilterSrc(AUDMAudioFilter *instream,uint32_t  tgt);
     uint32_t   fill(uint32_t max,float *output,AUD_Status *status);
+    uint8_t    rewind(void);
 };
 #endif
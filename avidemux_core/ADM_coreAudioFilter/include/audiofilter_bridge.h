@@ -20,6 +20,7 @@
 #include "ADM_audioStream.h"
 #include "ADM_edit.hxx"
 #include "ADM_edAudioTrack.h"
+#include "ADM_packetPrefetch.h"
 class AUDMAudioFilter_Bridge : public AUDMAudioFilter
 {
   protected:
@@ -28,6 +29,10 @@ class AUDMAudioFilter_Bridge : public AUDMAudioFilter
     int64_t             _shiftUs;  /*< Shift in Ms */
     int32_t             _hold;   /*< Nb Sample to repeat */
     virtual uint8_t             fillIncomingBuffer(AUD_Status *status);
+    ADM_packetPrefetch  *_prefetch; /*< Decodes ahead on its own thread, NULL if disabled or after a seek */
+    bool                _prefetchEnabled;
+    bool                getPCMPacket(float *dest,uint32_t sizeMax,uint32_t *samples,uint64_t *dts);
+    static bool         decodeAhead(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet);
   public:
                                 AUDMAudioFilter_Bridge(ADM_edAudioTrack *incoming, 
                                                 uint32_t startInMs,int32_t shiftMS);
@@ -36,6 +41,7 @@ class AUDMAudioFilter_Bridge : public AUDMAudioFilter
                                                                                            // Output MAXIMUM max float value
                                                                                            // Not sample! float!
     virtual    uint8_t          rewind(void)  ;                                              // go back to the beginning
+                void            enablePrefetch(void);                                      // decode on a separate thread, not for playback
     virtual CHANNEL_TYPE        *getChannelMapping(void);
     virtual const std::string   &getLanguage(void);
 };
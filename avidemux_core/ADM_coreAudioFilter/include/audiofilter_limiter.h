@@ -43,6 +43,7 @@ class AUDMAudioFilterLimiter : public AUDMAudioFilter
     void               Follow(float x, float *outEnv, int maxBack);
     float              DoCompression(float value, float env);
     void               drc_cleanup(void);
+    void               process(float *samples,uint32_t len);
 #define ONE_CHUNK 1000
 #define DELIM_WINDOW_SIZE ONE_CHUNK/2		 
     float              follow[DELIM_WINDOW_SIZE];
@@ -52,5 +53,6 @@ class AUDMAudioFilterLimiter : public AUDMAudioFilter
                           AUDMAudioFilterLimiter(AUDMAudioFilter *previous, DRCparam *param);
     virtual                ~AUDMAudioFilterLimiter();
     virtual    uint32_t   fill(uint32_t max,float *output,AUD_Status *status);
+    virtual    uint32_t   getBlock(float **data,AUD_Status *status);
 };
 #endif
@@ -30,6 +30,7 @@ class AUDMAudioFilterMixer : public AUDMAudioFilter
       ~AUDMAudioFilterMixer();
       AUDMAudioFilterMixer(AUDMAudioFilter *instream,CHANNEL_CONF out);
       uint32_t   fill(uint32_t max,float *output,AUD_Status *status);
+      uint32_t   getBlock(float **data,AUD_Status *status);
       // That filter changes its output channel mapping...
       virtual   CHANNEL_TYPE    *getChannelMapping(void );
       uint8_t  rewind(void)
@@ -1,6 +1,8 @@
 #ifndef AUDIO_F_NORMALIZE_H
 #define AUDIO_F_NORMALIZE_H
 
+#include <string>
+#include <pthread.h>
 #include "ADM_audioFilter.h"
 #include "audiofilter_normalize_param.h"
 class AUDMAudioFilterNormalize : public AUDMAudioFilter
@@ -8,12 +10,27 @@ class AUDMAudioFilterNormalize : public AUDMAudioFilter
   protected:
               float       _ratio;
               uint32_t    _scanned;
+              int32_t     _maxLevel10;
+              std::string _scanKey;   // Describes what is upstream, empty means don't cache the scan
+              pthread_t   _scanThread;
+              bool        _scanRunning;   // the peak is being searched in the background
+              volatile bool _scanAbort;
+              float       _scanPeak;
               uint8_t     preprocess(void);
+              float       scanPeak(void);
+              void        computeRatio(float peak);
+              void        storePeak(float peak);
+              void        waitScan(void);
+    static    void        *scanEntry(void *me);
   public:
     // gainDB10 is the gain in DB multiplied by 10
     // 0 meaning automatic
-                          AUDMAudioFilterNormalize(AUDMAudioFilter *previous,GAINparam *param);
+                          AUDMAudioFilterNormalize(AUDMAudioFilter *previous,GAINparam *param,const std::string &scanKey=std::string());
     virtual                ~AUDMAudioFilterNormalize();
     virtual    uint32_t   fill(uint32_t max,float *output,AUD_Status *status);
+    virtual    uint32_t   getBlock(float **data,AUD_Status *status);
+    virtual    uint8_t    rewind(void);
+    // Forget all the peak values found so far
+    static     void       clearScanCache(void);
 };
 #endif
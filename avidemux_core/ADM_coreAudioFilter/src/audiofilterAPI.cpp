@@ -34,6 +34,9 @@ AUDMAudioFilter::AUDMAudioFilter(AUDMAudioFilter *previous)
   }
   _head=_tail=0; 
   _incomingBuffer.setSize(AUD_PROCESS_BUFFER_SIZE); 
+  _block=NULL;
+  _pendingBlock=NULL;
+  _pendingLen=0;
 }
 AUDMAudioFilter::~AUDMAudioFilter()
 {
@@ -42,6 +45,7 @@ AUDMAudioFilter::~AUDMAudioFilter()
 uint8_t  AUDMAudioFilter::rewind(void)
 {
   _head=_tail=0;
+  _pendingLen=0;
   return _previous->rewind();
 }
 
@@ -87,7 +91,73 @@ uint8_t AUDMAudioFilter::fillIncomingBuffer(AUD_Status *status)
  }
  return 1;
 }
-
+/**
+    \fn getBlockBuffer
+    \brief The number of channels is known once the filter is built, allocate on first use
+*/
+float *AUDMAudioFilter::getBlockBuffer(void)
+{
+    if(!_block)
+    {
+        uint32_t pad=AUD_BLOCK_ALIGN/sizeof(float);
+        _blockBuffer.setSize(AUD_BLOCK_SAMPLES*_wavHeader.channels+pad);
+        uintptr_t p=(uintptr_t)_blockBuffer.at(0);
+        p=(p+AUD_BLOCK_ALIGN-1)&~(uintptr_t)(AUD_BLOCK_ALIGN-1);
+        _block=(float *)p;
+    }
+    return _block;
+}
+/**
+    \fn getBlock
+    \brief Default implementation, pull full blocks through fill()
+*/
+uint32_t AUDMAudioFilter::getBlock(float **data,AUD_Status *status)
+{
+    float *block=getBlockBuffer();
+    uint32_t size=AUD_BLOCK_SAMPLES*_wavHeader.channels;
+    uint32_t done=0;
+    *status=AUD_OK;
+    while(done<size)
+    {
+        uint32_t nb=fill(size-done,block+done,status);
+        if(!nb)
+            break;
+        done+=nb;
+    }
+    *data=block;
+    if(done)
+        *status=AUD_OK;
+    return done;
+}
+/**
+    \fn fillFromBlocks
+    \brief Copy from the blocks returned by getBlock, keep what does not fit for the next call
+*/
+uint32_t AUDMAudioFilter::fillFromBlocks(uint32_t max,float *output,AUD_Status *status)
+{
+    uint32_t channels=_wavHeader.channels;
+    uint32_t done=0;
+    *status=AUD_OK;
+    max-=max%channels;
+    while(done<max)
+    {
+        if(!_pendingLen)
+        {
+            _pendingLen=getBlock(&_pendingBlock,status);
+            if(!_pendingLen)
+                break;
+        }
+        uint32_t nb=max-done;
+        if(nb>_pendingLen) nb=_pendingLen;
+        memcpy(output+done,_pendingBlock,nb*sizeof(float));
+        _pendingBlock+=nb;
+        _pendingLen-=nb;
+        done+=nb;
+    }
+    if(done)
+        *status=AUD_OK;
+    return done;
+}
 
 WAVHeader  *AUDMAudioFilter::getInfo(void)
 {
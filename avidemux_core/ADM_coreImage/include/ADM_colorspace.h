@@ -41,13 +41,19 @@ class ADM_COREIMAGE6_EXPORT ADMColorScalerFull
     uint32_t        dstWidth,dstHeight;
     ADM_colorspace  fromColor,toColor;
     ADMColorScaler_algo algo;
+    bool            threaded;
+    void            *bands; // Band contexts when the conversion is spread over the thread pool, NULL otherwise
     uint8_t         getStrideAndPointers(bool dst,uint8_t  *from,ADM_colorspace fromColor,
                                             uint8_t **srcData,int *srcStride);
+    bool            setupBands(int flags);
+    void            cleanupBands(void);
+    bool            scale(uint8_t **srcData, int *srcStride, uint8_t **dstData, int *dstStride);
   public :
     
                     ADMColorScalerFull(ADMColorScaler_algo algo, int sw, int sh, int dw,int dh,ADM_colorspace from,ADM_colorspace to);
     bool            reset(ADMColorScaler_algo, int sw, int sh, int dw,int dh,ADM_colorspace from,ADM_colorspace to);
-    
+                    /// Allow splitting big images in horizontal bands converted in parallel (default is on)
+    bool            setThreaded(bool onoff);
 
     bool            convert(uint8_t  *from, uint8_t *to);
     bool            convertImage(ADMImage *img, uint8_t *to);
@@ -64,6 +64,7 @@ typedef enum
         ADM_HW_VDPAU,
         ADM_HW_LIBVA,
         ADM_HW_DXVA,
+        ADM_HW_LAVC, /// Software picture still in a lavcodec buffer, shared instead of copied
         ADM_HW_ANY=0xff
 }ADM_HW_IMAGE;
 
@@ -108,6 +109,7 @@ public:
         uint64_t        Pts;        /// Presentation time in us
         ADM_IMAGE_TYPE  _imageType;     /// Plain image or reference or vdpau wrapper
         ADM_colorspace  _colorspace;    /// Colorspace we are moving, default is YV12
+        uint32_t        _bitDepth;      /// Bits per sample, 8 by default. Above 8, the samples are little endian uint16_t
         uint8_t         _noPicture;     /// No picture to display
         ADM_ASPECT	    _aspect;	/// Aspect ratio
         //
@@ -124,6 +126,8 @@ public:
         bool            GetPitches(int *pitches);
         bool            GetWritePlanes(uint8_t **planes);
         bool            GetReadPlanes(uint8_t **planes);
+        bool            isHighBitDepth(void) {return _bitDepth>8;}
+        uint32_t        GetBytesPerSample(void) {return (_bitDepth>8)? 2 : 1;}
 
 virtual                 ~ADMImage();
 
@@ -143,6 +147,7 @@ public:
         virtual      uint8_t        *GetReadPtr(ADM_PLANE plane)=0;
         virtual      bool           isWrittable(void)=0;
         virtual      ADMImageRef    *castToRef(void) {return NULL;};
+        virtual      bool           setBitDepth(uint32_t depth) {return depth==_bitDepth;} /// The content is lost if the storage changes
 
         virtual      bool           duplicateMacro(ADMImage *src,bool swap);       /// copy an image to ourself, including info
 
@@ -168,6 +173,9 @@ public:
         bool    saveAsPng(const char *filename);
         bool    printString(uint32_t x,uint32_t y, const char *strng);
 static  bool    copyPlane(ADMImage *s, ADMImage *d, ADM_PLANE plane);
+static  bool    convertPlaneDepth(uint8_t *dst,uint32_t dstPitch,uint32_t dstDepth,
+                                  uint8_t *src,uint32_t srcPitch,uint32_t srcDepth,
+                                  uint32_t width,uint32_t height);
 
         bool    convertFromYUV444(uint8_t *from);
         bool    convertFromNV12(uint8_t *yData, uint8_t *uvData, int strideY, int strideUV);
@@ -183,9 +191,11 @@ class ADM_COREIMAGE6_EXPORT ADMImageDefault: public ADMImage
 protected:
                     ADM_byteBuffer  data;
                     ADM_byteBuffer  alphaChannel;
+                    void            allocate(void);
 public:
-                                    ADMImageDefault(uint32_t w, uint32_t h);
+                                    ADMImageDefault(uint32_t w, uint32_t h, uint32_t bitDepth=8);
         virtual                     ~ADMImageDefault();
+        virtual      bool           setBitDepth(uint32_t depth);
         virtual      uint32_t        GetPitch(ADM_PLANE plane);
         virtual      uint8_t        *GetWritePtr(ADM_PLANE plane);
         virtual      uint8_t        *GetReadPtr(ADM_PLANE plane);
@@ -208,6 +218,7 @@ public:
         virtual      uint8_t        *GetReadPtr(ADM_PLANE plane);
         virtual      bool           isWrittable(void);
         virtual      ADMImageRef    *castToRef(void) {return this;};
+        virtual      bool           setBitDepth(uint32_t depth) {_bitDepth=depth;return true;} /// Whoever sets the planes knows
 };
 /**
     \class ADMImageRefWrittable
@@ -14,6 +14,11 @@
 
 #include "ADM_coreImage6_export.h"
 
+#define ADM_PP_MIN_BAND_LINES 128 // Smaller bands are not worth a thread, must be at least ADM_PP_STRIP_LINES/2
+#define ADM_PP_MAX_BANDS      16
+#define ADM_PP_STRIP_LINES    256 // Band boundaries are processed again in a strip of that height
+#define ADM_PP_STRIP_KEEP     32  // Lines kept from the strip on each side of a boundary, in each plane
+
 /**
     \class ADM_PP
     \brief wrapper around libavcodec postprocessing
@@ -23,7 +28,15 @@ class ADM_COREIMAGE6_EXPORT ADM_PP
 protected:
     void    			*ppContext; // pp_context_t
 	void    			*ppMode;    // pp_mode_t
+    // Horizontal bands processed in parallel, nbBands=0 if not threaded
+    int                 nbBands;
+    int                 bandStart[ADM_PP_MAX_BANDS+1];  // multiple of 16, bandStart[nbBands] is the height
+    void                *bandContext[ADM_PP_MAX_BANDS];
+    void                *stripContext[ADM_PP_MAX_BANDS];
+    uint8_t             *stripBuffer;
+    int                 stripStride;
     bool                cleanup(void);
+    bool                setupBands(int ww, int hh, uint32_t ppCaps);
 public:
 	
  	uint32_t			postProcType;
@@ -36,7 +49,9 @@ public:
                 ADM_PP(uint32_t width, uint32_t h);
                 ~ADM_PP();
     bool        update(void);
-    bool        process(class ADMImage *src, class ADMImage *dest);
+    bool        process(class ADMImage *src, class ADMImage *dest, bool useBands=true); /// useBands=false forces a single whole frame call
+    void        processSlice(void *job, int slice); /// Worker of the thread pool, see process
+    int         getNbBands(void) {return nbBands;}
 
 };
 #define FORCE_QUANT			0x200000
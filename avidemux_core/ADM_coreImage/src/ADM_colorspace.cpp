@@ -17,10 +17,13 @@
 #include "ADM_default.h"
 #include "ADM_colorspace.h"
 #include "ADM_image.h"
+#include "ADM_threadPool.h"
 
 extern "C" {
 #include "libavcodec/avcodec.h"
 #include "libavutil/avutil.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/pixdesc.h"
 #include "libswscale/swscale.h"
 }
 
@@ -40,6 +43,58 @@ extern "C" {
 
 #define CONTEXT (SwsContext *)context
 
+// Below that (biggest of source and destination), a single context is faster than waking up the pool
+#define ADM_SCALER_MIN_PIXELS_FOR_BANDS (1280*720)
+#define ADM_SCALER_MIN_UNITS_PER_BAND   4
+
+/**
+    \struct scalerBand
+    \brief One horizontal band of the destination.
+            The band context converts a source crop slightly taller than needed, so that the vertical filter
+            sees the same neighbours as the full frame context, into a scratch buffer. Only the rows
+            [keepStart,keepEnd[ are copied back to the destination.
+*/
+typedef struct
+{
+    SwsContext  *context;
+    int         srcStart,srcLines;
+    int         dstStart;
+    int         keepStart,keepEnd;
+    uint8_t     *scratch;
+    uint8_t     *scratchPlanes[4];
+}scalerBand;
+
+/**
+    \struct scalerBands
+*/
+typedef struct
+{
+    int         nbBands;
+    scalerBand  *band;
+    int         nbSrcPlanes,nbDstPlanes;
+    int         srcShift[4];        // vertical chroma subsampling per plane
+    int         dstShift[4];
+    int         dstLineSize[4];     // useful bytes per line
+    int         scratchStride[4];
+}scalerBands;
+
+/**
+    \struct scalerJob
+    \brief What the workers need for one conversion
+*/
+typedef struct
+{
+    scalerBands *bands;
+    uint8_t     **srcData;
+    int         *srcStride;
+    uint8_t     **dstData;
+    int         *dstStride;
+}scalerJob;
+
+#define BANDS ((scalerBands *)bands)
+
+static void scaleBand(void *cookie,int slice);
+
 /**
     \fn swapRGB
 */
@@ -194,16 +249,16 @@ uint8_t ADMColorScalerFull::getStrideAndPointers(bool dst,
 #define swap16(x) x=((x>>8)&0xff)+(x<<8)
 bool ADMColorScalerFull::convert(uint8_t  *from, uint8_t *to)
 {
-  uint8_t *srcData[3];
-  uint8_t *dstData[3];
-  int srcStride[3];
-  int dstStride[3];
+  uint8_t *srcData[4]={NULL,NULL,NULL,NULL};
+  uint8_t *dstData[4]={NULL,NULL,NULL,NULL};
+  int srcStride[4]={0,0,0,0};
+  int dstStride[4]={0,0,0,0};
   
   getStrideAndPointers(false,from,fromColor,srcData,srcStride);
   getStrideAndPointers(true,to,toColor,dstData,dstStride);
  
   
-  sws_scale(CONTEXT,srcData,srcStride,0,srcHeight,dstData,dstStride);
+  scale(srcData,srcStride,dstData,dstStride);
   if(toColor==ADM_COLOR_BGR32A)
   {
      swapRGB32(dstWidth,dstHeight,to);
@@ -232,8 +287,7 @@ bool            ADMColorScalerFull::convertPlanes(int  sourceStride[3],int destS
             src[i]=sourceData[i];
             dst[i]=destData[i];
         }
-     sws_scale(CONTEXT,src,xs,0,srcHeight,dst,xd);
-     return true;
+     return scale(src,xs,dst,xd);
 }
 /**
     \fn convertPlanes
@@ -256,8 +310,7 @@ bool            ADMColorScalerFull::convertImage(ADMImage *sourceImage, ADMImage
     src[3]=sourceImage->GetReadPtr(PLANAR_ALPHA);
     dst[3]=destImage->GetWritePtr(PLANAR_ALPHA);
     
-    sws_scale(CONTEXT,src,xs,0,srcHeight,dst,xd);
-    return true;
+    return scale(src,xs,dst,xd);
 }
 
 /**
@@ -275,6 +328,8 @@ ADMColorScalerFull::ADMColorScalerFull(ADMColorScaler_algo algo,
             ADM_colorspace from,ADM_colorspace to)
 {
    context=NULL;
+   bands=NULL;
+   threaded=true;
    reset(algo,sw,sh,dw,dh,from,to);
 
 }
@@ -284,6 +339,7 @@ ADMColorScalerFull::ADMColorScalerFull(ADMColorScaler_algo algo,
 */
 ADMColorScalerFull::~ADMColorScalerFull()
 {
+  cleanupBands();
   if(context)
   {
      sws_freeContext(CONTEXT);
@@ -295,6 +351,7 @@ ADMColorScalerFull::~ADMColorScalerFull()
 */
 bool  ADMColorScalerFull::reset(ADMColorScaler_algo algo, int sw, int sh, int dw,int dh,ADM_colorspace from,ADM_colorspace to)
 {
+    cleanupBands();
     if(context) sws_freeContext(CONTEXT);
     context=NULL;
     this->algo=algo;
@@ -336,8 +393,224 @@ bool  ADMColorScalerFull::reset(ADMColorScaler_algo algo, int sw, int sh, int dw
                       dstWidth,dstHeight,
                       lavTo,
                       flags, NULL, NULL,NULL);
+    if(threaded)
+        setupBands(flags);
+    return true;
+}
+/**
+    \fn setThreaded
+    \brief Enable / disable band splitting, the contexts are rebuilt if needed
+*/
+bool ADMColorScalerFull::setThreaded(bool onoff)
+{
+    if(onoff==threaded) return true;
+    threaded=onoff;
+    return reset(algo,srcWidth,srcHeight,dstWidth,dstHeight,fromColor,toColor);
+}
+
+/**
+    \fn filterRadius
+    \brief Half width of the vertical filter, in source lines, for a 1:1 ratio
+*/
+static int filterRadius(ADMColorScaler_algo algo)
+{
+    switch(algo)
+    {
+        case ADM_CS_FAST_BILINEAR:
+        case ADM_CS_BILINEAR:   return 1;
+        case ADM_CS_BICUBIC:
+        case ADM_CS_BICUBLIN:   return 2;
+        case ADM_CS_LANCZOS:    return 3;
+        case ADM_CS_GAUSS:      return 4;
+        case ADM_CS_SINC:
+        case ADM_CS_SPLINE:     return 20;
+        default: break;
+    }
+    return 20;
+}
+/**
+    \fn gcd
+*/
+static int gcd(int a,int b)
+{
+    while(b)
+    {
+        int t=a%b;
+        a=b;
+        b=t;
+    }
+    return a;
+}
+/**
+    \fn planeShift
+    \brief Vertical subsampling of plane "plane" for that pixel format
+*/
+static int planeShift(const AVPixFmtDescriptor *desc,int plane)
+{
+    if(plane==1 || plane==2) return desc->log2_chroma_h;
+    return 0;
+}
+/**
+    \fn scale
+    \brief Convert the whole image, spread over the thread pool if bands are available
+*/
+bool ADMColorScalerFull::scale(uint8_t **srcData, int *srcStride, uint8_t **dstData, int *dstStride)
+{
+    if(!bands)
+    {
+        sws_scale(CONTEXT,srcData,srcStride,0,srcHeight,dstData,dstStride);
+        return true;
+    }
+    scalerJob job;
+    job.bands=BANDS;
+    job.srcData=srcData;
+    job.srcStride=srcStride;
+    job.dstData=dstData;
+    job.dstStride=dstStride;
+    return ADM_threadPool::getInstance()->run(BANDS->nbBands,scaleBand,&job);
+}
+/**
+    \fn setupBands
+    \brief Create one context per band of the destination.
+            Source and destination heights are cut in "units" of p source lines / q destination lines,
+            p/q being the reduced scaling ratio. Cutting on unit boundaries keeps the sampling position
+            of every destination line identical to the one of the full frame context.
+            Heights without a usable common divisor stay single threaded.
+*/
+bool ADMColorScalerFull::setupBands(int flags)
+{
+    ADM_threadPool *pool=ADM_threadPool::getInstance();
+    int nbSlices=pool->getNbSlices();
+    if(nbSlices<2) return false;
+    if(srcWidth*srcHeight<ADM_SCALER_MIN_PIXELS_FOR_BANDS && dstWidth*dstHeight<ADM_SCALER_MIN_PIXELS_FOR_BANDS)
+        return false;
+
+    int units=gcd(srcHeight,dstHeight);
+    int p=srcHeight/units;
+    int q=dstHeight/units;
+    // Lines around a band the filter can reach, x2 for subsampled chroma, plus some margin
+    int ratio=(p+q-1)/q;
+    int support=(filterRadius(algo)*ratio+2)*2+2;
+    int pad=(support+p-1)/p;
+    pad=(pad+1)&~1; // band boundaries must stay on even lines for 4:2:0
+    int minUnits=ADM_SCALER_MIN_UNITS_PER_BAND;
+    if(pad>minUnits) minUnits=pad;
+    int nb=units/minUnits;
+    if(nb>nbSlices) nb=nbSlices;
+    if(nb<2) return false;
+
+    AVPixelFormat lavFrom=ADMColor2LAVColor(fromColor);
+    AVPixelFormat lavTo=ADMColor2LAVColor(toColor);
+    const AVPixFmtDescriptor *srcDesc=av_pix_fmt_desc_get(lavFrom);
+    const AVPixFmtDescriptor *dstDesc=av_pix_fmt_desc_get(lavTo);
+    if(!srcDesc || !dstDesc) return false;
+
+    scalerBands *b=new scalerBands;
+    memset(b,0,sizeof(*b));
+    b->nbSrcPlanes=av_pix_fmt_count_planes(lavFrom);
+    b->nbDstPlanes=av_pix_fmt_count_planes(lavTo);
+    av_image_fill_linesizes(b->dstLineSize,lavTo,dstWidth);
+    for(int i=0;i<4;i++)
+    {
+        b->srcShift[i]=planeShift(srcDesc,i);
+        b->dstShift[i]=planeShift(dstDesc,i);
+        b->scratchStride[i]=(b->dstLineSize[i]+63)&~63;
+    }
+    b->band=new scalerBand[nb];
+    memset(b->band,0,sizeof(scalerBand)*nb);
+    b->nbBands=nb;
+    bands=(void *)b;
+
+    for(int i=0;i<nb;i++)
+    {
+        scalerBand *band=b->band+i;
+        int u0=((units*i)/nb)&~1;
+        int u1=(i==nb-1)? units : (((units*(i+1))/nb)&~1);
+        int c0=u0-pad;
+        int c1=u1+pad;
+        if(c0<0) c0=0;
+        if(c1>units) c1=units;
+
+        band->srcStart=c0*p;
+        band->srcLines=(c1-c0)*p;
+        band->dstStart=c0*q;
+        band->keepStart=u0*q;
+        band->keepEnd=u1*q;
+        int dstLines=(c1-c0)*q;
+        band->context=sws_getContext(srcWidth,band->srcLines,lavFrom,
+                                     dstWidth,dstLines,lavTo,
+                                     flags,NULL,NULL,NULL);
+        int total=0;
+        int offsets[4];
+        for(int j=0;j<b->nbDstPlanes;j++)
+        {
+            int shift=b->dstShift[j];
+            offsets[j]=total;
+            total+=b->scratchStride[j]*((dstLines+(1<<shift)-1)>>shift);
+        }
+        band->scratch=(uint8_t *)ADM_alloc(total);
+        if(!band->context || !band->scratch)
+        {
+            ADM_warning("Cannot create scaler band %d, using a single context\n",i);
+            cleanupBands();
+            return false;
+        }
+        for(int j=0;j<4;j++)
+            band->scratchPlanes[j]=(j<b->nbDstPlanes)? band->scratch+offsets[j] : NULL;
+    }
     return true;
 }
+/**
+    \fn cleanupBands
+*/
+void ADMColorScalerFull::cleanupBands(void)
+{
+    if(!bands) return;
+    scalerBands *b=BANDS;
+    for(int i=0;i<b->nbBands;i++)
+    {
+        scalerBand *band=b->band+i;
+        if(band->context) sws_freeContext(band->context);
+        if(band->scratch) ADM_dezalloc(band->scratch);
+    }
+    delete [] b->band;
+    delete b;
+    bands=NULL;
+}
+/**
+    \fn scaleBand
+    \brief Worker side, convert one band then copy the lines it owns to the destination
+*/
+static void scaleBand(void *cookie,int slice)
+{
+    scalerJob *job=(scalerJob *)cookie;
+    scalerBands *b=job->bands;
+    scalerBand *band=b->band+slice;
+    const uint8_t *src[4]={NULL,NULL,NULL,NULL};
+
+    for(int i=0;i<b->nbSrcPlanes && i<4;i++)
+    {
+        if(!job->srcData[i]) continue;
+        src[i]=job->srcData[i]+(band->srcStart>>b->srcShift[i])*job->srcStride[i];
+    }
+    sws_scale(band->context,src,job->srcStride,0,band->srcLines,band->scratchPlanes,b->scratchStride);
+
+    for(int i=0;i<b->nbDstPlanes && i<4;i++)
+    {
+        if(!job->dstData[i]) continue;
+        int shift=b->dstShift[i];
+        int first=band->keepStart>>shift;
+        int last=(band->keepEnd+(1<<shift)-1)>>shift;
+        const uint8_t *in=band->scratchPlanes[i]+(first-(band->dstStart>>shift))*b->scratchStride[i];
+        uint8_t *out=job->dstData[i]+first*job->dstStride[i];
+        for(int y=first;y<last;y++)
+        {
+            memcpy(out,in,b->dstLineSize[i]);
+            in+=b->scratchStride[i];
+            out+=job->dstStride[i];
+        }
+    }
+}
 //------------------------------
 bool            ADMColorScalerSimple::changeWidthHeight(int newWidth, int newHeight)
 {
@@ -52,6 +52,7 @@ ADMImage::ADMImage(uint32_t width, uint32_t height,ADM_IMAGE_TYPE type)
             imgMaxNb=imgCurNb;
         _noPicture=0;
         _colorspace=ADM_COLOR_YV12;
+        _bitDepth=8;
         Pts=0;
         _imageType=type;
         quant=NULL;
@@ -170,10 +171,19 @@ bool BitBlit(uint8_t *dst, uint32_t pitchDst,uint8_t *src,uint32_t pitchSrc,uint
     \brief ctor
 
 */
-ADMImageDefault::ADMImageDefault(uint32_t w, uint32_t h) : ADMImage(w,h,ADM_IMAGE_DEFAULT)
+ADMImageDefault::ADMImageDefault(uint32_t w, uint32_t h, uint32_t bitDepth) : ADMImage(w,h,ADM_IMAGE_DEFAULT)
 {
-    uint32_t pitch=(w+31)&(~31);
-    uint32_t allocatedHeight=(h+31)&(~31);
+    _bitDepth=bitDepth;
+    allocate();
+}
+/**
+    \fn allocate
+    \brief The pitch is in bytes, 2 bytes per sample above 8 bits
+*/
+void ADMImageDefault::allocate(void)
+{
+    uint32_t pitch=(_width*GetBytesPerSample()+31)&(~31);
+    uint32_t allocatedHeight=(_height+31)&(~31);
     data.setSize(32+(pitch*allocatedHeight*3)/2);
     _planes[0]=data.at(0);
     _planes[1]=data.at(pitch*allocatedHeight);
@@ -182,6 +192,24 @@ ADMImageDefault::ADMImageDefault(uint32_t w, uint32_t h) : ADMImage(w,h,ADM_IMAG
     _planeStride[1]=pitch/2;
     _planeStride[2]=pitch/2;
 }
+/**
+    \fn setBitDepth
+    \brief Reallocate only when going from 8 bits to more or back
+*/
+bool ADMImageDefault::setBitDepth(uint32_t depth)
+{
+    if(depth<8 || depth>16)
+        return false;
+    bool realloc=(depth>8)!=(_bitDepth>8);
+    _bitDepth=depth;
+    if(realloc)
+    {
+        hwDecRefCount();
+        data.clean();
+        allocate();
+    }
+    return true;
+}
 /**
     \fn ADMImageDefault
     \brief dtor
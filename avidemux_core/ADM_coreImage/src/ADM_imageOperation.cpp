@@ -33,6 +33,7 @@ bool ADMImage::duplicateMacro(ADMImage *src,bool swap)
         hwDecRefCount(); // free hw ref image if any..
         if(src->refType==ADM_HW_NONE)
         {
+            // We keep our own bit depth, converting if the source has a different one
             for(int plane=PLANAR_Y;plane<PLANAR_LAST;plane++)
             {
                 source=src->GetReadPtr((ADM_PLANE)plane);
@@ -46,11 +47,16 @@ bool ADMImage::duplicateMacro(ADMImage *src,bool swap)
                     opHeight>>=1;
                     opWidth>>=1;
                 }
-                BitBlit(dest, destStride,source,sourceStride,opWidth, opHeight);
+                if(src->_bitDepth==_bitDepth)
+                    BitBlit(dest, destStride,source,sourceStride,opWidth*GetBytesPerSample(), opHeight);
+                else
+                    convertPlaneDepth(dest,destStride,_bitDepth,source,sourceStride,src->_bitDepth,opWidth,opHeight);
             }
         }
          else // it is a hw surface
         {
+            if(_bitDepth!=8) // they are always downloaded as 8 bits
+                setBitDepth(8);
             refType                    =src->refType;
             refDescriptor.refHwImage   =src->refDescriptor.refHwImage;
             refDescriptor.refCodec     =src->refDescriptor.refCodec;
@@ -117,6 +123,18 @@ bool ADMImage::blacken(void)
                 opWidth>>=1;
                 color=128;
             }
+            if(isHighBitDepth())
+            {
+                uint16_t color16=color<<(_bitDepth-8);
+                for(int y=0;y<opHeight;y++)
+                {
+                    uint16_t *d=(uint16_t *)dest;
+                    for(int x=0;x<opWidth;x++)
+                        d[x]=color16;
+                    dest+=destStride;
+                }
+                continue;
+            }
             for(int y=0;y<opHeight;y++)
             {
                 memset(dest,color,opWidth);
@@ -94,9 +94,81 @@ bool ADMImage::copyPlane(ADMImage *s, ADMImage *d, ADM_PLANE plane)
             w>>=1;
             h>>=1;
         }
-        BitBlit(dst,dPitch,src,sPitch,w,h);
+        if(s->_bitDepth!=d->_bitDepth)
+            return convertPlaneDepth(dst,dPitch,d->_bitDepth,src,sPitch,s->_bitDepth,w,h);
+        BitBlit(dst,dPitch,src,sPitch,w*s->GetBytesPerSample(),h);
         return true;
 }
+/**
+    \fn convertPlaneDepth
+    \brief Change the number of bits per sample of one plane, 8 bits samples are bytes, the others little endian uint16_t
+*/
+bool ADMImage::convertPlaneDepth(uint8_t *dst,uint32_t dstPitch,uint32_t dstDepth,
+                                 uint8_t *src,uint32_t srcPitch,uint32_t srcDepth,
+                                 uint32_t width,uint32_t height)
+{
+    if(srcDepth<8 || srcDepth>16 || dstDepth<8 || dstDepth>16)
+        return false;
+    if(srcDepth==dstDepth)
+    {
+        BitBlit(dst,dstPitch,src,srcPitch,width*((srcDepth>8)? 2 : 1),height);
+        return true;
+    }
+    if(srcDepth==8) // Up, dstDepth>8
+    {
+        int shift=dstDepth-8;
+        for(int y=0;y<height;y++)
+        {
+            uint16_t *d=(uint16_t *)dst;
+            for(int x=0;x<width;x++)
+                d[x]=src[x]<<shift;
+            src+=srcPitch;
+            dst+=dstPitch;
+        }
+        return true;
+    }
+    if(dstDepth==8) // Down, rounded
+    {
+        int shift=srcDepth-8;
+        int round=1<<(shift-1);
+        for(int y=0;y<height;y++)
+        {
+            uint16_t *s=(uint16_t *)src;
+            for(int x=0;x<width;x++)
+            {
+                int v=(s[x]+round)>>shift;
+                dst[x]=(v>255)? 255 : v;
+            }
+            src+=srcPitch;
+            dst+=dstPitch;
+        }
+        return true;
+    }
+    // 16 bits to 16 bits
+    int maxValue=(1<<dstDepth)-1;
+    for(int y=0;y<height;y++)
+    {
+        uint16_t *s=(uint16_t *)src;
+        uint16_t *d=(uint16_t *)dst;
+        if(dstDepth>srcDepth)
+        {
+            for(int x=0;x<width;x++)
+                d[x]=s[x]<<(dstDepth-srcDepth);
+        }else
+        {
+            int shift=srcDepth-dstDepth;
+            int round=1<<(shift-1);
+            for(int x=0;x<width;x++)
+            {
+                int v=(s[x]+round)>>shift;
+                d[x]=(v>maxValue)? maxValue : v;
+            }
+        }
+        src+=srcPitch;
+        dst+=dstPitch;
+    }
+    return true;
+}
 /**
     \fn convertFromYUV444
 */
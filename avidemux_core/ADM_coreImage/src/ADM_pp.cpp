@@ -27,6 +27,24 @@ extern "C" {
 #include "ADM_image.h"
 #include "ADM_imageFlags.h"
 #include "ADM_pp.h"
+#include "ADM_threadPool.h"
+
+/**
+    \struct ppJob
+    \brief One frame, split in bands then strips around the band boundaries
+*/
+typedef struct
+{
+    ADM_PP          *me;
+    const uint8_t   *src[3];
+    int             srcStride[3];
+    uint8_t         *dst[3];
+    int             dstStride[3];
+    int             width;
+    int8_t          *quant;
+    int             qStride;
+    int             type;
+}ppJob;
 
 
 #define aprintf ADM_info
@@ -49,6 +67,14 @@ bool ADM_PP::cleanup(void)
 	 aprintf("Deleting post proc\n");
 	 if(ppMode) {pp_free_mode(ppMode);ppMode=NULL;}
 	 if(ppContext) {pp_free_context(ppContext);ppContext=NULL;}
+     for(int i=0;i<nbBands;i++)
+     {
+         if(bandContext[i]) pp_free_context(bandContext[i]);
+         if(stripContext[i]) pp_free_context(stripContext[i]);
+         bandContext[i]=stripContext[i]=NULL;
+     }
+     nbBands=0;
+     if(stripBuffer) {ADM_dezalloc(stripBuffer);stripBuffer=NULL;}
      return true;
 }
 
@@ -86,6 +112,10 @@ char stringMode[60];
 		{
 		uint32_t ppCaps=0;
 		
+#ifdef PP_CPU_CAPS_AUTO
+        // Let libpostproc pick the best code for this cpu, including what CpuCaps does not know about
+        ppCaps=PP_CPU_CAPS_AUTO;
+#else
 #ifdef ADM_CPU_X86
 		
 	#define ADD(x,y) if( CpuCaps::has##x()) ppCaps|=PP_CPU_CAPS_##y;
@@ -97,10 +127,12 @@ char stringMode[60];
 #ifdef ADM_CPU_ALTIVEC
 		ppCaps|=PP_CPU_CAPS_ALTIVEC;
 #endif	
+#endif
 			ppContext=pp_get_context(w, h, ppCaps  );		
 			ppMode=pp_get_mode_by_name_and_quality(
 			stringMode, postProcStrength);;
 			ADM_assert(ppMode);
+            setupBands(w-(w&7),h&(~1),ppCaps);
 			aprintf("Enabled type:%d strength:%d\n",postProcType,postProcStrength);
 		}	   
 	else    // if nothing is selected we may as well set back every thing to 0
@@ -110,10 +142,95 @@ char stringMode[60];
 		}
     return false;
 }
+/**
+    \fn setupBands
+    \brief Split the image in bands of at least ADM_PP_MIN_BAND_LINES lines, one per slice of the thread pool.
+            Each band and each strip has its own context, a context cannot be used by 2 threads at once.
+            The filters of a block row read the already filtered rows above, a difference at the top of a band
+            fades out within ADM_PP_STRIP_KEEP lines (at most 28 lines measured), except when deinterlacing feeds
+            the vertical deblocking: then it can run down the whole picture and the bands are not used.
+*/
+bool ADM_PP::setupBands(int ww, int hh, uint32_t ppCaps)
+{
+    if((postProcType&2) && (postProcType&8))
+        return false;
+    int nb=ADM_threadPool::getInstance()->getNbSlices();
+    if(nb>hh/ADM_PP_MIN_BAND_LINES) nb=hh/ADM_PP_MIN_BAND_LINES;
+    if(nb>ADM_PP_MAX_BANDS) nb=ADM_PP_MAX_BANDS;
+    if(nb<2)
+        return false;
+    int mbRows=hh>>4;
+    for(int i=0;i<nb;i++)
+        bandStart[i]=((mbRows*i)/nb)<<4;
+    bandStart[nb]=hh;
+    for(int i=0;i<nb;i++)
+    {
+        bandContext[i]=pp_get_context(ww,bandStart[i+1]-bandStart[i],ppCaps);
+        stripContext[i]=NULL;
+        if(i) stripContext[i]=pp_get_context(ww,ADM_PP_STRIP_LINES,ppCaps);
+    }
+    stripStride=(ww+63)&~63;
+    stripBuffer=(uint8_t *)ADM_alloc(nb*stripStride*ADM_PP_STRIP_LINES*2);
+    nbBands=nb;
+    aprintf("Postproc split in %d bands\n",nb);
+    return true;
+}
+/**
+    \fn runArea
+    \brief Postprocess lines y to y+lines of the source, to the same lines of dst if offsetDst, else to the top of dst
+*/
+static void runArea(void *context,void *mode,ppJob *job,int y,int lines,uint8_t **dst,int *dstStride,bool offsetDst)
+{
+    const uint8_t *src[3];
+    uint8_t *out[3];
+    for(int i=0;i<3;i++)
+    {
+        int yy=i? y>>1 : y;
+        src[i]=job->src[i]+yy*job->srcStride[i];
+        out[i]=dst[i]+(offsetDst? yy*dstStride[i] : 0);
+    }
+    int8_t *quant=job->quant;
+    if(quant)
+        quant+=(y>>4)*job->qStride;
+    pp_postprocess(src,job->srcStride,out,dstStride,job->width,lines,quant,job->qStride,
+                   mode,context,job->type);
+}
+/**
+    \fn processSlice
+    \brief Slices 0..nbBands-1 process a band straight to the destination.
+            The next ones process the strip around a band boundary to the strip buffer,
+            the boundary is not filtered when the bands are processed separately.
+*/
+void ADM_PP::processSlice(void *cookie, int slice)
+{
+    ppJob *job=(ppJob *)cookie;
+    if(slice<nbBands)
+    {
+        runArea(bandContext[slice],ppMode,job,bandStart[slice],bandStart[slice+1]-bandStart[slice],job->dst,job->dstStride,true);
+        return;
+    }
+    int boundary=slice-nbBands+1;
+    uint8_t *strip[3];
+    int stride[3]={stripStride,stripStride/2,stripStride/2};
+    strip[0]=stripBuffer+(boundary-1)*stripStride*ADM_PP_STRIP_LINES*2;
+    strip[1]=strip[0]+stripStride*ADM_PP_STRIP_LINES;
+    strip[2]=strip[1]+(stripStride/2)*(ADM_PP_STRIP_LINES/2);
+    runArea(stripContext[boundary],ppMode,job,bandStart[boundary]-ADM_PP_STRIP_LINES/2,ADM_PP_STRIP_LINES,strip,stride,false);
+}
+
+static void ppWorker(void *cookie,int slice)
+{
+    ppJob *job=(ppJob *)cookie;
+    job->me->processSlice(job,slice);
+}
+
 /**
     \fn process
+    \brief The bands are only used if the thread pool is free, else a single call on the whole frame
+            is cheaper than running the bands and strips one after the other.
+            Both give the same result, avidemux_bench --only postproc checks it.
 */
-bool        ADM_PP::process(class ADMImage *src, class ADMImage *dest)
+bool        ADM_PP::process(class ADMImage *src, class ADMImage *dest, bool useBands)
 {
 int type;
 
@@ -167,6 +284,41 @@ uint32_t border;
             iStrideTab2[i]=strideTab2[i];
             xBuff[i]=iBuff[i];
         }
+        bool banded=false;
+        if(nbBands && useBands)
+        {
+            ppJob job;
+            job.me=this;
+            for(int i=0;i<3;i++)
+            {
+                job.src[i]=xBuff[i];
+                job.srcStride[i]=iStrideTab[i];
+                job.dst[i]=oBuff[i];
+                job.dstStride[i]=iStrideTab2[i];
+            }
+            job.width=ww;
+            job.quant=(int8_t *)(src->quant);
+            job.qStride=src->_qStride;
+            job.type=type;
+            banded=ADM_threadPool::getInstance()->tryRun(2*nbBands-1,ppWorker,&job);
+            // Keep the middle of the strips, the lines the boundary filters modify.
+            // The chroma blocks are twice as high, the same number of lines is kept in each plane.
+            for(int b=1;banded && b<nbBands;b++)
+            {
+                uint8_t *strip=stripBuffer+(b-1)*stripStride*ADM_PP_STRIP_LINES*2;
+                int y=bandStart[b];
+                int k=ADM_PP_STRIP_KEEP;
+                int mid=ADM_PP_STRIP_LINES/2;
+                BitBlit(oBuff[0]+(y-k)*iStrideTab2[0],iStrideTab2[0],strip+(mid-k)*stripStride,stripStride,ww,2*k);
+                uint8_t *u=strip+stripStride*ADM_PP_STRIP_LINES;
+                uint8_t *v=u+(stripStride/2)*(ADM_PP_STRIP_LINES/2);
+                mid>>=1;
+                y>>=1;
+                BitBlit(oBuff[1]+(y-k)*iStrideTab2[1],iStrideTab2[1],u+(mid-k)*(stripStride/2),stripStride/2,ww/2,2*k);
+                BitBlit(oBuff[2]+(y-k)*iStrideTab2[2],iStrideTab2[2],v+(mid-k)*(stripStride/2),stripStride/2,ww/2,2*k);
+            }
+        }
+        if(!banded)
         pp_postprocess(
             xBuff,
             iStrideTab,
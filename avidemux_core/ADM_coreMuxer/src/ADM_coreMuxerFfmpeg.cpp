@@ -24,6 +24,7 @@
 #include "ADM_muxerUtils.h"
 #include "ADM_coreCodecMapping.h"
 #include "ADM_audioXiphUtils.h"
+#include "ADM_trace.h"
 
 extern "C" {
 #include "libavformat/url.h"
@@ -63,6 +64,7 @@ bool muxerFFmpeg::writePacket(AVPacket *pkt)
         printf("Track :%d size :%d PTS:%"PRId64" DTS:%"PRId64"\n",
                     pkt->stream_index,pkt->size,pkt->pts,pkt->dts);
 #endif
+    ADM_TRACE_SCOPE("mux","write");
     int ret =av_write_frame(oc, pkt);
     if(ret)
         return false;
@@ -499,15 +501,18 @@ bool muxerFFmpeg::saveLoop(const char *title)
         audioPackets[i].clock=new audioClock(aStreams[i]->getInfo()->frequency);
     ADMBitstream out(bufSize);
     out.data=buffer;
+    out.acceptRef=true; // the packet is written before the next one is requested
 
     while(gotVideoPacket)
     {
-        gotVideoPacket=vStream->getPacket(&out);
+        {
+            ADM_TRACE_SCOPE("mux","get video packet");
+            gotVideoPacket=vStream->getPacket(&out);
+        }
         uint64_t maxAudioDts;
         if(gotVideoPacket)
         {
-            encoding->refresh();
-            if(!encoding->isAlive())
+            if(false==updateUI())
             {
                 result=false;
                 break;
@@ -555,11 +560,16 @@ bool muxerFFmpeg::saveLoop(const char *title)
                     if(audioTrack->eof==true) break; // no more packet for this track
                     if(audioTrack->present==false)
                     {
-                        if(false==a->getPacket(audioTrack->buffer,
+                        bool gotAudioPacket;
+                        {
+                            ADM_TRACE_SCOPE("mux","get audio packet");
+                            gotAudioPacket=a->getPacket(audioTrack->buffer,
                                             &(audioTrack->size),
                                             AUDIO_BUFFER_SIZE,
                                             &(audioTrack->samples),
-                                            &(audioTrack->dts)))
+                                            &(audioTrack->dts));
+                        }
+                        if(false==gotAudioPacket)
                         {
                             audioTrack->eof=true;
                             ADM_info("No more audio packets for audio track %d\n",audio);
@@ -651,7 +661,7 @@ bool muxerFFmpeg::saveLoop(const char *title)
             pkt.pts=pkt.dts;
         }
         pkt.stream_index=0;
-        pkt.data = buffer;
+        pkt.data = out.data;
         pkt.size = out.len;
         if(out.flags & 0x10) // FIXME AVI_KEY_FRAME
             pkt.flags |= AV_PKT_FLAG_KEY;
@@ -669,6 +679,7 @@ bool muxerFFmpeg::saveLoop(const char *title)
         }
         written++;
     }
+    out.releaseRef();
     delete [] buffer;
     if(false==ret)
     {
@@ -18,6 +18,7 @@
 #include "ADM_muxerUtils.h"
 #include "fourcc.h"
 #include "ADM_vidMisc.h"
+#include "ADM_stageStats.h"
 
 /**
     \fn rescaleFps
@@ -109,6 +110,9 @@ bool     ADM_muxer::updateUI(void)
 {
             ADM_assert(encoding);
             encoding->refresh();
+            std::string slowest;
+            if(ADM_stageStatsSlowest(slowest,1000))
+                encoding->setSlowestStage(slowest.c_str());
             if(!encoding->isAlive()) 
             {
                 ADM_info("[coreMuxer]Stop request\n");
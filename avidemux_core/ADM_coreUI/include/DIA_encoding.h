@@ -83,6 +83,7 @@ public:
                 virtual void pushAudioFrame(uint32_t size);
                 virtual void refresh(bool force=false);
                 virtual void keepOpen(void) {};
+                virtual void setSlowestStage(const char *n) {};
 };
 //********************
 ADM_COREUI6_EXPORT DIA_encodingBase *createEncoding(uint64_t duration);
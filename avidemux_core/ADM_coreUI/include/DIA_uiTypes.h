@@ -28,6 +28,11 @@
 
 #define ADM_FEATURE_MASK   (ADM_FEATURE_VDPAU+ADM_FEATURE_LIBVA+ADM_FEATURE_OPENGL)
 
+// Not needed but supported by the filter
+#define ADM_CAPABILITY_HIGH_BITDEPTH 256 // Accepts and outputs images with more than 8 bits per sample
+
+#define ADM_CAPABILITY_MASK (ADM_CAPABILITY_HIGH_BITDEPTH)
+
 
 #define ADM_UI_ALL (ADM_UI_CLI+ADM_UI_GTK+ADM_UI_QT4)
 typedef  int  ADM_UI_TYPE;
@@ -20,14 +20,33 @@
 #define ADM_NO_TIMING 0xffffffff
 
 #include "ADM_coreUtils6_export.h"
+#include <atomic>
 
 /*
     BIG WARNING : BUFFER SIZE MUST BE SET: SOME CODECS CHECK& USE IT
     ESPECIALLY LAVCODEC!
 */
+/**
+    \class ADM_bitstreamRef
+    \brief Owner of an encoded payload handed by reference instead of being copied in ADMBitstream::data.
+            Deleted when the last reference is released, producers derive from it to free their memory.
+            The base class owns nothing, it is used for memory the producer keeps until its next packet.
+*/
+class ADM_COREUTILS6_EXPORT ADM_bitstreamRef
+{
+    protected:
+        std::atomic<int> count;
+    public:
+                 ADM_bitstreamRef() {count=1;}
+        virtual ~ADM_bitstreamRef() {}
+        void     addRef(void) {count++;}
+        void     release(void) {if(!--count) delete this;}
+};
 /**
     \class ADMBitstream
-
+    \brief If the consumer sets acceptRef, the producer may point data to its own memory (setRef)
+            instead of copying into the buffer. data is then valid until releaseRef, which the
+            producer calls at the latest when it is asked for the next packet.
 */
 class ADM_COREUTILS6_EXPORT ADMBitstream
 {
@@ -40,10 +59,15 @@ class ADM_COREUTILS6_EXPORT ADMBitstream
         uint32_t out_quantizer;         // Quantizer of the image, in case of encoding the real Q
         uint64_t pts;			        // in us
         uint64_t dts;			        // in us
+        bool     acceptRef;             // Set by the consumer
+        ADM_bitstreamRef *ref;          // Set by the producer, data points inside it
+        uint8_t *ownData;               // The consumer buffer while data points inside ref
 
         ADMBitstream (uint32_t buffersize=0);
         ~ADMBitstream ();
         void cleanup (uint32_t dts);
+        void setRef(ADM_bitstreamRef *r,uint8_t *payload,uint32_t payloadLen); // only if acceptRef
+        void releaseRef(void);                                                  // data is the consumer buffer again
 
 };
 #endif
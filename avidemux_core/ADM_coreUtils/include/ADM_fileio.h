@@ -17,8 +17,29 @@
 #ifndef ADM_FILE_IO
 #define ADM_FILE_IO
 
+#include <pthread.h>
 #include "ADM_coreUtils6_export.h"
 
+#define ADM_FILE_RING_SIZE 4
+
+/**
+    \struct ADMFileSlot
+    \brief One buffer waiting to be written by the write-behind thread
+*/
+typedef struct
+{
+        uint8_t         *data;
+        uint32_t        size;
+        uint64_t        offset;
+}ADMFileSlot;
+
+/**
+    \class ADMFile
+    \brief Buffered output file. In write-behind mode the buffers are written by a separate thread
+            so that the caller (muxer) never waits for the disk, unless the whole ring is full.
+            Each buffer carries its file offset, seeking back to patch headers is safe.
+            Small flushes, i.e. header patches, are written directly once the ring is empty.
+*/
 class ADM_COREUTILS6_EXPORT ADMFile
 {
 protected:
@@ -26,10 +47,29 @@ protected:
         uint32_t        _fill;
         uint8_t         *_buffer;	  
         uint64_t        _curPos;
+        uint32_t        _bufferSize;
+        // Write-behind
+        bool            _async;
+        bool            _asyncError;
+        bool            _quit;
+        pthread_t       _writer;
+        pthread_mutex_t _lock;
+        pthread_cond_t  _wakeWriter;
+        pthread_cond_t  _wakeCaller;
+        ADMFileSlot     _ring[ADM_FILE_RING_SIZE];
+        uint32_t        _ringHead,_ringCount;
+        uint8_t         *_spare[ADM_FILE_RING_SIZE];
+        uint32_t        _nbSpare;
+        uint64_t        _filePos;       // writer side
+        uint64_t        _allocated;     // writer side, preallocated up to there
+
+static  void            *writerEntry(void *me);
+        void            writerLoop(void);
+        bool            stopWriter(void);
 public:
                         ADMFile();
                         ~ADMFile();
-        uint8_t         open(FILE *in);
+        uint8_t         open(FILE *in,bool writeBehind=false);
         uint8_t         write(const uint8_t *in, uint32_t size);
         uint8_t         flush(void);
         uint8_t         seek(uint64_t where);
@@ -0,0 +1,86 @@
+/***************************************************************************
+    \file ADM_packetPrefetch.h
+    \brief Read compressed packets ahead on a separate thread (copy mode)
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#pragma once
+#include "ADM_coreUtils6_export.h"
+#include "ADM_stageStats.h"
+#include "ADM_threads.h"
+#include <deque>
+
+#define ADM_PREFETCH_MAX_PACKETS 64
+#define ADM_PREFETCH_MAX_BYTES   (32*1024*1024)
+
+/**
+    \struct ADM_prefetchPacket
+    \brief Description of one packet, the fields not relevant to the stream are left alone
+*/
+typedef struct
+{
+    uint32_t    len;
+    uint32_t    flags;      // video
+    uint32_t    samples;    // audio
+    uint64_t    pts;
+    uint64_t    dts;
+}ADM_prefetchPacket;
+
+/**
+    Read the next packet in buffer, return false at the end of the stream or on error
+*/
+typedef bool ADM_packetReader(void *cookie,uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet);
+
+/**
+    \class ADM_packetPrefetch
+    \brief Call reader on its own thread and keep up to ADM_PREFETCH_MAX_PACKETS packets
+            (or ADM_PREFETCH_MAX_BYTES) in advance.
+            The packets are read in place into a ring buffer allocated once, the caller
+            copies them from there to its own buffer.
+            The reader must only be used by this thread while the object exists,
+            the cookie must outlive it.
+*/
+class ADM_COREUTILS6_EXPORT ADM_packetPrefetch
+{
+protected:
+        typedef struct
+        {
+            ADM_prefetchPacket  info;
+            uint32_t            offset;     // in ring
+        }queuedPacket;
+
+        const char              *name;
+        ADM_packetReader        *reader;
+        void                    *cookie;
+        uint8_t                 *ring;
+        uint32_t                ringSize;
+        uint32_t                maxPacket;  // room the reader gets for each packet
+        uint32_t                writeOffset;// end of the last queued packet
+        std::deque <queuedPacket> queue;    // the caller only pops the front once copied out
+        bool                    eof;
+        bool                    quit;
+        bool                    running;
+        pthread_t               thread;
+        admMutex                *lock;
+        admCond                 *wakeReader;
+        admCond                 *wakeCaller;
+        ADM_stageStats          *readStats;
+        ADM_stageStats          *queueStats;
+
+static  void                    *readerEntry(void *me);
+        void                    readerLoop(void);
+        bool                    reserve(uint32_t *offset);
+public:
+                                ADM_packetPrefetch(const char *name,ADM_packetReader *reader,void *cookie,uint32_t bufferSize);
+                                ~ADM_packetPrefetch();
+        bool                    getPacket(uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet);
+};
+// EOF
@@ -0,0 +1,90 @@
+/***************************************************************************
+    \file ADM_stageStats.h
+    \brief Per stage timing of an export (decode, each filter, encode, audio, mux)
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#pragma once
+#include "ADM_coreUtils6_export.h"
+#include "ADM_threads.h"
+#include "ADM_clock.h"
+#include <string>
+
+/**
+    \struct ADM_stageSnapshot
+    \brief Copy of the counters of one stage
+*/
+typedef struct
+{
+    std::string name;
+    uint64_t    selfUs;         /// Time spent in the stage itself, not in the stages it pulls from
+    uint32_t    calls;
+    uint32_t    frames;         /// Calls that returned something
+    uint32_t    queueSize;      /// 0 if the stage is not a queue
+    uint32_t    queueMax;
+    float       queueAverage;   /// Average number of items in the queue when the consumer asked for one
+    uint32_t    starved;        /// Times the consumer had to wait for the producer
+    uint32_t    blocked;        /// Times the producer had to wait for a free slot
+}ADM_stageSnapshot;
+
+/**
+    \class ADM_stageStats
+    \brief Counters of one stage, can be updated from any thread
+*/
+class ADM_COREUTILS6_EXPORT ADM_stageStats
+{
+protected:
+        admMutex    lock;
+        std::string name;
+        uint64_t    selfUs;
+        uint32_t    calls;
+        uint32_t    frames;
+        uint32_t    queueSize;
+        uint32_t    queueMax;
+        uint64_t    queueSum;
+        uint32_t    queueSamples;
+        uint32_t    starved;
+        uint32_t    blocked;
+public:
+                    ADM_stageStats(const char *name);
+        const char  *getName(void) {return name.c_str();}
+        void        addCall(uint64_t us,bool gotFrame);
+        void        setQueueSize(uint32_t size);
+        void        sampleQueue(uint32_t depth);
+        void        addStarved(void);
+        void        addBlocked(void);
+        void        snapshot(ADM_stageSnapshot *s);
+};
+
+/**
+    \class ADM_stageTimer
+    \brief Measure the time spent in a stage minus the time spent in the stages it calls,
+            as long as they are on the same thread and timed too.
+*/
+class ADM_COREUTILS6_EXPORT ADM_stageTimer
+{
+protected:
+        Clock       clk;
+        uint64_t    nestedBefore;
+public:
+                    ADM_stageTimer();
+        uint64_t    stop(void);     /// Returns the time spent in this stage only, in us
+};
+
+// Collection is only active during an export, stages created outside of it are NULL
+ADM_COREUTILS6_EXPORT void              ADM_stageStatsStart(void);
+ADM_COREUTILS6_EXPORT void              ADM_stageStatsStop(void);
+ADM_COREUTILS6_EXPORT bool              ADM_stageStatsActive(void);
+ADM_COREUTILS6_EXPORT ADM_stageStats    *ADM_stageStatsCreate(const char *name);
+ADM_COREUTILS6_EXPORT bool              ADM_stageStatsSlowest(std::string &description,uint32_t minIntervalMs);
+ADM_COREUTILS6_EXPORT void              ADM_stageStatsDump(void);
+ADM_COREUTILS6_EXPORT bool              ADM_stageStatsWriteJson(const char *file);
+// EOF
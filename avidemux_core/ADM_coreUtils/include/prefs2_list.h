@@ -20,6 +20,11 @@ FEATURES_CAP_REFRESH_ENABLED, 	//bool
 FEATURES_CAP_REFRESH_VALUE, 	//uint32_t
 FEATURES_SDLDRIVER, 	//string
 FEATURES_USE_LAST_READ_DIR_AS_TARGET, 	//bool
+FEATURES_WRITE_BEHIND, 	//bool
+FEATURES_SAVE_EXPORT_STATS, 	//bool
+FEATURES_SAVE_EXPORT_TRACE, 	//bool
+FEATURES_REUSE_ENCODED_CHUNKS, 	//bool
+FEATURES_CACHE_FIRST_PASS, 	//bool
 KEYBOARD_SHORTCUTS_USE_ALTERNATE_KBD_SHORTCUTS, 	//bool
 KEYBOARD_SHORTCUTS_SWAP_UP_DOWN_KEYS, 	//bool
 KEYBOARD_SHORTCUTS_ALT_MARK_A, 	//string
@@ -53,6 +58,7 @@ PRIORITY_PLAYBACK, 	//uint32_t
 DEFAULT_POSTPROC_TYPE, 	//uint32_t
 DEFAULT_POSTPROC_VALUE, 	//uint32_t
 DEFAULT_DOWNMIXING, 	//uint32_t
+DEFAULT_RESAMPLE_QUALITY, 	//uint32_t
 DEFAULT_LANGUAGE, 	//string
 DEFAULT_WARN_FOR_FONTS, 	//bool
 AVISYNTH_AVISYNTH_ALWAYS_ASK, 	//bool
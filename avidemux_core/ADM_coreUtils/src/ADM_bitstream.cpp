@@ -23,6 +23,32 @@ ADMBitstream::ADMBitstream(uint32_t size)
 }
 ADMBitstream::~ADMBitstream()
 {
+    releaseRef();
+}
+/**
+    \fn setRef
+    \brief Hand payload by reference, takes ownership of r. Only valid if the consumer set acceptRef.
+*/
+void ADMBitstream::setRef(ADM_bitstreamRef *r,uint8_t *payload,uint32_t payloadLen)
+{
+    ADM_assert(acceptRef);
+    releaseRef();
+    ownData=data;
+    ref=r;
+    data=payload;
+    len=payloadLen;
+}
+/**
+    \fn releaseRef
+*/
+void ADMBitstream::releaseRef(void)
+{
+    if(!ref)
+        return;
+    ref->release();
+    ref=NULL;
+    data=ownData;
+    ownData=NULL;
 }
 void ADMBitstream::cleanup (uint32_t framenum)
 {
@@ -14,56 +14,272 @@
 * MODIFIED BY GMV 30.1.05: prepared for ODML
 */
 #include "ADM_cpp.h"
+#include <errno.h>
+#ifdef _WIN32
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+#ifdef __linux__
+#	include <fcntl.h>
+#	include <linux/falloc.h>
+#endif
 #include "ADM_default.h"
 #include "ADM_fileio.h"
 #include "ADM_quota.h"
 
 #define ADM_FILE_BUFFER 4*256*1024 // 256 kB
+#define ADM_FILE_ASYNC_BUFFER (8*1024*1024) // per ring slot
+#define ADM_FILE_PREALLOCATE (64*1024*1024) // reserve disk space by chunks that big
+#define ADM_FILE_NO_PREALLOCATION 0xFFFFFFFFFFFFFFFFULL
+#define ADM_FILE_SYNC_PATCH ADM_FILE_BUFFER // smaller dirty regions (header patches) are not queued
 //#define ADMF_DEBUG
 ADMFile::ADMFile( void)
 {
         _out=NULL;
         _fill=0;
         _curPos=0;
+        _bufferSize=ADM_FILE_BUFFER;
         _buffer=new uint8_t[ADM_FILE_BUFFER];
         ADM_assert(_buffer);
-        
+        _async=false;
+        _asyncError=false;
+        _quit=false;
+        _ringHead=_ringCount=0;
+        _nbSpare=0;
+        _filePos=0;
+        _allocated=0;
 }
 ADMFile::~ADMFile()
 {
         flush();
+        if(_async)
+            stopWriter();
         if(_buffer) 
                 delete [] _buffer;
         _buffer=NULL;
 }
-uint8_t ADMFile::open(FILE *in)
+/**
+    \fn open
+    \param writeBehind if true, the actual writes are done by a separate thread
+*/
+uint8_t ADMFile::open(FILE *in,bool writeBehind)
 {
         ADM_assert(!_out);
         ADM_assert(in);
         _out=in;
         _curPos=ftello(_out);
         _fill=0;
+        if(!writeBehind)
+            return 1;
+        // Switch to big buffers, one being filled + the ring
+        delete [] _buffer;
+        _bufferSize=ADM_FILE_ASYNC_BUFFER;
+        _buffer=new uint8_t[_bufferSize];
+        for(int i=0;i<ADM_FILE_RING_SIZE;i++)
+            _spare[i]=new uint8_t[_bufferSize];
+        _nbSpare=ADM_FILE_RING_SIZE;
+        _ringHead=_ringCount=0;
+        _filePos=_curPos;
+        _allocated=_curPos;
+        _quit=false;
+        _asyncError=false;
+        pthread_mutex_init(&_lock,NULL);
+        pthread_cond_init(&_wakeWriter,NULL);
+        pthread_cond_init(&_wakeCaller,NULL);
+        if(pthread_create(&_writer,NULL,writerEntry,this))
+        {
+            ADM_warning("Cannot start write-behind thread, writing synchronously\n");
+            pthread_mutex_destroy(&_lock);
+            pthread_cond_destroy(&_wakeWriter);
+            pthread_cond_destroy(&_wakeCaller);
+            for(int i=0;i<ADM_FILE_RING_SIZE;i++)
+                delete [] _spare[i];
+            _nbSpare=0;
+            return 1;
+        }
+        _async=true;
+        ADM_info("Write-behind enabled, %d buffers of %d MB\n",ADM_FILE_RING_SIZE,ADM_FILE_ASYNC_BUFFER>>20);
         return 1;
 }
+/**
+    \fn writerEntry
+*/
+void *ADMFile::writerEntry(void *me)
+{
+        ((ADMFile *)me)->writerLoop();
+        pthread_exit(NULL);
+        return NULL;
+}
+/**
+    \fn writerLoop
+    \brief Write the queued buffers in order, each at its own offset.
+            On error the thread stops and leaves the buffer in the ring, the caller will
+            write it again synchronously (and handle the disk full dialog from its own thread).
+*/
+void ADMFile::writerLoop(void)
+{
+        int fd=fileno(_out);
+        while(1)
+        {
+            pthread_mutex_lock(&_lock);
+            while(!_ringCount && !_quit)
+                pthread_cond_wait(&_wakeWriter,&_lock);
+            if(!_ringCount)
+            {
+                pthread_mutex_unlock(&_lock);
+                break;
+            }
+            ADMFileSlot slot=_ring[_ringHead];
+            pthread_mutex_unlock(&_lock);
+
+            if(slot.offset!=_filePos)
+            {
+                fseeko(_out,slot.offset,SEEK_SET);
+                _filePos=slot.offset;
+            }
+#ifdef __linux__
+            if(_allocated!=ADM_FILE_NO_PREALLOCATION && _filePos+slot.size>_allocated)
+            {
+                // Keep the apparent size, only reserve the blocks to limit fragmentation
+                if(fallocate(fd,FALLOC_FL_KEEP_SIZE,_allocated,ADM_FILE_PREALLOCATE))
+                    _allocated=ADM_FILE_NO_PREALLOCATION; // not supported, don't try again
+                else
+                    _allocated+=ADM_FILE_PREALLOCATE;
+            }
+#endif
+            const uint8_t *p=slot.data;
+            uint32_t left=slot.size;
+            bool ok=true;
+            while(left)
+            {
+                int rc=::write(fd,p,left);
+                if(rc>0)
+                {
+                    p+=rc;
+                    left-=rc;
+                    continue;
+                }
+                if(rc==-1 && errno==EINTR)
+                    continue;
+                ok=false;
+                break;
+            }
+            pthread_mutex_lock(&_lock);
+            if(!ok)
+            {
+                ADM_warning("Write-behind: cannot write %u bytes at %" PRIu64" (%d)\n",slot.size,slot.offset,errno);
+                _asyncError=true;
+                pthread_cond_signal(&_wakeCaller);
+                pthread_mutex_unlock(&_lock);
+                break;
+            }
+            _filePos+=slot.size;
+            _spare[_nbSpare++]=slot.data;
+            _ringHead=(_ringHead+1)%ADM_FILE_RING_SIZE;
+            _ringCount--;
+            pthread_cond_signal(&_wakeCaller);
+            pthread_mutex_unlock(&_lock);
+        }
+}
+/**
+    \fn stopWriter
+    \brief Wait for the writer thread to finish, then write what it left synchronously
+*/
+bool ADMFile::stopWriter(void)
+{
+        ADM_assert(_async);
+        pthread_mutex_lock(&_lock);
+        _quit=true;
+        pthread_cond_signal(&_wakeWriter);
+        pthread_mutex_unlock(&_lock);
+        pthread_join(_writer,NULL);
+        _async=false;
+        bool error=_asyncError;
+        while(_ringCount)
+        {
+            ADMFileSlot *slot=_ring+_ringHead;
+            fseeko(_out,slot->offset,SEEK_SET);
+            qfwrite(slot->data,slot->size,1,_out);
+            _spare[_nbSpare++]=slot->data;
+            _ringHead=(_ringHead+1)%ADM_FILE_RING_SIZE;
+            _ringCount--;
+        }
+        for(int i=0;i<_nbSpare;i++)
+            delete [] _spare[i];
+        _nbSpare=0;
+        pthread_mutex_destroy(&_lock);
+        pthread_cond_destroy(&_wakeWriter);
+        pthread_cond_destroy(&_wakeCaller);
+        // Back in synchronous mode, the file position must match ours
+        fseeko(_out,_curPos,SEEK_SET);
+        return !error;
+}
+/**
+    \fn flush
+    \brief In write-behind mode, hand the current buffer over to the writer thread
+            Returns 0 if the data could not be written.
+*/
 uint8_t ADMFile::flush(void)
 {
- ADM_assert(_fill<=ADM_FILE_BUFFER);
-        if(_fill)
+ ADM_assert(_fill<=_bufferSize);
+        if(!_fill)
+            return 1;
+        if(_async && _fill<ADM_FILE_SYNC_PATCH)
         {
-                
-                qfwrite(_buffer,_fill,1,_out);
-                
+            // Not worth a whole slot, write it ourselves once the writer is idle
+            pthread_mutex_lock(&_lock);
+            while(_ringCount && !_asyncError)
+                pthread_cond_wait(&_wakeCaller,&_lock);
+            if(!_asyncError)
+            {
+                fseeko(_out,_curPos,SEEK_SET);
+                bool ok=(qfwrite(_buffer,_fill,1,_out)==_fill); // qfwrite returns bytes
+                fflush(_out); // the writer thread bypasses stdio
                 _curPos+=_fill;
-#ifdef ADMF_DEBUG                
-                printf("Flushing %lu bytes, now at :%lu\n",_fill,_curPos);
-#endif                
+                _filePos=_curPos;
                 _fill=0;
+                pthread_mutex_unlock(&_lock);
+                return ok;
+            }
+            pthread_mutex_unlock(&_lock);
         }
-        return 1;
+        if(_async)
+        {
+            pthread_mutex_lock(&_lock);
+            while(!_nbSpare && !_asyncError)
+                pthread_cond_wait(&_wakeCaller,&_lock);
+            if(!_asyncError)
+            {
+                ADMFileSlot *slot=_ring+((_ringHead+_ringCount)%ADM_FILE_RING_SIZE);
+                slot->data=_buffer;
+                slot->size=_fill;
+                slot->offset=_curPos;
+                _ringCount++;
+                _buffer=_spare[--_nbSpare];
+                pthread_cond_signal(&_wakeWriter);
+                pthread_mutex_unlock(&_lock);
+                _curPos+=_fill;
+                _fill=0;
+                return 1;
+            }
+            pthread_mutex_unlock(&_lock);
+            ADM_warning("Write-behind failed, going back to synchronous writes\n");
+            stopWriter();
+        }
+        bool ok=(qfwrite(_buffer,_fill,1,_out)==_fill); // qfwrite returns bytes
+        _curPos+=_fill;
+#ifdef ADMF_DEBUG                
+        printf("Flushing %lu bytes, now at :%lu\n",_fill,_curPos);
+#endif                
+        _fill=0;
+        return ok;
 }
 uint64_t ADMFile::tell(void)
 {
- ADM_assert(_fill<ADM_FILE_BUFFER);
+ ADM_assert(_fill<_bufferSize);
+        if(_async) // no need to wait for the disk, we know where we are
+            return _curPos+_fill;
 	// MOD Feb 2005 by GMV
 	// uint32_t c;
 	// END MOD Feb 2005 by GMV
@@ -77,9 +293,10 @@ uint64_t ADMFile::tell(void)
 }
 uint8_t ADMFile::seek(uint64_t where)
 {
- ADM_assert(_fill<ADM_FILE_BUFFER);
+ ADM_assert(_fill<_bufferSize);
         flush();
-        fseeko(_out,where,SEEK_SET);
+        if(!_async) // else the writer thread seeks for each buffer
+            fseeko(_out,where,SEEK_SET);
         _curPos=where;
 #ifdef ADMF_DEBUG        
         printf("[%lu] Fseek :%lu \n",this,where);
@@ -100,19 +317,20 @@ uint8_t ADMFile::write(const uint8_t *data,uint32_t how)
 #endif        
         while(1)
         {
-                ADM_assert(_fill<ADM_FILE_BUFFER);
+                ADM_assert(_fill<_bufferSize);
                 oneshot=_fill+how;
-                if(oneshot<ADM_FILE_BUFFER)
+                if(oneshot<_bufferSize)
                 {
                         memcpy(_buffer+_fill,data,how);
                         _fill+=how;
                         return 1;
                 }
                 // copy what's possible
-                oneshot=ADM_FILE_BUFFER-_fill;
+                oneshot=_bufferSize-_fill;
                 memcpy(_buffer+_fill,data,oneshot);
                 _fill+=oneshot;
-                flush();
+                if(!flush())
+                    return 0;
                 data+=oneshot;
                 how-=oneshot;
         }
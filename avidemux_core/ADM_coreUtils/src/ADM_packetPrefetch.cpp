@@ -0,0 +1,238 @@
+/***************************************************************************
+    \file ADM_packetPrefetch.cpp
+    \brief Read compressed packets ahead on a separate thread (copy mode)
+
+    When remuxing, the muxer used to wait for every demuxer read and
+    timestamp fix-up. The packets are now read by a dedicated thread
+    while the muxer writes the previous ones, so that the copy runs at
+    the speed of the storage.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_packetPrefetch.h"
+#include "ADM_trace.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+/**
+    \fn ctor
+    \param name : used for the statistics and the trace, must be a string literal
+    \param bufferSize : largest packet the reader can return
+*/
+ADM_packetPrefetch::ADM_packetPrefetch(const char *name,ADM_packetReader *reader,void *cookie,uint32_t bufferSize)
+{
+    this->name=name;
+    this->reader=reader;
+    this->cookie=cookie;
+    maxPacket=bufferSize;
+    // Room for ADM_PREFETCH_MAX_PACKETS full packets within ADM_PREFETCH_MAX_BYTES, but at least two
+    uint64_t size=(uint64_t)ADM_PREFETCH_MAX_PACKETS*maxPacket;
+    if(size>ADM_PREFETCH_MAX_BYTES)
+        size=ADM_PREFETCH_MAX_BYTES;
+    if(size<2*(uint64_t)maxPacket)
+        size=2*(uint64_t)maxPacket;
+    ringSize=(uint32_t)size;
+    ring=new uint8_t[ringSize];
+    writeOffset=0;
+    eof=false;
+    quit=false;
+    readStats=ADM_stageStatsCreate(name);
+    queueStats=ADM_stageStatsCreate((std::string(name)+" queue").c_str());
+    if(queueStats)
+        queueStats->setQueueSize(ADM_PREFETCH_MAX_PACKETS);
+    lock=new admMutex("packetPrefetch");
+    wakeReader=new admCond(lock);
+    wakeCaller=new admCond(lock);
+    running=!pthread_create(&thread,NULL,readerEntry,this);
+    if(!running)
+    {
+        ADM_warning("Cannot create the %s prefetch thread, reading synchronously\n",name);
+        delete [] ring;
+        ring=NULL;
+    }
+}
+/**
+    \fn dtor
+*/
+ADM_packetPrefetch::~ADM_packetPrefetch()
+{
+    if(running)
+    {
+        lock->lock();
+        quit=true;
+        if(wakeReader->iswaiting())
+            wakeReader->wakeup();
+        lock->unlock();
+        pthread_join(thread,NULL);
+    }
+    queue.clear();
+    delete wakeReader;
+    delete wakeCaller;
+    delete lock;
+    wakeReader=wakeCaller=NULL;
+    lock=NULL;
+    delete [] ring;
+    ring=NULL;
+}
+/**
+    \fn readerEntry
+*/
+void *ADM_packetPrefetch::readerEntry(void *me)
+{
+    ((ADM_packetPrefetch *)me)->readerLoop();
+    return NULL;
+}
+/**
+    \fn reserve
+    \brief Find maxPacket contiguous free bytes in the ring, lock must be held
+            The queued packets go from the front offset to writeOffset, possibly wrapping.
+            When the end of the ring is too short, the next packet starts over at 0.
+*/
+bool ADM_packetPrefetch::reserve(uint32_t *offset)
+{
+    if(queue.size()>=ADM_PREFETCH_MAX_PACKETS)
+        return false;
+    if(!queue.size())
+    {
+        *offset=0;
+        return true;
+    }
+    uint32_t first=queue.front().offset;
+    if(writeOffset>first) // not wrapped
+    {
+        if(ringSize-writeOffset>=maxPacket)
+        {
+            *offset=writeOffset;
+            return true;
+        }
+        if(first>=maxPacket)
+        {
+            *offset=0;
+            return true;
+        }
+        return false;
+    }
+    // Wrapped, the free space is between the last packet and the first one
+    if(first-writeOffset>=maxPacket)
+    {
+        *offset=writeOffset;
+        return true;
+    }
+    return false;
+}
+/**
+    \fn readerLoop
+    \brief Read packets until the end of the stream, waiting when the queue is full
+*/
+void ADM_packetPrefetch::readerLoop(void)
+{
+    ADM_traceSetThreadName((std::string(name)+" prefetch").c_str());
+    lock->lock();
+    while(!quit)
+    {
+        uint32_t offset;
+        if(!reserve(&offset))
+        {
+            if(queueStats)
+                queueStats->addBlocked();
+            ADM_TRACE_INSTANT(name,"full");
+            wakeReader->wait(); // Will unlock mutex
+            lock->lock();
+            continue;
+        }
+        lock->unlock();
+
+        queuedPacket pkt;
+        memset(&(pkt.info),0,sizeof(pkt.info));
+        pkt.offset=offset;
+        bool got;
+        {
+            ADM_TRACE_SCOPE("prefetch",name);
+            ADM_stageTimer timer;
+            got=reader(cookie,ring+offset,maxPacket,&(pkt.info));
+            if(readStats)
+                readStats->addCall(timer.stop(),got);
+        }
+
+        lock->lock();
+        if(!got)
+        {
+            aprintf("[%s prefetch] end of stream\n",name);
+            eof=true;
+            if(wakeCaller->iswaiting())
+                wakeCaller->wakeup();
+            break;
+        }
+        ADM_assert(pkt.info.len<=maxPacket);
+        queue.push_back(pkt);
+        writeOffset=offset+pkt.info.len;
+        ADM_TRACE_COUNTER(name,queue.size());
+        if(wakeCaller->iswaiting())
+            wakeCaller->wakeup();
+    }
+    lock->unlock();
+}
+/**
+    \fn getPacket
+    \brief Copy the next packet in buffer
+    \return false at the end of the stream
+*/
+bool ADM_packetPrefetch::getPacket(uint8_t *buffer,uint32_t bufferSize,ADM_prefetchPacket *packet)
+{
+    if(!running)
+        return reader(cookie,buffer,bufferSize,packet);
+
+    ADM_TRACE_SCOPE("queue wait",name);
+    ADM_stageTimer timer;
+    bool waited=false;
+    lock->lock();
+    while(!queue.size() && !eof)
+    {
+        waited=true;
+        wakeCaller->wait(); // Will unlock mutex
+        lock->lock();
+    }
+    if(!queue.size())
+    {
+        lock->unlock();
+        if(queueStats)
+            queueStats->addCall(timer.stop(),false);
+        return false;
+    }
+    if(queueStats)
+    {
+        queueStats->sampleQueue(queue.size());
+        if(waited)
+            queueStats->addStarved();
+    }
+    // The reader never writes over the front packet, it can be copied out of the lock
+    queuedPacket pkt=queue.front();
+    lock->unlock();
+
+    ADM_assert(pkt.info.len<=bufferSize);
+    memcpy(buffer,ring+pkt.offset,pkt.info.len);
+    *packet=pkt.info;
+
+    lock->lock();
+    queue.pop_front();
+    if(wakeReader->iswaiting())
+        wakeReader->wakeup();
+    lock->unlock();
+    if(queueStats)
+        queueStats->addCall(timer.stop(),true);
+    return true;
+}
+// EOF
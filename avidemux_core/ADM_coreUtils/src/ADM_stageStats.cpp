@@ -0,0 +1,318 @@
+/***************************************************************************
+    \file ADM_stageStats.cpp
+    \brief Per stage timing of an export (decode, each filter, encode, audio, mux)
+
+    Each stage measures the time spent in its own code : the time spent
+    in the stages it pulls data from on the same thread is subtracted,
+    so that the numbers of a chain add up to the wall time of each thread.
+    Queues also record how full they were when asked for an item, which
+    tells which side of the queue is waiting for the other.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "ADM_cpp.h"
+#include "ADM_default.h"
+#include "ADM_stageStats.h"
+#include "ADM_coreJson.h"
+#include <vector>
+
+static thread_local uint64_t nestedUs=0; // Time spent in timed stages by this thread, ever
+
+static admMutex                         registryLock;
+static std::vector <ADM_stageStats *>   registry;
+static bool                             collecting=false;
+static Clock                            wallClock;
+static uint64_t                         wallUs=0;
+static Clock                            slowestClock;
+
+/**
+    \fn ctor
+*/
+ADM_stageStats::ADM_stageStats(const char *n)
+{
+    name=std::string(n);
+    selfUs=0;
+    calls=0;
+    frames=0;
+    queueSize=0;
+    queueMax=0;
+    queueSum=0;
+    queueSamples=0;
+    starved=0;
+    blocked=0;
+}
+/**
+    \fn addCall
+*/
+void ADM_stageStats::addCall(uint64_t us,bool gotFrame)
+{
+    lock.lock();
+    selfUs+=us;
+    calls++;
+    if(gotFrame)
+        frames++;
+    lock.unlock();
+}
+/**
+    \fn setQueueSize
+*/
+void ADM_stageStats::setQueueSize(uint32_t size)
+{
+    lock.lock();
+    queueSize=size;
+    lock.unlock();
+}
+/**
+    \fn sampleQueue
+*/
+void ADM_stageStats::sampleQueue(uint32_t depth)
+{
+    lock.lock();
+    queueSum+=depth;
+    queueSamples++;
+    if(depth>queueMax)
+        queueMax=depth;
+    lock.unlock();
+}
+/**
+    \fn addStarved
+*/
+void ADM_stageStats::addStarved(void)
+{
+    lock.lock();
+    starved++;
+    lock.unlock();
+}
+/**
+    \fn addBlocked
+*/
+void ADM_stageStats::addBlocked(void)
+{
+    lock.lock();
+    blocked++;
+    lock.unlock();
+}
+/**
+    \fn snapshot
+*/
+void ADM_stageStats::snapshot(ADM_stageSnapshot *s)
+{
+    lock.lock();
+    s->name=name;
+    s->selfUs=selfUs;
+    s->calls=calls;
+    s->frames=frames;
+    s->queueSize=queueSize;
+    s->queueMax=queueMax;
+    s->queueAverage=queueSamples? (float)queueSum/(float)queueSamples : 0;
+    s->starved=starved;
+    s->blocked=blocked;
+    lock.unlock();
+}
+
+/**
+    \fn ADM_stageTimer
+*/
+ADM_stageTimer::ADM_stageTimer()
+{
+    nestedBefore=nestedUs;
+    clk.reset();
+}
+/**
+    \fn stop
+*/
+uint64_t ADM_stageTimer::stop(void)
+{
+    uint64_t elapsed=clk.getElapsedUS();
+    uint64_t inner=nestedUs-nestedBefore;
+    nestedUs=nestedBefore+elapsed;
+    if(inner>elapsed)
+        return 0;
+    return elapsed-inner;
+}
+
+/**
+    \fn ADM_stageStatsStart
+    \brief Forget the previous export and start collecting
+            All the objects holding a stage of the previous export must be gone
+*/
+void ADM_stageStatsStart(void)
+{
+    registryLock.lock();
+    for(int i=0;i<registry.size();i++)
+        delete registry[i];
+    registry.clear();
+    collecting=true;
+    wallUs=0;
+    wallClock.reset();
+    slowestClock.reset();
+    registryLock.unlock();
+}
+/**
+    \fn ADM_stageStatsStop
+    \brief No new stage, the existing ones stay valid until the next start
+*/
+void ADM_stageStatsStop(void)
+{
+    registryLock.lock();
+    if(collecting)
+        wallUs=wallClock.getElapsedUS();
+    collecting=false;
+    registryLock.unlock();
+}
+/**
+    \fn ADM_stageStatsActive
+*/
+bool ADM_stageStatsActive(void)
+{
+    registryLock.lock();
+    bool r=collecting;
+    registryLock.unlock();
+    return r;
+}
+/**
+    \fn ADM_stageStatsCreate
+    \brief Returns NULL if no export is running, names are made unique with a #n suffix
+*/
+ADM_stageStats *ADM_stageStatsCreate(const char *name)
+{
+    ADM_stageStats *s=NULL;
+    registryLock.lock();
+    if(collecting)
+    {
+        std::string unique(name);
+        int n=1;
+        bool found=true;
+        while(found)
+        {
+            found=false;
+            for(int i=0;i<registry.size();i++)
+                if(unique==registry[i]->getName())
+                {
+                    found=true;
+                    break;
+                }
+            if(found)
+            {
+                char suffix[16];
+                n++;
+                snprintf(suffix,sizeof(suffix)," #%d",n);
+                unique=std::string(name)+std::string(suffix);
+            }
+        }
+        s=new ADM_stageStats(unique.c_str());
+        registry.push_back(s);
+    }
+    registryLock.unlock();
+    return s;
+}
+/**
+    \fn snapshotAll
+*/
+static uint64_t snapshotAll(std::vector <ADM_stageSnapshot> &list)
+{
+    registryLock.lock();
+    uint64_t wall=collecting? wallClock.getElapsedUS() : wallUs;
+    list.resize(registry.size());
+    for(int i=0;i<registry.size();i++)
+        registry[i]->snapshot(&(list[i]));
+    registryLock.unlock();
+    return wall;
+}
+/**
+    \fn ADM_stageStatsSlowest
+    \brief Describe the stage that took the most time so far, at most every minIntervalMs
+    \return false if there is nothing new to display
+*/
+bool ADM_stageStatsSlowest(std::string &description,uint32_t minIntervalMs)
+{
+    registryLock.lock();
+    bool due=collecting && slowestClock.getElapsedMS()>=minIntervalMs;
+    if(due)
+        slowestClock.reset();
+    registryLock.unlock();
+    if(!due)
+        return false;
+
+    std::vector <ADM_stageSnapshot> list;
+    uint64_t wall=snapshotAll(list);
+    int best=-1;
+    for(int i=0;i<list.size();i++)
+    {
+        if(list[i].queueSize) // waiting in a queue is not work
+            continue;
+        if(best<0 || list[i].selfUs>list[best].selfUs)
+            best=i;
+    }
+    if(best<0 || !wall)
+        return false;
+    char str[256];
+    snprintf(str,sizeof(str),"%s (%d%%)",list[best].name.c_str(),(int)((list[best].selfUs*100)/wall));
+    description=std::string(str);
+    return true;
+}
+/**
+    \fn ADM_stageStatsDump
+    \brief Print one line per stage in the log
+*/
+void ADM_stageStatsDump(void)
+{
+    std::vector <ADM_stageSnapshot> list;
+    uint64_t wall=snapshotAll(list);
+    if(!list.size())
+        return;
+    ADM_info("Export took %.2f s\n",(double)wall/1000000.);
+    ADM_info("%-32s %8s %10s %9s %6s   %s\n","Stage","Frames","Time (ms)","us/frame","% wall","Queue avg/max/size starved blocked");
+    for(int i=0;i<list.size();i++)
+    {
+        ADM_stageSnapshot &s=list[i];
+        double perFrame=s.frames? (double)s.selfUs/(double)s.frames : 0;
+        double percent=wall? (double)s.selfUs*100./(double)wall : 0;
+        if(s.queueSize)
+            ADM_info("%-32s %8u %10.1f %9.1f %6.1f   %.1f/%u/%u %u %u\n",s.name.c_str(),s.frames,(double)s.selfUs/1000.,
+                        perFrame,percent,s.queueAverage,s.queueMax,s.queueSize,s.starved,s.blocked);
+        else
+            ADM_info("%-32s %8u %10.1f %9.1f %6.1f\n",s.name.c_str(),s.frames,(double)s.selfUs/1000.,perFrame,percent);
+    }
+}
+/**
+    \fn ADM_stageStatsWriteJson
+*/
+bool ADM_stageStatsWriteJson(const char *file)
+{
+    std::vector <ADM_stageSnapshot> list;
+    uint64_t wall=snapshotAll(list);
+    admJson json;
+    json.addDouble("wallMs",(double)wall/1000.);
+    json.addNode("stages");
+    for(int i=0;i<list.size();i++)
+    {
+        ADM_stageSnapshot &s=list[i];
+        json.addNode(s.name.c_str());
+        json.addUint32("order",i);
+        json.addUint32("calls",s.calls);
+        json.addUint32("frames",s.frames);
+        json.addDouble("selfMs",(double)s.selfUs/1000.);
+        json.addDouble("usPerFrame",s.frames? (double)s.selfUs/(double)s.frames : 0.);
+        if(s.queueSize)
+        {
+            json.addUint32("queueSize",s.queueSize);
+            json.addFloat("queueAverage",s.queueAverage);
+            json.addUint32("queueMax",s.queueMax);
+            json.addUint32("starved",s.starved);
+            json.addUint32("blocked",s.blocked);
+        }
+        json.endNode();
+    }
+    json.endNode();
+    return json.dumpToFile(file);
+}
+// EOF
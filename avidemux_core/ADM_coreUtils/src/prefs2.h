@@ -27,6 +27,11 @@ struct  {
 	uint32_t cap_refresh_value;
 	std::string sdlDriver;
 	bool use_last_read_dir_as_target;
+	bool write_behind;
+	bool save_export_stats;
+	bool save_export_trace;
+	bool reuse_encoded_chunks;
+	bool cache_first_pass;
 }features;
 struct  {
 	bool use_alternate_kbd_shortcuts;
@@ -74,6 +79,7 @@ struct  {
 	uint32_t postproc_type;
 	uint32_t postproc_value;
 	uint32_t downmixing;
+	uint32_t resample_quality;
 	std::string language;
 	bool warn_for_fonts;
 }Default;
@@ -22,6 +22,11 @@ extern const ADM_paramList my_prefs_struct_param[]={
  {"features.cap_refresh_value",offsetof(my_prefs_struct,features.cap_refresh_value),"uint32_t",ADM_param_uint32_t},
  {"features.sdlDriver",offsetof(my_prefs_struct,features.sdlDriver),"std::string",ADM_param_stdstring},
  {"features.use_last_read_dir_as_target",offsetof(my_prefs_struct,features.use_last_read_dir_as_target),"bool",ADM_param_bool},
+ {"features.write_behind",offsetof(my_prefs_struct,features.write_behind),"bool",ADM_param_bool},
+ {"features.save_export_stats",offsetof(my_prefs_struct,features.save_export_stats),"bool",ADM_param_bool},
+ {"features.save_export_trace",offsetof(my_prefs_struct,features.save_export_trace),"bool",ADM_param_bool},
+ {"features.reuse_encoded_chunks",offsetof(my_prefs_struct,features.reuse_encoded_chunks),"bool",ADM_param_bool},
+ {"features.cache_first_pass",offsetof(my_prefs_struct,features.cache_first_pass),"bool",ADM_param_bool},
  {"keyboard_shortcuts.use_alternate_kbd_shortcuts",offsetof(my_prefs_struct,keyboard_shortcuts.use_alternate_kbd_shortcuts),"bool",ADM_param_bool},
  {"keyboard_shortcuts.swap_up_down_keys",offsetof(my_prefs_struct,keyboard_shortcuts.swap_up_down_keys),"bool",ADM_param_bool},
  {"keyboard_shortcuts.alt_mark_a",offsetof(my_prefs_struct,keyboard_shortcuts.alt_mark_a),"std::string",ADM_param_stdstring},
@@ -55,6 +60,7 @@ extern const ADM_paramList my_prefs_struct_param[]={
  {"Default.postproc_type",offsetof(my_prefs_struct,Default.postproc_type),"uint32_t",ADM_param_uint32_t},
  {"Default.postproc_value",offsetof(my_prefs_struct,Default.postproc_value),"uint32_t",ADM_param_uint32_t},
  {"Default.downmixing",offsetof(my_prefs_struct,Default.downmixing),"uint32_t",ADM_param_uint32_t},
+ {"Default.resample_quality",offsetof(my_prefs_struct,Default.resample_quality),"uint32_t",ADM_param_uint32_t},
  {"Default.language",offsetof(my_prefs_struct,Default.language),"std::string",ADM_param_stdstring},
  {"Default.warn_for_fonts",offsetof(my_prefs_struct,Default.warn_for_fonts),"bool",ADM_param_bool},
  {"avisynth.avisynth_always_ask",offsetof(my_prefs_struct,avisynth.avisynth_always_ask),"bool",ADM_param_bool},
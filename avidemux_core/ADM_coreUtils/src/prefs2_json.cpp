@@ -30,6 +30,11 @@ json.addBool("cap_refresh_enabled",key->features.cap_refresh_enabled);
 json.addUint32("cap_refresh_value",key->features.cap_refresh_value);
 json.addString("sdlDriver",key->features.sdlDriver);
 json.addBool("use_last_read_dir_as_target",key->features.use_last_read_dir_as_target);
+json.addBool("write_behind",key->features.write_behind);
+json.addBool("save_export_stats",key->features.save_export_stats);
+json.addBool("save_export_trace",key->features.save_export_trace);
+json.addBool("reuse_encoded_chunks",key->features.reuse_encoded_chunks);
+json.addBool("cache_first_pass",key->features.cache_first_pass);
 json.endNode();
 json.addNode("keyboard_shortcuts");
 json.addBool("use_alternate_kbd_shortcuts",key->keyboard_shortcuts.use_alternate_kbd_shortcuts);
@@ -77,6 +82,7 @@ json.addNode("Default");
 json.addUint32("postproc_type",key->Default.postproc_type);
 json.addUint32("postproc_value",key->Default.postproc_value);
 json.addUint32("downmixing",key->Default.downmixing);
+json.addUint32("resample_quality",key->Default.resample_quality);
 json.addString("language",key->Default.language);
 json.addBool("warn_for_fonts",key->Default.warn_for_fonts);
 json.endNode();
@@ -33,6 +33,11 @@ static optionDesc myOptions[]={
 { FEATURES_CAP_REFRESH_VALUE,"features.cap_refresh_value"             ,ADM_param_uint32_t	,"100",	10,	1000},
 { FEATURES_SDLDRIVER,"features.sdlDriver"                             ,ADM_param_stdstring  	,"",	0,	0},
 { FEATURES_USE_LAST_READ_DIR_AS_TARGET,"features.use_last_read_dir_as_target",ADM_param_bool    	,"0",	0,	1},
+{ FEATURES_WRITE_BEHIND,"features.write_behind"                       ,ADM_param_bool    	,"0",	0,	1},
+{ FEATURES_SAVE_EXPORT_STATS,"features.save_export_stats"             ,ADM_param_bool    	,"0",	0,	1},
+{ FEATURES_SAVE_EXPORT_TRACE,"features.save_export_trace"             ,ADM_param_bool    	,"0",	0,	1},
+{ FEATURES_REUSE_ENCODED_CHUNKS,"features.reuse_encoded_chunks"       ,ADM_param_bool    	,"0",	0,	1},
+{ FEATURES_CACHE_FIRST_PASS,"features.cache_first_pass"               ,ADM_param_bool    	,"0",	0,	1},
 { KEYBOARD_SHORTCUTS_USE_ALTERNATE_KBD_SHORTCUTS,"keyboard_shortcuts.use_alternate_kbd_shortcuts",ADM_param_bool    	,"0",	0,	1},
 { KEYBOARD_SHORTCUTS_SWAP_UP_DOWN_KEYS,"keyboard_shortcuts.swap_up_down_keys",ADM_param_bool    	,"0",	0,	1},
 { KEYBOARD_SHORTCUTS_ALT_MARK_A,"keyboard_shortcuts.alt_mark_a"       ,ADM_param_stdstring  	,"I",	0,	0},
@@ -66,6 +71,7 @@ static optionDesc myOptions[]={
 { DEFAULT_POSTPROC_TYPE,"Default.postproc_type"                       ,ADM_param_uint32_t	,"3",	0,	7},
 { DEFAULT_POSTPROC_VALUE,"Default.postproc_value"                     ,ADM_param_uint32_t	,"3",	0,	5},
 { DEFAULT_DOWNMIXING,"Default.downmixing"                             ,ADM_param_uint32_t	,"2",	0,	3},
+{ DEFAULT_RESAMPLE_QUALITY,"Default.resample_quality"                 ,ADM_param_uint32_t	,"1",	0,	2},
 { DEFAULT_LANGUAGE,"Default.language"                                 ,ADM_param_stdstring  	,"",	0,	0},
 { DEFAULT_WARN_FOR_FONTS,"Default.warn_for_fonts"                     ,ADM_param_bool    	,"1",	0,	1},
 { AVISYNTH_AVISYNTH_ALWAYS_ASK,"avisynth.avisynth_always_ask"         ,ADM_param_bool    	,"0",	0,	1},
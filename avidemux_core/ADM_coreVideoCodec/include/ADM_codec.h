@@ -64,6 +64,11 @@ public:
     return false;
   }				// if 1 means the decoder will return reference
   // no need to copy the datas to ADMimage
+  virtual bool shareOutput (bool onoff)
+  {
+    return false;
+  }				// if true is returned, the pictures may be given as ADM_HW_LAVC references
+  // that duplicate() passes around without copying, see ADMImage::hwDownloadFromRef
   virtual bool bFramePossible (void)
   {
     return false;
@@ -65,6 +65,7 @@ protected:
            bool         _setFcc;
            int          codecId;
            uint8_t      _refCopy;
+           bool         _shareOutput;
            uint32_t     _bpp;
            AVCodecContext *_context;
            uint8_t      *_extraDataCopy;
@@ -80,6 +81,7 @@ protected:
 protected:
            uint32_t     frameType (void);
            uint8_t      clonePic (AVFrame * src, ADMImage * out);
+           bool         shareFrame (AVFrame * src, ADMImage * out);
            void         decoderMultiThread ();
            uint32_t     admFrameTypeFromLav (AVFrame *pic);
 
@@ -102,6 +104,11 @@ public:
             return hwDecoder->dontcopy();
           return true;
         }
+        virtual bool shareOutput (bool onoff)
+        {
+          _shareOutput=onoff;
+          return true;
+        }
         virtual bool uncompress (ADMCompressedImage * in, ADMImage * out);
         virtual bool getConfiguration(CONFcouple **conf);
         virtual bool resetConfiguration();
@@ -19,6 +19,7 @@
 #include "ADM_ffmp43.h"
 #include "DIA_coreToolkit.h"
 #include "ADM_hwAccel.h"
+#include <atomic>
 
 #ifdef ADM_DEBUG
     #define LAV_VERBOSITY_LEVEL AV_LOG_DEBUG
@@ -89,6 +90,93 @@ uint8_t decoderFF::clonePic (AVFrame * src, ADMImage * out)
 
     return 1;
 }
+/**
+    \class lavFrameRef
+    \brief A decoded picture shared by reference. The AVFrame holds a reference to the
+            lavcodec buffer, which goes back to the decoder pool when the last image using it is gone.
+*/
+class lavFrameRef
+{
+public:
+        AVFrame             *frame;
+        uint8_t             *planes[3]; // already swapped if needed
+        int                 strides[3];
+        std::atomic<int>    count;
+};
+
+static bool lavFrameMarkUsed(void *instance,void *cookie)
+{
+    lavFrameRef *r=(lavFrameRef *)cookie;
+    r->count++;
+    return true;
+}
+
+static bool lavFrameMarkUnused(void *instance,void *cookie)
+{
+    lavFrameRef *r=(lavFrameRef *)cookie;
+    if(--(r->count))
+        return true;
+    av_frame_free(&(r->frame));
+    delete r;
+    return true;
+}
+/**
+    \fn lavFrameRefDownload
+    \brief Copy the shared picture to a regular image
+*/
+static bool lavFrameRefDownload(ADMImage *image, void *instance, void *cookie)
+{
+    lavFrameRef *r=(lavFrameRef *)cookie;
+    for(int i=PLANAR_Y;i<PLANAR_LAST;i++)
+    {
+        int w=image->_width;
+        int h=image->_height;
+        if(i!=PLANAR_Y)
+        {
+            w>>=1;
+            h>>=1;
+        }
+        BitBlit(image->GetWritePtr((ADM_PLANE)i),image->GetPitch((ADM_PLANE)i),r->planes[i],r->strides[i],w,h);
+    }
+    image->refType=ADM_HW_NONE;
+    lavFrameMarkUnused(instance,cookie);
+    return true;
+}
+/**
+    \fn shareFrame
+    \brief Turn out into a reference to the decoded frame, the editor cache
+            and the filter chain then pass it around without copying it.
+            Only for plain YV12 without quantizer table, the other cases are converted
+            or post processed from the planes.
+*/
+bool decoderFF::shareFrame(AVFrame *src, ADMImage *out)
+{
+    if(!_shareOutput)
+        return false;
+    if(out->_colorspace!=ADM_COLOR_YV12 || out->_qStride || !src->buf[0])
+        return false;
+    lavFrameRef *r=new lavFrameRef;
+    r->frame=av_frame_alloc();
+    if(!r->frame || av_frame_ref(r->frame,src)<0)
+    {
+        av_frame_free(&(r->frame));
+        delete r;
+        return false;
+    }
+    for(int i=0;i<3;i++)
+    {
+        r->planes[i]=out->_planes[i];
+        r->strides[i]=out->_planeStride[i];
+    }
+    r->count=1; // the one of out
+    out->refType=ADM_HW_LAVC;
+    out->refDescriptor.refCodec=NULL; // the buffer can outlive the decoder
+    out->refDescriptor.refHwImage=r;
+    out->refDescriptor.refMarkUsed=lavFrameMarkUsed;
+    out->refDescriptor.refMarkUnused=lavFrameMarkUnused;
+    out->refDescriptor.refDownload=lavFrameRefDownload;
+    return true;
+}
 /**
         \fn decoderMultiThread
         \brief Enabled multitheaded decoder if possible
@@ -177,6 +265,7 @@ decoderFF::decoderFF (uint32_t w, uint32_t h,uint32_t fcc, uint32_t extraDataLen
   _context = NULL;
   _frame = NULL;
   _refCopy = 0;
+  _shareOutput = false;
   _usingMT = 0;
   _bpp = bpp;
   _fcc = fcc;
@@ -370,6 +459,8 @@ bool   decoderFF::uncompress (ADMCompressedImage * in, ADMImage * out)
   out->_noPicture = 0;
   if(hwDecoder)
         return hwDecoder->uncompress(in,out);
+  if(out->refType==ADM_HW_LAVC) // we are done with the previous picture
+        out->hwDecRefCount();
  
   //printf("Frame size : %d\n",in->dataLength);
 
@@ -547,6 +638,7 @@ bool   decoderFF::uncompress (ADMCompressedImage * in, ADMImage * out)
       return 0;
     }
     clonePic (_frame, out);
+    shareFrame(_frame, out);
     //printf("[AvCodec] Pts : %"PRIu64" Out Pts:%"PRIu64" \n",_frame.pts,out->Pts);
 
   return 1;
@@ -72,8 +72,11 @@ virtual const  char         *getFourcc(void) =0;
                uint32_t    getTimeBaseDen(void) {return source->getInfo()->timeBaseDen;}
                uint32_t    getTimeBaseNum(void) {return source->getInfo()->timeBaseNum;}
                uint64_t    getTotalDuration(void) {return source->getInfo()->totalDuration;}
+               uint32_t    getBitDepth(void) {return source->getInfo()->bitDepth;} /// An 8 bits image is converted when filled, see ADMImage::duplicate
 virtual        bool        setPassAndLogFile(int pass,const char *name) {return false;}
 virtual        uint64_t    getEncoderDelay(void){return encoderDelay;}
+virtual        uint32_t    getLookahead(void) {return 0;} /// Number of frames the codec needs before it outputs anything, valid after setup
+               bool        prefetchLookahead(void);
                uint64_t    lastDts; //
 };
 ADM_COREVIDEOENCODER6_EXPORT bool usSecondsToFrac(uint64_t useconds, int *n, int *d, int maxclock=0xFFFF); // mpeg4 allows a maximum of 1<<16-1 as time base
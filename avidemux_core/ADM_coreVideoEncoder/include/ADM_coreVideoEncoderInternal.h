@@ -15,7 +15,7 @@
 #ifndef VIDEOENCODERINTERNAL_H
 #define VIDEOENCODERINTERNAL_H
 
-#define ADM_VIDEO_ENCODER_API_VERSION 7
+#define ADM_VIDEO_ENCODER_API_VERSION 8
 
 #include "ADM_coreVideoEncoder6_export.h"
 #include "BVector.h"
@@ -57,6 +57,19 @@ ADM_coreVideoEncoder::~ADM_coreVideoEncoder()
     if(image) delete image;
     image=NULL;
 }
+/**
+    \fn prefetchLookahead
+    \brief Ask the queue feeding us to keep as many filtered frames ready as the codec
+            looks ahead, so that the encoder does not wait for the filters when its
+            lookahead is refilled. Call it after setup.
+*/
+bool ADM_coreVideoEncoder::prefetchLookahead(void)
+{
+    uint32_t depth=getLookahead();
+    if(!depth)
+        return false;
+    return source->setQueueDepth(depth);
+}
 typedef struct
 {
     uint64_t mn,mx;
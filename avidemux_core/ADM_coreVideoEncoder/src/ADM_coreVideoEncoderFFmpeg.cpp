@@ -306,11 +306,23 @@ static int printLavError(int er)
     return er;
 }
 
+/**
+    \class lavPacketRef
+    \brief Keeps the lavcodec packet alive while the muxer uses it
+*/
+class lavPacketRef : public ADM_bitstreamRef
+{
+public:
+        AVPacket packet;
+                lavPacketRef() {av_init_packet(&packet);packet.data=NULL;packet.size=0;}
+        virtual ~lavPacketRef() {av_packet_unref(&packet);}
+};
 /**
  * \fn encodeWrapper
  */
 int ADM_coreVideoEncoderFFmpeg::encodeWrapper(AVFrame *in,ADMBitstream *out)
 {
+    out->releaseRef();
     int r=avcodec_send_frame(_context,in);
     if(r<0)
         return printLavError(r);
@@ -327,11 +339,18 @@ int ADM_coreVideoEncoderFFmpeg::encodeWrapper(AVFrame *in,ADMBitstream *out)
     if(r<0)
         return printLavError(r);
 
-    ADM_assert(out->bufferSize>=pkt.size);
-    memcpy(out->data,pkt.data,pkt.size);
     lavPtsFromPacket=pkt.pts; // some encoders don't set pts in coded_frame
     packetFlags=pkt.flags;
     r=pkt.size;
+    if(out->acceptRef && pkt.buf)
+    {
+        lavPacketRef *ref=new lavPacketRef;
+        av_packet_move_ref(&(ref->packet),&pkt);
+        out->setRef(ref,ref->packet.data,r);
+        return r;
+    }
+    ADM_assert(out->bufferSize>=pkt.size);
+    memcpy(out->data,pkt.data,pkt.size);
     av_packet_unref(&pkt);
     return r;
 }
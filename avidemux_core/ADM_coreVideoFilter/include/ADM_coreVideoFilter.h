@@ -46,6 +46,7 @@ typedef struct
     uint32_t timeBaseDen; // timebase denominator
     uint32_t timeBaseNum; // timebase numerator
     uint64_t totalDuration;     /// Duration of the whole stream in us
+    uint32_t bitDepth;          /// Bits per sample of the images out of this filter, see ADMImage::_bitDepth
 }FilterInfo;
 
 /**
@@ -75,6 +76,7 @@ public:
                 {return previousFilter->getAbsoluteStartTime();}       /// Like subtitlers who need that
        virtual bool         getTimeRange(uint64_t *start, uint64_t *end) /// For partialized filters, the time they are active
                 { *start=0; *end=previousFilter->getInfo()->totalDuration; return true; }
+       virtual bool         setQueueDepth(uint32_t frames) {return false;} /// Keep up to frames pictures ready ahead, only for queues
                ADM_coreVideoFilter *getSource() {return previousFilter;} /// FOR INTERNAL USE ONLY
 protected:
             ADM_coreVideoFilter *previousFilter;
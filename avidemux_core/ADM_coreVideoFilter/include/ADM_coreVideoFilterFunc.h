@@ -7,6 +7,8 @@
 
 ADM_COREVIDEOFILTER6_EXPORT bool ADM_vf_clearFilters(void);
 ADM_COREVIDEOFILTER6_EXPORT ADM_vf_plugin *ADM_vf_getPluginFromTag(uint32_t tag);
+ADM_COREVIDEOFILTER6_EXPORT bool ADM_vf_acceptsHighBitDepth(uint32_t tag);
+ADM_COREVIDEOFILTER6_EXPORT bool ADM_vf_acceptsHwImages(uint32_t tag);
 ADM_COREVIDEOFILTER6_EXPORT bool ADM_vf_removeFilterAtIndex(int index);
 ADM_COREVIDEOFILTER6_EXPORT bool ADM_vf_recreateChain(void);
 ADM_COREVIDEOFILTER6_EXPORT ADM_coreVideoFilter *ADM_vf_createFromTag(uint32_t tag, ADM_coreVideoFilter *last, CONFcouple *couples);
@@ -13,7 +13,7 @@
 
 class ADM_coreVideoFilter;
 
-#define VF_API_VERSION 9
+#define VF_API_VERSION 11
 
 /**
     \struct admVideoFilterInfo
@@ -31,6 +31,7 @@ typedef ADM_coreVideoFilter  *(ADM_vf_CreateFunction)(ADM_coreVideoFilter *previ
 typedef void              (ADM_vf_DeleteFunction)(ADM_coreVideoFilter *codec);
 typedef int               (ADM_vf_SupportedUI)(void); //  QT4/GTK / ALL
 typedef int               (ADM_vf_NeededFeatures)(void); // VDPAU, OPenGL,...
+typedef int               (ADM_vf_Capabilities)(void); // High bit depth,...
 typedef uint32_t          (ADM_vf_GetApiVersion)(void);
 typedef bool              (ADM_vf_GetPluginVersion)(uint32_t *major, uint32_t *minor, uint32_t *patch);
 typedef const char       *(ADM_vf_GetString)(void);
@@ -49,6 +50,7 @@ class ADM_vf_plugin : public ADM_LibWrapper
         ADM_vf_DeleteFunction       *destroy;
         ADM_vf_SupportedUI          *supportedUI;
         ADM_vf_NeededFeatures       *neededFeatures;
+        ADM_vf_Capabilities         *capabilities;
         ADM_vf_GetApiVersion        *getApiVersion;
         ADM_vf_GetPluginVersion     *getFilterVersion;
         ADM_vf_GetString            *getDesc;
@@ -87,6 +89,10 @@ class ADM_vf_plugin : public ADM_LibWrapper
     { \
         return UI & ADM_FEATURE_MASK; \
     } \
+    ADM_PLUGIN_EXPORT int capabilities(void) \
+    { \
+        return UI & ADM_CAPABILITY_MASK; \
+    } \
     ADM_PLUGIN_EXPORT uint32_t getApiVersion(void)\
     {\
             return VF_API_VERSION;\
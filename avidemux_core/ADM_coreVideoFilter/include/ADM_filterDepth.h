@@ -0,0 +1,40 @@
+/**
+        \file  ADM_filterDepth.h
+        \brief Change the number of bits per sample, inserted before the filters that only handle 8 bits
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#ifndef ADM_FILTER_DEPTH_H
+#define ADM_FILTER_DEPTH_H
+#include "ADM_coreVideoFilter6_export.h"
+#include "ADM_coreVideoFilter.h"
+
+/**
+ *  \class ADM_videoFilterDepth
+ *  \brief Same picture, converted to bitDepth bits per sample
+ */
+class ADM_COREVIDEOFILTER6_EXPORT ADM_videoFilterDepth : public ADM_coreVideoFilter
+{
+protected:
+                ADMImage            *source;
+
+public:
+                            ADM_videoFilterDepth(ADM_coreVideoFilter *previous,uint32_t bitDepth);
+       virtual              ~ADM_videoFilterDepth();
+
+       virtual const char   *getConfiguration(void) {return "bit depth";}
+       virtual bool         getCoupledConf(CONFcouple **couples) {*couples=NULL;return true;}
+       virtual void         setCoupledConf(CONFcouple *couples) {}
+       virtual bool         goToTime(uint64_t usSeek) {return previousFilter->goToTime(usSeek);}
+       virtual bool         getNextFrame(uint32_t *frameNumber,ADMImage *image);
+       virtual bool         getTimeRange(uint64_t *start, uint64_t *end) {return previousFilter->getTimeRange(start,end);}
+};
+
+#endif
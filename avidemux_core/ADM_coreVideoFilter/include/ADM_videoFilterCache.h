@@ -14,8 +14,10 @@
 #define __ADM_CACHE__
 class ADM_coreVideoFilter;
 
+#include <vector>
 #include "ADM_coreVideoFilter6_export.h"
 #include "ADM_image.h"
+#include "ADM_threads.h"
 /**
     \struct videoCacheEntry
 */
@@ -26,23 +28,52 @@ typedef struct vidCacheEntry
                 uint8_t		frameLock;		
                 uint32_t	lastUse;
         bool        freeEntry;
+        bool        stale;          // flushed while another consumer had it locked, freed on its last unlock
 
 }vidCacheEntry;
 /**
-    \class VideoCache
+    \class ADM_videoFrameProvider
+    \brief Window of decoded frames coming out of one filter.
+            All the cached filters reading from the same filter share the same provider, so that
+            neighbour frames are fetched and stored only once. The provider is refcounted and the
+            window is the sum of what the consumers asked for.
 */
-class ADM_COREVIDEOFILTER6_EXPORT VideoCache
+class ADM_COREVIDEOFILTER6_EXPORT ADM_videoFrameProvider
 {
         private:
-                vidCacheEntry       *entry;
+                std::vector <vidCacheEntry> entry;
                 uint32_t            counter;
-                uint32_t            nbEntry;
+                uint32_t            refCount;
+                uint32_t            width,height;
                 ADM_coreVideoFilter *incoming;
-
+                admMutex            lock;       // protects entry, not held while reading from incoming
+                admMutex            fetchLock;  // one read from incoming at a time, always taken before lock
 
                 int32_t             searchFrame( uint32_t frame);
                 int32_t             searchPtr( ADMImage *ptr);
-                int                 searchFreeEntry(void);
+                int                 searchFreeEntry(void);  /// -1 if all the entries are locked
+                bool                grow(uint32_t nb);
+                                    ADM_videoFrameProvider(ADM_coreVideoFilter *in);
+                                    ~ADM_videoFrameProvider();
+        public:
+        static  ADM_videoFrameProvider *acquire(ADM_coreVideoFilter *in,uint32_t nb);
+                void                release(uint32_t nb);
+
+                ADMImage            *getImage(uint32_t frame);
+                bool                unlock(ADMImage *frame);
+                bool                flush(void);    /// Forget the frames nobody has locked
+                void                dump(void);
+};
+/**
+    \class VideoCache
+    \brief Per filter view on the shared frame provider, keeps track of the frames locked by that filter
+*/
+class ADM_COREVIDEOFILTER6_EXPORT VideoCache
+{
+        private:
+                uint32_t            nbEntry;
+                ADM_videoFrameProvider *provider;
+                std::vector <ADMImage *> locked;
                 ADMImage            *getImageBase(uint32_t frame);
         public:
                                     VideoCache(uint32_t nb,ADM_coreVideoFilter *in);
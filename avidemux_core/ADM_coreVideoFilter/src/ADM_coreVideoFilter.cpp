@@ -45,6 +45,7 @@ BVector <ADM_vf_plugin *> ADM_videoFilterPluginsList[VF_MAX];
     nextFrame=0;
     myName="default";
     if(previous) memcpy(&info,previous->getInfo(),sizeof(info));
+    else info.bitDepth=8;
 }
 /**
     \fn  ~ADM_coreVideoFilter
@@ -2,10 +2,42 @@
 #include "ADM_coreVideoFilterFunc.h"
 #include "ADM_videoFilterBridge.h"
 #include "ADM_coreVideoFilter.h"
+#include "ADM_filterDepth.h"
 
 ADM_coreVideoFilter *bridge = NULL;
 
 static int objectCount = 0;
+// Bit depth converters inserted in front of the filters of ADM_VideoFilters that only handle 8 bits
+static BVector <ADM_coreVideoFilter *> depthConverters;
+
+/**
+    \fn previewInput
+    \brief Same rule as the export chain: convert high bit depth pictures for the filters that cannot deal with them
+*/
+static ADM_coreVideoFilter *previewInput(uint32_t tag, ADM_coreVideoFilter *f, BVector <ADM_coreVideoFilter *> &converters)
+{
+    if (f->getInfo()->bitDepth <= 8 || ADM_vf_acceptsHighBitDepth(tag))
+    {
+        return f;
+    }
+
+    ADM_coreVideoFilter *depth = new ADM_videoFilterDepth(f, 8);
+    converters.append(depth);
+    return depth;
+}
+
+/**
+    \fn clearConverters
+*/
+static void clearConverters(BVector <ADM_coreVideoFilter *> &converters)
+{
+    for (int i = 0; i < converters.size(); i++)
+    {
+        delete converters[i];
+    }
+
+    converters.clear();
+}
 
 /**
     \fn ADM_vf_clearFilters
@@ -22,6 +54,7 @@ bool ADM_vf_clearFilters(void)
     }
 
     ADM_VideoFilters.clear();
+    clearConverters(depthConverters);
     // delete bridge also...
     if(bridge)
     {
@@ -57,6 +90,38 @@ ADM_vf_plugin *ADM_vf_getPluginFromTag(uint32_t tag)
     return NULL;
 }
 
+/**
+    \fn ADM_vf_acceptsHighBitDepth
+    \brief True if the filter can process images with more than 8 bits per sample
+*/
+bool ADM_vf_acceptsHighBitDepth(uint32_t tag)
+{
+    ADM_vf_plugin *plugin = ADM_vf_getPluginFromTag(tag);
+
+    if (!plugin->capabilities)
+    {
+        return false;
+    }
+
+    return !!(plugin->capabilities() & ADM_CAPABILITY_HIGH_BITDEPTH);
+}
+
+/**
+    \fn ADM_vf_acceptsHwImages
+    \brief True if the filter works on the hw surfaces of the decoder, i.e. it would rather not get them downloaded
+*/
+bool ADM_vf_acceptsHwImages(uint32_t tag)
+{
+    ADM_vf_plugin *plugin = ADM_vf_getPluginFromTag(tag);
+
+    if (!plugin->neededFeatures)
+    {
+        return false;
+    }
+
+    return !!(plugin->neededFeatures() & (ADM_FEATURE_VDPAU + ADM_FEATURE_LIBVA));
+}
+
 /**
     \fn ADM_vf_removeFilterAtIndex
 
@@ -85,6 +150,7 @@ bool ADM_vf_recreateChain(void)
 
     ADM_coreVideoFilter *f = bridge;
     BVector <ADM_coreVideoFilter *> bin;
+    BVector <ADM_coreVideoFilter *> converters;
 
     for (int i = 0; i < ADM_VideoFilters.size(); i++)
     {
@@ -95,6 +161,7 @@ bool ADM_vf_recreateChain(void)
 
         old->getCoupledConf(&c);
 
+        f = previewInput(tag, f, converters);
         ADM_coreVideoFilter *nw = ADM_vf_createFromTag(tag, f, c);
 
         ADM_VideoFilters[i].instance = nw;
@@ -115,6 +182,12 @@ bool ADM_vf_recreateChain(void)
     }
 
     bin.clear();
+    clearConverters(depthConverters);
+
+    for (int i = 0; i < converters.size(); i++)
+    {
+        depthConverters.append(converters[i]);
+    }
 
     return true;
 }
@@ -140,14 +213,21 @@ ADM_VideoFilterElement* ADM_vf_addFilterFromTag(IEditor *editor, uint32_t tag, C
     // Fetch the descriptor...
 
     ADM_coreVideoFilter *last = ADM_vf_getLastVideoFilter(editor);
-    ADM_coreVideoFilter *nw = ADM_vf_createFromTag(tag, last, c);
+    BVector <ADM_coreVideoFilter *> converters;
+    ADM_coreVideoFilter *nw = ADM_vf_createFromTag(tag, previewInput(tag, last, converters), c);
 
     if (configure && nw->configure() == false)
     {
         delete nw;
+        clearConverters(converters);
         return NULL;
     }
 
+    for (int i = 0; i < converters.size(); i++)
+    {
+        depthConverters.append(converters[i]);
+    }
+
     ADM_VideoFilterElement e;
     e.tag = tag;
     e.instance = nw;
@@ -0,0 +1,48 @@
+/**
+        \file  ADM_filterDepth.cpp
+        \brief Change the number of bits per sample, inserted before the filters that only handle 8 bits
+*/
+
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ ***************************************************************************/
+#include "ADM_default.h"
+#include "ADM_filterDepth.h"
+
+/**
+    \fn     ADM_videoFilterDepth
+*/
+ADM_videoFilterDepth::ADM_videoFilterDepth(ADM_coreVideoFilter *previous,uint32_t bitDepth) :
+                ADM_coreVideoFilter(previous,NULL)
+{
+    myName="bitDepth";
+    source=new ADMImageDefault(info.width,info.height,info.bitDepth);
+    ADM_info("Converting from %" PRIu32" to %" PRIu32" bits per sample\n",info.bitDepth,bitDepth);
+    info.bitDepth=bitDepth;
+}
+/**
+    \fn     ~ADM_videoFilterDepth
+*/
+ADM_videoFilterDepth::~ADM_videoFilterDepth()
+{
+    delete source;
+    source=NULL;
+}
+/**
+    \fn     getNextFrame
+    \brief  The conversion is done by duplicate, image keeps its bit depth
+*/
+bool ADM_videoFilterDepth::getNextFrame(uint32_t *frameNumber,ADMImage *image)
+{
+    if(!previousFilter->getNextFrame(frameNumber,source))
+        return false;
+    image->setBitDepth(info.bitDepth);
+    image->duplicate(source);
+    return true;
+}
+//EOF
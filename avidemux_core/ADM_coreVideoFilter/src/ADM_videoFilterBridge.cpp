@@ -46,6 +46,10 @@ ADM_videoFilterBridge::ADM_videoFilterBridge(IEditor *editor, uint64_t startTime
     editor->getTimeBase(&(bridgeInfo.timeBaseNum), &(bridgeInfo.timeBaseDen));
     bridgeInfo.totalDuration = endTime - startTime;
     rewind();
+    // Known once the first picture has been decoded
+    bridgeInfo.bitDepth = editor->getVideoBitDepth();
+    if (bridgeInfo.bitDepth > 8)
+        ADM_info("[VideoFilterBridge] Source has %" PRIu32" bits per sample\n", bridgeInfo.bitDepth);
 }
 
 /**
@@ -14,6 +14,7 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <map>
 #include "ADM_default.h"
 #include "ADM_videoFilterCache.h"
 #include "ADM_coreVideoFilter.h"
@@ -22,137 +23,199 @@
 #else
     #define aprintf(a,...) ADM_info(a,##__VA_ARGS__)
 #endif
+typedef std::map <ADM_coreVideoFilter *,ADM_videoFrameProvider *> providerMap;
+static providerMap  providers;
+static admMutex     providerLock;
+
+/**
+    \fn acquire
+    \brief Get the provider attached to filter "in", creating it if needed, and make room for nb more frames
+*/
+ADM_videoFrameProvider *ADM_videoFrameProvider::acquire(ADM_coreVideoFilter *in,uint32_t nb)
+{
+    admScopedMutex autolock(&providerLock);
+    ADM_videoFrameProvider *p;
+    providerMap::iterator it=providers.find(in);
+    if(it==providers.end())
+    {
+        p=new ADM_videoFrameProvider(in);
+        providers[in]=p;
+    }else
+    {
+        p=it->second;
+        ADM_info("Sharing frame window of filter %p (%d users)\n",in,(int)p->refCount+1);
+    }
+    p->refCount++;
+    p->grow(nb);
+    return p;
+}
+/**
+    \fn release
+    \brief One consumer less, the provider is destroyed with its last consumer
+*/
+void ADM_videoFrameProvider::release(uint32_t nb)
+{
+    admScopedMutex autolock(&providerLock);
+    ADM_assert(refCount);
+    refCount--;
+    if(!refCount)
+    {
+        providers.erase(incoming);
+        delete this;
+        return;
+    }
+    // Give back the memory of that consumer, frames still locked by the others stay
+    admScopedMutex autolock2(&lock);
+    for(int i=(int)entry.size()-1;i>=0 && nb;i--)
+    {
+        if(entry[i].frameLock) continue;
+        delete entry[i].image;
+        entry.erase(entry.begin()+i);
+        nb--;
+    }
+}
 /**
     \fn ctor
 */
-VideoCache::VideoCache(uint32_t nb,ADM_coreVideoFilter *in)
+ADM_videoFrameProvider::ADM_videoFrameProvider(ADM_coreVideoFilter *in)
 {
-uint32_t sz;
-	nbEntry=nb;
-	incoming=in;
-	// Ready buffers
-	entry=new vidCacheEntry[nbEntry];
-        uint32_t w=in->getInfo()->width;
-        uint32_t h=in->getInfo()->height;
-
-	sz=(w*h*3)>>1;
-	for(uint32_t i=0;i<nbEntry;i++)
-	{
-		entry[i].image	=new ADMImageDefault(w,h);	
-		entry[i].frameNum	=0xffff0000;
-		entry[i].frameLock	=0;
-        entry[i].freeEntry=true;
-	}	
-	counter=0;
+    incoming=in;
+    width=in->getInfo()->width;
+    height=in->getInfo()->height;
+    counter=0;
+    refCount=0;
 }
 /**
     \fn dtor
 */
-VideoCache::~ VideoCache()
+ADM_videoFrameProvider::~ADM_videoFrameProvider()
 {
-	for(uint32_t i=0;i<nbEntry;i++)
-	{
-		delete  entry[i].image;
-	}
-	delete [] entry;
-    entry=NULL;
-	
+    for(uint32_t i=0;i<entry.size();i++)
+    {
+        delete  entry[i].image;
+    }
+    entry.clear();
+}
+/**
+    \fn grow
+    \brief Add nb ready buffers
+*/
+bool ADM_videoFrameProvider::grow(uint32_t nb)
+{
+    admScopedMutex autolock(&lock);
+    for(uint32_t i=0;i<nb;i++)
+    {
+        vidCacheEntry e;
+        e.image     =new ADMImageDefault(width,height);
+        e.frameNum  =0xffff0000;
+        e.frameLock =0;
+        e.lastUse   =0xffff0000;
+        e.freeEntry =true;
+        e.stale     =false;
+        entry.push_back(e);
+    }
+    return true;
 }
 /**
     \fn searchFrame
     \brief Search an entry by its frameNumber
 */
-int32_t VideoCache::searchFrame( uint32_t frame)
+int32_t ADM_videoFrameProvider::searchFrame( uint32_t frame)
 {
-	for(uint32_t i=0;i<nbEntry;i++)
+	for(uint32_t i=0;i<entry.size();i++)
 	{
-		if(entry[i].frameNum==frame&& entry[i].freeEntry==false) return i;
+		if(entry[i].frameNum==frame&& entry[i].freeEntry==false && !entry[i].stale) return i;
 	}
 	return -1;
 }
 //_____________________________________________
-int32_t 	 VideoCache::searchPtr( ADMImage *ptr)
+int32_t 	 ADM_videoFrameProvider::searchPtr( ADMImage *ptr)
 {
-	for(uint32_t i=0;i<nbEntry;i++)
+	for(uint32_t i=0;i<entry.size();i++)
 	{
 		if(entry[i].image==ptr && entry[i].freeEntry==false) return i;
 	}
 	return -1;
 }
 //_____________________________________________
-uint8_t  VideoCache::unlockAll(void)
+bool  ADM_videoFrameProvider::unlock(ADMImage *frame)
 {
-	for(uint32_t i=0;i<nbEntry;i++)
-	{		
-		entry[i].frameLock=0;		
-	}
-	return 1;
-}
-//_____________________________________________
-uint8_t  VideoCache::unlock(ADMImage *frame)
-{
-int32_t k;
-	k=searchPtr(frame) ;
-	ADM_assert(k>=0);
-	entry[k].frameLock--;	
-	return 1;	
+    admScopedMutex autolock(&lock);
+    int32_t k=searchPtr(frame) ;
+    ADM_assert(k>=0);
+    if(entry[k].frameLock) entry[k].frameLock--;
+    if(!entry[k].frameLock && entry[k].stale)
+    {
+        entry[k].frameNum=0xffff0000;
+        entry[k].lastUse=0xffff0000;
+        entry[k].freeEntry=true;
+        entry[k].stale=false;
+    }
+    return true;
 }
 /**
     \fn flush
-    \brief Empty cache
+    \brief Empty cache. The caller must have released its own locks first, the frames still locked
+            by other consumers stay valid for them but cannot be found anymore.
 */
-uint8_t  VideoCache::flush(void)
+bool  ADM_videoFrameProvider::flush(void)
 {
+    admScopedMutex autolock(&lock);
     printf("Flushing video Cache\n");
-	for(uint32_t i=0;i<nbEntry;i++)
+	for(uint32_t i=0;i<entry.size();i++)
 	{		
-		entry[i].frameLock=0;
+        if(entry[i].freeEntry) continue;
+        if(entry[i].frameLock)
+        {
+            entry[i].stale=true;
+            continue;
+        }
 		entry[i].frameNum=0xffff0000;	
 		entry[i].lastUse=0xffff0000;	
         entry[i].freeEntry=true;
 	}
-	return 1;
-
+	return true;
 }
 /**
      \fn searchFreeEntry
 
 */
-int VideoCache::searchFreeEntry(void)
+int ADM_videoFrameProvider::searchFreeEntry(void)
 {
     // Search a free one
-    for(uint32_t i=0;i<nbEntry;i++)
+    for(uint32_t i=0;i<entry.size();i++)
 	{
         if(entry[i].freeEntry==true) return i;
     }
     // Search the oldest one
     uint32_t deltamax=0,delta;
     uint32_t target=0xfff;
-    //for(uint32_t i=0;i<nbEntry;i++) printf("%d(%d) ",frameNum[i],frameLock[i]);printf("\n");
-    for(uint32_t i=0;i<nbEntry;i++)
+    for(uint32_t i=0;i<entry.size();i++)
     {
             if(entry[i].frameLock) continue; 	// don"t consider locked frames
 
             delta=abs((int)counter-(int)entry[i].lastUse);
-            if(delta>deltamax)
+            if(delta>=deltamax)
             {
                     deltamax=delta;
                     target=i;
             }
     }
-    ADM_assert(target!=0xfff);
+    if(target==0xfff)
+        return -1;
     return target;
 }
-
 /**
-    \fn getImageBase
+    \fn getImage
+    \brief Returns frame "frame" locked. If another consumer is lagging behind, the frames in between
+            are fetched and kept in the window for it. Returns NULL if the frame is gone, i.e. the consumers
+            drifted further apart than the window.
+            The reads from incoming are serialized by fetchLock, lock is only held while updating the entries.
 */
-ADMImage *VideoCache::getImageBase(uint32_t frame)
+ADMImage *ADM_videoFrameProvider::getImage(uint32_t frame)
 {
-int32_t i;
-uint32_t tryz=nbEntry;
-uint32_t len,flags;
-
+    int32_t i;
+    lock.lock();
     // Already there ?
     if((i=searchFrame(frame))>=0)
     {
@@ -161,28 +224,147 @@ uint32_t len,flags;
             entry[i].frameLock++;
             entry[i].lastUse=counter;
             counter++;
+            lock.unlock();
             return img;	
     }
-    int target=searchFreeEntry();
-    uint32_t nb;
-    ADMImage *img=entry[target].image;
-    if(!incoming->getNextFrameAs(ADM_HW_ANY,&nb,img)) 
-        return NULL;
-    if(nb!=frame)
+    lock.unlock();
+    admScopedMutex autofetch(&fetchLock);
+    while(1)
     {
-        ADM_error("Cache inconsistency :\n");
-        ADM_error("Expected to get frame %d from filter, got frame %d instead\n",(int)frame,(int)nb);
-        dump();
-        ADM_assert(0);
+        lock.lock();
+        // Another consumer may have read it while we were waiting
+        if((i=searchFrame(frame))>=0)
+        {
+            entry[i].frameLock++;
+            entry[i].lastUse=counter;
+            counter++;
+            lock.unlock();
+            return entry[i].image;
+        }
+        int target=searchFreeEntry();
+        if(target<0)
+        {
+            ADM_warning("[cache] All the frames are locked, cannot read frame %d\n",(int)frame);
+            lock.unlock();
+            return NULL;
+        }
+        // Keep it out of the hands of the other consumers while we fill it
+        uint32_t nb;
+        ADMImage *img=entry[target].image;
+        entry[target].frameNum=0xffff0000;
+        entry[target].freeEntry=false;
+        entry[target].frameLock=1;
+        lock.unlock();
+
+        bool r=incoming->getNextFrameAs(ADM_HW_ANY,&nb,img);
+
+        lock.lock();
+        entry[target].frameLock=0;
+        if(!r || entry[target].stale)
+        {
+            // End of stream, or flushed while we were reading
+            entry[target].lastUse=0xffff0000;
+            entry[target].freeEntry=true;
+            entry[target].stale=false;
+            lock.unlock();
+            return NULL;
+        }
+        aprintf(">>>>>>>>>>>>>>>>>>>>>>>>>>[cache] New image Got frame %d with PTS=%" PRIu64"\n",(int)nb,img->Pts);
+        // Update LRU info
+        entry[target].frameNum=nb;
+        entry[target].lastUse=counter;
+        counter++;
+        if(nb==frame)
+        {
+            entry[target].frameLock++;
+            lock.unlock();
+            return img;
+        }
+        if(nb>frame || refCount<2)
+        {
+            ADM_error("Cache miss :\n");
+            ADM_error("Expected to get frame %d from filter, got frame %d instead\n",(int)frame,(int)nb);
+            dump();
+            lock.unlock();
+            return NULL;
+        }
+        lock.unlock();
     }
-    ADM_assert(nb==frame);
-    aprintf(">>>>>>>>>>>>>>>>>>>>>>>>>>[cache] New image Got frame %d with PTS=%" PRIu64"\n",(int)nb,img->Pts);
-    // Update LRU info
-    entry[target].frameLock++;
-    entry[target].frameNum=nb;
-    entry[target].lastUse=counter;
-    entry[target].freeEntry=false;
-    counter++;	
+    return NULL;
+}
+/**
+    \fn dump
+*/
+void ADM_videoFrameProvider::dump(void)
+{
+    uint32_t nbEntry=entry.size();
+    for(uint32_t i=0;i<nbEntry;i++)
+    {
+        printf("Entry %" PRIu32"/%" PRIu32", frameNum %" PRIu32" lock %" PRIu32" lastUse %" PRIu32"\n",
+                i,nbEntry,
+                entry[i].frameNum,
+                entry[i].frameLock,
+                entry[i].lastUse);
+    }
+}
+
+//_____________________________________________
+/**
+    \fn ctor
+*/
+VideoCache::VideoCache(uint32_t nb,ADM_coreVideoFilter *in)
+{
+    nbEntry=nb;
+    provider=ADM_videoFrameProvider::acquire(in,nb);
+}
+/**
+    \fn dtor
+*/
+VideoCache::~ VideoCache()
+{
+    unlockAll();
+    provider->release(nbEntry);
+    provider=NULL;
+}
+//_____________________________________________
+uint8_t  VideoCache::unlockAll(void)
+{
+    for(uint32_t i=0;i<locked.size();i++)
+        provider->unlock(locked[i]);
+    locked.clear();
+	return 1;
+}
+//_____________________________________________
+uint8_t  VideoCache::unlock(ADMImage *frame)
+{
+    for(uint32_t i=0;i<locked.size();i++)
+    {
+        if(locked[i]!=frame) continue;
+        locked.erase(locked.begin()+i);
+        provider->unlock(frame);
+        return 1;
+    }
+    ADM_assert(0);
+	return 0;
+}
+/**
+    \fn flush
+    \brief Empty cache
+*/
+uint8_t  VideoCache::flush(void)
+{
+    unlockAll();
+    provider->flush();
+	return 1;
+}
+/**
+    \fn getImageBase
+*/
+ADMImage *VideoCache::getImageBase(uint32_t frame)
+{
+    ADMImage *img=provider->getImage(frame);
+    if(img)
+        locked.push_back(img);
     return img;
 }
 /**
@@ -213,14 +395,6 @@ ADMImage *VideoCache::getImageAs(ADM_HW_IMAGE type,uint32_t frame)
 */
 void VideoCache::dump(void)
 {
-    for(uint32_t i=0;i<nbEntry;i++)
-    {
-        printf("Entry %" PRIu32"/%" PRIu32", frameNum %" PRIu32" lock %" PRIu32" lastUse %" PRIu32"\n",
-                i,nbEntry,
-                entry[i].frameNum,
-                entry[i].frameLock,
-                entry[i].lastUse);
-    }
-
+    provider->dump();
 }
 // EOF
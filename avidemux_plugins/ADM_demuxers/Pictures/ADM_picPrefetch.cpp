@@ -0,0 +1,238 @@
+/***************************************************************************
+    \file ADM_picPrefetch.cpp
+    \brief Read the next images of a sequence ahead on worker threads
+
+    Image sequences coming from render farms are made of tens of thousands
+    of files, opening and reading them one by one when the editor asks for
+    them leaves both the disk and the decoder waiting for each other.
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ADM_default.h"
+#include "ADM_cpuCap.h"
+#include "ADM_picPrefetch.h"
+
+#if 1
+#define aprintf(...) {}
+#else
+#define aprintf printf
+#endif
+
+/**
+    \fn ctor
+*/
+picPrefetch::picPrefetch(const std::vector <std::string> &n,const std::vector <uint32_t> &s,uint32_t offset) : names(n), sizes(s)
+{
+    headerOffset=offset;
+    quit=false;
+    nbThreads=ADM_cpu_num_processors();
+    if(nbThreads<1) nbThreads=1;
+    if(nbThreads>PIC_PREFETCH_MAX_THREADS) nbThreads=PIC_PREFETCH_MAX_THREADS;
+    nbSlots=nbThreads*PIC_PREFETCH_DEPTH;
+    slots=new picSlot[nbSlots];
+    for(int i=0;i<nbSlots;i++)
+    {
+        slots[i].state=PIC_SLOT_EMPTY;
+        slots[i].frame=0;
+    }
+    pthread_mutex_init(&lock,NULL);
+    pthread_cond_init(&wakeWorkers,NULL);
+    pthread_cond_init(&wakeCaller,NULL);
+    int started=0;
+    for(int i=0;i<nbThreads;i++)
+    {
+        if(pthread_create(threads+i,NULL,workerEntry,this))
+        {
+            ADM_warning("Cannot create prefetch thread %d\n",i);
+            break;
+        }
+        started++;
+    }
+    nbThreads=started;
+    ADM_info("Reading up to %d images ahead with %d threads\n",nbSlots,nbThreads);
+}
+/**
+    \fn dtor
+*/
+picPrefetch::~picPrefetch()
+{
+    pthread_mutex_lock(&lock);
+    quit=true;
+    pthread_cond_broadcast(&wakeWorkers);
+    pthread_mutex_unlock(&lock);
+    for(int i=0;i<nbThreads;i++)
+        pthread_join(threads[i],NULL);
+    pthread_mutex_destroy(&lock);
+    pthread_cond_destroy(&wakeWorkers);
+    pthread_cond_destroy(&wakeCaller);
+    delete [] slots;
+    slots=NULL;
+}
+/**
+    \fn readFile
+    \brief Read size bytes starting at offset, i.e. the image without the bmp header
+            A truncated file is not fatal, the missing part is zeroed and left to the decoder,
+            only a file that cannot be opened fails.
+*/
+bool picPrefetch::readFile(const char *name,uint32_t offset,uint32_t size,uint8_t *data)
+{
+    FILE *fd=ADM_fopen(name,"rb");
+    if(!fd)
+    {
+        ADM_error("Cannot open %s\n",name);
+        return false;
+    }
+    if(offset)
+        fseek(fd,offset,SEEK_SET);
+    size_t n=0;
+    if(size)
+        n=fread(data,1,size,fd);
+    fclose(fd);
+    if(n!=size)
+    {
+        ADM_error("Read incomplete for %s, got %u bytes out of %u\n",name,(unsigned int)n,size);
+        memset(data+n,0,size-n);
+    }
+    return true;
+}
+/**
+    \fn workerEntry
+*/
+void *picPrefetch::workerEntry(void *me)
+{
+    ((picPrefetch *)me)->workerLoop();
+    pthread_exit(NULL);
+    return NULL;
+}
+/**
+    \fn workerLoop
+    \brief Take the pending image with the lowest number, read it outside of the lock
+*/
+void picPrefetch::workerLoop(void)
+{
+    pthread_mutex_lock(&lock);
+    while(!quit)
+    {
+        int best=-1;
+        for(int i=0;i<nbSlots;i++)
+        {
+            if(slots[i].state!=PIC_SLOT_PENDING) continue;
+            if(best<0 || slots[i].frame<slots[best].frame)
+                best=i;
+        }
+        if(best<0)
+        {
+            pthread_cond_wait(&wakeWorkers,&lock);
+            continue;
+        }
+        picSlot *s=slots+best;
+        uint32_t frame=s->frame;
+        s->state=PIC_SLOT_LOADING;
+        s->data.resize(sizes[frame]);
+        pthread_mutex_unlock(&lock);
+
+        aprintf("[picPrefetch] reading image %u\n",frame);
+        bool ok=readFile(names[frame].c_str(),headerOffset,sizes[frame],s->data.data());
+
+        pthread_mutex_lock(&lock);
+        s->state=ok? PIC_SLOT_READY : PIC_SLOT_FAILED;
+        pthread_cond_broadcast(&wakeCaller);
+    }
+    pthread_mutex_unlock(&lock);
+}
+/**
+    \fn schedule
+    \brief Ask for the images following frame, lock must be held
+            Slots holding images out of the window are recycled, unless a worker is busy with them
+*/
+void picPrefetch::schedule(uint32_t frame)
+{
+    uint32_t last=frame+nbSlots;
+    if(last>=names.size())
+        last=names.size()-1;
+    for(uint32_t f=frame+1;f<=last;f++)
+    {
+        int freeSlot=-1;
+        bool present=false;
+        for(int i=0;i<nbSlots;i++)
+        {
+            picSlot *s=slots+i;
+            switch(s->state)
+            {
+                case PIC_SLOT_EMPTY:
+                case PIC_SLOT_FAILED:
+                        if(freeSlot<0) freeSlot=i;
+                        break;
+                case PIC_SLOT_LOADING:
+                        if(s->frame==f) present=true;
+                        break;
+                default:
+                        if(s->frame==f)
+                            present=true;
+                        else if(freeSlot<0 && (s->frame<=frame || s->frame>last))
+                            freeSlot=i;
+                        break;
+            }
+            if(present) break;
+        }
+        if(present) continue;
+        if(freeSlot<0) break; // all busy
+        slots[freeSlot].frame=f;
+        slots[freeSlot].state=PIC_SLOT_PENDING;
+    }
+    pthread_cond_broadcast(&wakeWorkers);
+}
+/**
+    \fn read
+    \brief Get image frame in data, from the prefetched ones if possible
+*/
+bool picPrefetch::read(uint32_t frame,uint8_t *data)
+{
+    if(frame>=names.size())
+        return false;
+    if(!nbThreads)
+        return readFile(names[frame].c_str(),headerOffset,sizes[frame],data);
+
+    pthread_mutex_lock(&lock);
+    int found=-1;
+    for(int i=0;i<nbSlots;i++)
+    {
+        if(slots[i].state!=PIC_SLOT_EMPTY && slots[i].frame==frame)
+        {
+            found=i;
+            break;
+        }
+    }
+    if(found>=0 && slots[found].state==PIC_SLOT_PENDING) // not started yet, don't wait for a worker
+    {
+        slots[found].state=PIC_SLOT_EMPTY;
+        found=-1;
+    }
+    bool r=false;
+    if(found>=0)
+    {
+        picSlot *s=slots+found;
+        while(s->state==PIC_SLOT_LOADING)
+            pthread_cond_wait(&wakeCaller,&lock);
+        r=(s->state==PIC_SLOT_READY);
+        if(r)
+            memcpy(data,s->data.data(),s->data.size());
+        s->state=PIC_SLOT_EMPTY;
+    }
+    schedule(frame);
+    pthread_mutex_unlock(&lock);
+    if(r)
+        return true;
+    aprintf("[picPrefetch] image %u not prefetched\n",frame);
+    return readFile(names[frame].c_str(),headerOffset,sizes[frame],data);
+}
+// EOF
@@ -0,0 +1,75 @@
+/***************************************************************************
+    \file ADM_picPrefetch.h
+    \brief Read the next images of a sequence ahead on worker threads
+
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#pragma once
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#define PIC_PREFETCH_MAX_THREADS 4
+#define PIC_PREFETCH_DEPTH       3 // Images read ahead per worker thread
+
+/**
+    \enum picSlotState
+*/
+typedef enum
+{
+    PIC_SLOT_EMPTY,
+    PIC_SLOT_PENDING,   // requested, not yet picked by a worker
+    PIC_SLOT_LOADING,   // a worker owns the buffer
+    PIC_SLOT_READY,
+    PIC_SLOT_FAILED
+}picSlotState;
+
+/**
+    \struct picSlot
+*/
+typedef struct
+{
+    picSlotState            state;
+    uint32_t                frame;
+    std::vector <uint8_t>   data;
+}picSlot;
+
+/**
+    \class picPrefetch
+    \brief Keep the files of the N images following the last one asked for in memory
+            Files are read whole by the workers, the caller only does a memcpy
+            as long as it goes forward. Any other access is read synchronously.
+*/
+class picPrefetch
+{
+protected:
+    const std::vector <std::string> &names;
+    const std::vector <uint32_t>    &sizes;
+    uint32_t                        headerOffset;
+    int                             nbThreads;
+    pthread_t                       threads[PIC_PREFETCH_MAX_THREADS];
+    pthread_mutex_t                 lock;
+    pthread_cond_t                  wakeWorkers;
+    pthread_cond_t                  wakeCaller;
+    bool                            quit;
+    int                             nbSlots;
+    picSlot                         *slots;
+
+    static  void        *workerEntry(void *me);
+            void        workerLoop(void);
+            void        schedule(uint32_t frame);
+public:
+                        picPrefetch(const std::vector <std::string> &names,const std::vector <uint32_t> &sizes,uint32_t headerOffset);
+                        ~picPrefetch();
+            bool        read(uint32_t frame,uint8_t *data);
+    static  bool        readFile(const char *name,uint32_t offset,uint32_t size,uint8_t *data);
+};
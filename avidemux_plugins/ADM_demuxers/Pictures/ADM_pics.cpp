@@ -24,6 +24,7 @@
 #include "ADM_Video.h"
 #include "fourcc.h"
 #include "ADM_pics.h"
+#include "ADM_picPrefetch.h"
 
 #if 1
 #define aprintf(...) {}
@@ -48,6 +49,7 @@ picHeader::picHeader(void)
 {
     _nbFiles = 0;
     _bmpHeaderOffset=0;
+    _prefetch=NULL;
 }
 /**
     \fn getTime
@@ -89,26 +91,13 @@ uint8_t picHeader::getFrame(uint32_t framenum, ADMCompressedImage *img)
 {
     if (framenum >= (uint32_t)_videostream.dwLength)
             return 0;
-    FILE* fd = openFrameFile(framenum);
-    if(!fd)
-        return false;
-    // skip bmp header
-    if(_bmpHeaderOffset)
-        fseek(fd,_bmpHeaderOffset,SEEK_SET);
-    int l= _imgSize[framenum];
-    int n=fread(img->data, l , 1, fd);
-    
-    int current=ftello(fd);
-    fseek(fd,0,SEEK_END);
-    int end=ftello(fd);
-    aprintf("Current=%d end=%d delta=%d\n",current,end,end-current);
-    
-    if(n!=1)
-    {
-        ADM_error("Read incomplete \n");
-    }
-    
-    fclose(fd);
+    bool r;
+    if(_prefetch)
+        r=_prefetch->read(framenum,img->data);
+    else
+        r=picPrefetch::readFile(_fileNames[framenum].c_str(),_bmpHeaderOffset,_imgSize[framenum],img->data);
+    if(!r)
+        return 0;
     
     uint64_t timeP=US_PER_PIC;
     timeP*=framenum;
@@ -124,8 +113,14 @@ uint8_t picHeader::getFrame(uint32_t framenum, ADMCompressedImage *img)
  */
 uint8_t picHeader::close(void)
 {
+        if(_prefetch)
+        {
+            delete _prefetch;
+            _prefetch=NULL;
+        }
 	_nbFiles = 0;
         _imgSize.clear();
+        _fileNames.clear();
 	return 0;
 }
 
@@ -262,7 +257,6 @@ uint8_t picHeader::open(const char *inname)
         return 0;
     }
 
-    FILE *fd;    
     int bpp = 0;
     
     // 1- identity the image type    
@@ -279,53 +273,44 @@ uint8_t picHeader::open(const char *inname)
     ADM_PathSplit(std::string(inname),name,extension);
     splitImageSequence(name,nbOfDigits,_first,prefix);
     
+    if(_type==ADM_PICTURE_BMP || _type==ADM_PICTURE_BMP2)
+    {
+         // get bpp and offset
+        if(!extractBmpAdditionalInfo(inname,_type,bpp,_bmpHeaderOffset))
+        {
+            ADM_warning("Could not get BMP/BMP2 info\n");
+            return false;
+        }
+                
+    }
+    //_________________________________
+    // now open them once, keep their name and assign imgSize
+    //__________________________________
     if(!nbOfDigits) // no digit at all
     {
-        _nbFiles=1;
         _filePrefix=prefix+std::string(".")+extension;
+        if(!addFrameFile(_filePrefix.c_str()))
+            return 0;
     }
     else
     {
         char realstring[MAX_LEN];
         sprintf(realstring, "%s%%0%" PRIu32"d.%s", prefix.c_str(), nbOfDigits, extension.c_str());
         _filePrefix=std::string(realstring);
-        _nbFiles = 0;
         for (uint32_t i = 0; i < MAX_ACCEPTED_OPEN_FILE; i++)
         {
                 sprintf(realstring, _filePrefix.c_str(), i + _first);
-                ADM_info(" %" PRIu32" : %s\n", i, realstring);
-
-                fd = ADM_fopen(realstring, "rb");
-                if (fd == NULL)
+                aprintf(" %" PRIu32" : %s\n", i, realstring);
+                if(!addFrameFile(realstring))
                         break;
-                fclose(fd);
-                _nbFiles++;
-        }
-    }
-    if(_type==ADM_PICTURE_BMP || _type==ADM_PICTURE_BMP2)
-    {
-         // get bpp and offset
-        if(!extractBmpAdditionalInfo(inname,_type,bpp,_bmpHeaderOffset))
-        {
-            ADM_warning("Could not get BMP/BMP2 info\n");
-            return false;
         }
-                
     }
-    
+    _nbFiles=_fileNames.size();
     ADM_info("Found %" PRIu32" images\n", _nbFiles);
-    //_________________________________
-    // now open them and assign imgSize
-    //__________________________________
-    for (uint32_t i = 0; i < _nbFiles; i++)
-    {
-            fd = openFrameFile(i);
-            ADM_assert(fd);
-            fseek(fd, 0, SEEK_END);
-            aprintf("Size %d, actual = 24 %d 32=%d offset=%d\n",ftell(fd)-_bmpHeaderOffset,_w*_h*3,_w*_h*4,_bmpHeaderOffset);
-            _imgSize.push_back(ftell(fd)-_bmpHeaderOffset);
-            fclose(fd);
-    }
+    if(!_nbFiles)
+        return 0;
+    if(_nbFiles>1)
+        _prefetch=new picPrefetch(_fileNames,_imgSize,_bmpHeaderOffset);
 //_______________________________________
 //              Now build header info
 //_______________________________________
@@ -390,15 +375,24 @@ uint32_t picHeader::getFlags(uint32_t frame, uint32_t * flags)
     return 1;
 }
 /**
- * 
- * @param frameNum
- * @return 
+ * \fn addFrameFile
+ * \brief Append the image file name to the sequence, with its size
+ * @param name
+ * @return false if the file does not exist
  */
-FILE* picHeader::openFrameFile(uint32_t frameNum)
+bool picHeader::addFrameFile(const char *name)
 {
-    char filename[MAX_LEN];
-    sprintf(filename, _filePrefix.c_str(), frameNum + _first);
-    return ADM_fopen(filename, "rb");
+    FILE *fd=ADM_fopen(name, "rb");
+    if(!fd)
+        return false;
+    fseeko(fd, 0, SEEK_END);
+    int64_t size=ftello(fd)-_bmpHeaderOffset;
+    fclose(fd);
+    aprintf("Size %d, actual = 24 %d 32=%d offset=%d\n",(int)size,_w*_h*3,_w*_h*4,_bmpHeaderOffset);
+    if(size<0) size=0;
+    _fileNames.push_back(std::string(name));
+    _imgSize.push_back((uint32_t)size);
+    return true;
 }
 /**
  * 
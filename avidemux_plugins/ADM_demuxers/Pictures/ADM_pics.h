@@ -21,6 +21,8 @@
 #include "ADM_audioStream.h"
 #include "ADM_imageLoader.h"
 
+class picPrefetch;
+
 /**
     \class picHeader
     \brief Demuxers for images (PNG/BMP/...)
@@ -35,8 +37,10 @@ protected:
     uint32_t    _w, _h;
     int         _bmpHeaderOffset;
     std::vector<uint32_t>    _imgSize;
+    std::vector<std::string> _fileNames; /// built once at open, no sprintf per frame
     ADM_PICTURE_TYPE    _type;  
-    FILE        *openFrameFile (uint32_t frameNum);
+    picPrefetch *_prefetch;
+    bool        addFrameFile (const char *name);
 
 public:
     virtual void Dump (void)
@@ -46,6 +50,7 @@ public:
                 picHeader (void);
                 ~picHeader ()
                 {
+                    close();
                 };
 // AVI io
   virtual uint8_t open (const char *name);
@@ -37,6 +37,7 @@ LAll
 
 #include "ADM_quota.h"
 #include "ADM_fileio.h"
+#include "prefs.h"
 
 #include "muxerAvi.h"
 
@@ -395,8 +396,11 @@ uint8_t aviWrite::saveBegin (
                 printf("Problem writing : %s\n",name);
                 return 0;
         }
+        bool writeBehind=false;
+        if(!prefs->get(FEATURES_WRITE_BEHIND,&writeBehind))
+            writeBehind=false;
         _file=new ADMFile();
-        if(!_file->open(_out))
+        if(!_file->open(_out,writeBehind))
         {
                 printf("Cannot create ADMfileio\n");
                 delete _file;
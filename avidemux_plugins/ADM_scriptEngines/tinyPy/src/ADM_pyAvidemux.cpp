@@ -193,6 +193,22 @@ double pyGetDts(IEditor *editor, int frameNum)
 
 	return (double)dts;
 }
+/**
+    \fn pyGetSearchResult
+    \brief PTS of the index-th frame found by searchBlackFrames / searchSceneChanges, -1 if none
+*/
+
+double pyGetSearchResult(IEditor *editor, int index)
+{
+	uint64_t pts = editor->getSearchResult(index);
+
+	if (pts == ADM_NO_PTS)
+	{
+		return -1;
+	}
+
+	return (double)pts;
+}
 /**
     \fn pyFileSelWrite
 */
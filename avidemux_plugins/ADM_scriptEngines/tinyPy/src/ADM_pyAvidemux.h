@@ -58,6 +58,7 @@ bool pyHexDumpFrame(IEditor *editor, int framenumber);
 int pyPrintTiming(IEditor *editor, int framenumber);
 double pyGetPts(IEditor *editor, int frameNum);
 double pyGetDts(IEditor *editor, int frameNum);
+double pyGetSearchResult(IEditor *editor, int index);
 
 /* File operation */
 char *pyFileSelWrite(IEditor *editor, const char *title);
@@ -101,6 +101,45 @@ static tp_obj zzpy_save(TP)
   int r =   editor->saveFile(p0); 
   return tp_number(r);
 }
+// addRendition -> int editor->addRendition (str int int ) 
+static tp_obj zzpy_addRendition(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_AVIDEMUX);
+
+  const char *p0 = pm.asString();
+  int p1 = pm.asInt();
+  int p2 = pm.asInt();
+  int r =   editor->addRendition(p0,p1,p2); 
+  return tp_number(r);
+}
+// clearRenditions -> void editor->clearRenditions (void ) 
+static tp_obj zzpy_clearRenditions(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_AVIDEMUX);
+
+  editor->clearRenditions(); 
+ return tp_None;
+}
+// saveRenditions -> int editor->saveRenditions (void ) 
+static tp_obj zzpy_saveRenditions(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_AVIDEMUX);
+
+  int r =   editor->saveRenditions(); 
+  return tp_number(r);
+}
 // videoCodecChangeParam -> int editor->changeVideoParam (str  couples ) 
 static tp_obj zzpy_videoCodecChangeParam(TP)
  {
@@ -636,6 +675,18 @@ tp_obj zzpy__pyAdm_get(tp_vm *vm)
   {
      return tp_method(vm, self, zzpy_save);
   }
+  if (!strcmp(key, "addRendition"))
+  {
+     return tp_method(vm, self, zzpy_addRendition);
+  }
+  if (!strcmp(key, "clearRenditions"))
+  {
+     return tp_method(vm, self, zzpy_clearRenditions);
+  }
+  if (!strcmp(key, "saveRenditions"))
+  {
+     return tp_method(vm, self, zzpy_saveRenditions);
+  }
   if (!strcmp(key, "videoCodecChangeParam"))
   {
      return tp_method(vm, self, zzpy_videoCodecChangeParam);
@@ -823,6 +874,9 @@ static tp_obj zzpy__pyAdm_help(TP)
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "audioTracksCount(IEditor)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "audioResetFilter(int)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "save(str)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "addRendition(str,int,int)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "clearRenditions(void)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "saveRenditions(void)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "videoCodecChangeParam(str, couples)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "audioBitrate(IEditor, int)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "audioClearTracks(IEditor)\n");
@@ -12,8 +12,8 @@ static tp_obj zzpy_getFrameSize(TP)
   int r =   editor->getFrameSize(p0); 
   return tp_number(r);
 }
-// nbSegments -> int editor->getNbSegment (void ) 
-static tp_obj zzpy_nbSegments(TP)
+// dumpAllSegments -> void editor->dumpSegments (void ) 
+static tp_obj zzpy_dumpAllSegments(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -21,7 +21,21 @@ static tp_obj zzpy_nbSegments(TP)
   TinyParams pm(tp);
   void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
 
-  int r =   editor->getNbSegment(); 
+  editor->dumpSegments(); 
+ return tp_None;
+}
+// printTiming -> int pyPrintTiming (IEditor int ) 
+static tp_obj zzpy_printTiming(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
+
+  IEditor *p0 = editor;
+  int p1 = pm.asInt();
+  int r =   pyPrintTiming(p0,p1); 
   return tp_number(r);
 }
 // hexDumpFrame -> int pyHexDumpFrame (IEditor int ) 
@@ -38,6 +52,21 @@ static tp_obj zzpy_hexDumpFrame(TP)
   int r =   pyHexDumpFrame(p0,p1); 
   return tp_number(r);
 }
+// searchSceneChanges -> int editor->searchSceneChanges (double double double ) 
+static tp_obj zzpy_searchSceneChanges(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
+
+  double p0 = pm.asDouble();
+  double p1 = pm.asDouble();
+  double p2 = pm.asDouble();
+  int r =   editor->searchSceneChanges(p0,p1,p2); 
+  return tp_number(r);
+}
 // getDts -> double pyGetDts (IEditor int ) 
 static tp_obj zzpy_getDts(TP)
  {
@@ -52,8 +81,8 @@ static tp_obj zzpy_getDts(TP)
   double r =   pyGetDts(p0,p1); 
   return tp_number(r);
 }
-// getPts -> double pyGetPts (IEditor int ) 
-static tp_obj zzpy_getPts(TP)
+// dumpSegment -> void editor->dumpSegment (int ) 
+static tp_obj zzpy_dumpSegment(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -61,13 +90,12 @@ static tp_obj zzpy_getPts(TP)
   TinyParams pm(tp);
   void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
 
-  IEditor *p0 = editor;
-  int p1 = pm.asInt();
-  double r =   pyGetPts(p0,p1); 
-  return tp_number(r);
+  int p0 = pm.asInt();
+  editor->dumpSegment(p0); 
+ return tp_None;
 }
-// getVideoDuration -> double editor->getVideoDuration (void ) 
-static tp_obj zzpy_getVideoDuration(TP)
+// nbSegments -> int editor->getNbSegment (void ) 
+static tp_obj zzpy_nbSegments(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -75,7 +103,7 @@ static tp_obj zzpy_getVideoDuration(TP)
   TinyParams pm(tp);
   void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
 
-  double r =   editor->getVideoDuration(); 
+  int r =   editor->getNbSegment(); 
   return tp_number(r);
 }
 // nextFrame -> int pyNextFrame (IEditor ) 
@@ -91,6 +119,20 @@ static tp_obj zzpy_nextFrame(TP)
   int r =   pyNextFrame(p0); 
   return tp_number(r);
 }
+// getPts -> double pyGetPts (IEditor int ) 
+static tp_obj zzpy_getPts(TP)
+ {
+  tp_obj self = tp_getraw(tp);
+  IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
+  IEditor *editor = engine->editor();
+  TinyParams pm(tp);
+  void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
+
+  IEditor *p0 = editor;
+  int p1 = pm.asInt();
+  double r =   pyGetPts(p0,p1); 
+  return tp_number(r);
+}
 // dumpRefVideo -> int editor->dumpRefVideos (void ) 
 static tp_obj zzpy_dumpRefVideo(TP)
  {
@@ -103,8 +145,8 @@ static tp_obj zzpy_dumpRefVideo(TP)
   int r =   editor->dumpRefVideos(); 
   return tp_number(r);
 }
-// printTiming -> int pyPrintTiming (IEditor int ) 
-static tp_obj zzpy_printTiming(TP)
+// getSearchResult -> double pyGetSearchResult (IEditor int ) 
+static tp_obj zzpy_getSearchResult(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -114,11 +156,11 @@ static tp_obj zzpy_printTiming(TP)
 
   IEditor *p0 = editor;
   int p1 = pm.asInt();
-  int r =   pyPrintTiming(p0,p1); 
+  double r =   pyGetSearchResult(p0,p1); 
   return tp_number(r);
 }
-// dumpSegment -> void editor->dumpSegment (int ) 
-static tp_obj zzpy_dumpSegment(TP)
+// searchBlackFrames -> int editor->searchBlackFrames (double double ) 
+static tp_obj zzpy_searchBlackFrames(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -126,12 +168,13 @@ static tp_obj zzpy_dumpSegment(TP)
   TinyParams pm(tp);
   void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
 
-  int p0 = pm.asInt();
-  editor->dumpSegment(p0); 
- return tp_None;
+  double p0 = pm.asDouble();
+  double p1 = pm.asDouble();
+  int r =   editor->searchBlackFrames(p0,p1); 
+  return tp_number(r);
 }
-// dumpAllSegments -> void editor->dumpSegments (void ) 
-static tp_obj zzpy_dumpAllSegments(TP)
+// getVideoDuration -> double editor->getVideoDuration (void ) 
+static tp_obj zzpy_getVideoDuration(TP)
  {
   tp_obj self = tp_getraw(tp);
   IScriptEngine *engine = (IScriptEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
@@ -139,8 +182,8 @@ static tp_obj zzpy_dumpAllSegments(TP)
   TinyParams pm(tp);
   void *me = (void *)pm.asThis(&self, ADM_PYID_EDITOR);
 
-  editor->dumpSegments(); 
- return tp_None;
+  double r =   editor->getVideoDuration(); 
+  return tp_number(r);
 }
 tp_obj zzpy__pyEditor_get(tp_vm *vm)
 {
@@ -154,45 +197,57 @@ tp_obj zzpy__pyEditor_get(tp_vm *vm)
   {
      return tp_method(vm, self, zzpy_getFrameSize);
   }
-  if (!strcmp(key, "nbSegments"))
+  if (!strcmp(key, "dumpAllSegments"))
   {
-     return tp_method(vm, self, zzpy_nbSegments);
+     return tp_method(vm, self, zzpy_dumpAllSegments);
+  }
+  if (!strcmp(key, "printTiming"))
+  {
+     return tp_method(vm, self, zzpy_printTiming);
   }
   if (!strcmp(key, "hexDumpFrame"))
   {
      return tp_method(vm, self, zzpy_hexDumpFrame);
   }
+  if (!strcmp(key, "searchSceneChanges"))
+  {
+     return tp_method(vm, self, zzpy_searchSceneChanges);
+  }
   if (!strcmp(key, "getDts"))
   {
      return tp_method(vm, self, zzpy_getDts);
   }
-  if (!strcmp(key, "getPts"))
+  if (!strcmp(key, "dumpSegment"))
   {
-     return tp_method(vm, self, zzpy_getPts);
+     return tp_method(vm, self, zzpy_dumpSegment);
   }
-  if (!strcmp(key, "getVideoDuration"))
+  if (!strcmp(key, "nbSegments"))
   {
-     return tp_method(vm, self, zzpy_getVideoDuration);
+     return tp_method(vm, self, zzpy_nbSegments);
   }
   if (!strcmp(key, "nextFrame"))
   {
      return tp_method(vm, self, zzpy_nextFrame);
   }
+  if (!strcmp(key, "getPts"))
+  {
+     return tp_method(vm, self, zzpy_getPts);
+  }
   if (!strcmp(key, "dumpRefVideo"))
   {
      return tp_method(vm, self, zzpy_dumpRefVideo);
   }
-  if (!strcmp(key, "printTiming"))
+  if (!strcmp(key, "getSearchResult"))
   {
-     return tp_method(vm, self, zzpy_printTiming);
+     return tp_method(vm, self, zzpy_getSearchResult);
   }
-  if (!strcmp(key, "dumpSegment"))
+  if (!strcmp(key, "searchBlackFrames"))
   {
-     return tp_method(vm, self, zzpy_dumpSegment);
+     return tp_method(vm, self, zzpy_searchBlackFrames);
   }
-  if (!strcmp(key, "dumpAllSegments"))
+  if (!strcmp(key, "getVideoDuration"))
   {
-     return tp_method(vm, self, zzpy_dumpAllSegments);
+     return tp_method(vm, self, zzpy_getVideoDuration);
   }
   return tp_get(vm, self, tp_string(key));
 }
@@ -226,16 +281,19 @@ static tp_obj zzpy__pyEditor_help(TP)
 	PythonEngine *engine = (PythonEngine*)tp_get(tp, tp->builtins, tp_string("userdata")).data.val;
 
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getFrameSize(int)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "nbSegments(void)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "dumpAllSegments(void)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "printTiming(IEditor,int)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "hexDumpFrame(IEditor,int)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "searchSceneChanges(double,double,double)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getDts(IEditor,int)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getPts(IEditor,int)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getVideoDuration(void)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "dumpSegment(int)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "nbSegments(void)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "nextFrame(IEditor)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getPts(IEditor,int)\n");
 	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "dumpRefVideo(void)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "printTiming(IEditor,int)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "dumpSegment(int)\n");
-	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "dumpAllSegments(void)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getSearchResult(IEditor,int)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "searchBlackFrames(double,double)\n");
+	engine->callEventHandlers(IScriptEngine::Information, NULL, -1, "getVideoDuration(void)\n");
 
 	return tp_None;
 };
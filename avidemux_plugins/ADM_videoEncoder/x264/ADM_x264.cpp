@@ -53,6 +53,16 @@ x264Encoder::x264Encoder(ADM_coreVideoFilter *src,bool globalHeader) : ADM_coreV
     firstIdr=true;
 }
 
+/**
+    \fn sequentialNals
+*/
+static bool sequentialNals(x264_nal_t *nals, int nalCount)
+{
+    for(int i=1;i<nalCount;i++)
+        if(nals[i].p_payload!=nals[i-1].p_payload+nals[i-1].i_payload)
+            return false;
+    return nalCount>0;
+}
 /**
     \fn encodeNals
 */
@@ -168,6 +178,7 @@ bool         x264Encoder::encode (ADMBitstream * out)
     x264_nal_t *nal;
     int er,nbNal;
 
+    out->releaseRef(); // x264 is about to reuse the memory of the previous packet
     // update
 again:
     if(!flush)
@@ -266,7 +277,17 @@ bool  x264Encoder::preAmble (ADMImage * in)
 */
 bool x264Encoder::postAmble (ADMBitstream * out,uint32_t nbNals,x264_nal_t *nal,x264_picture_t *picout)
 {
-        int size = encodeNals(out->data, out->bufferSize, nal, nbNals, false);
+        int size;
+        // x264 outputs the NALs one after the other in its own buffer, kept until the next call
+        // Hand it by reference unless we have to insert our SEI
+        if(out->acceptRef && !seiUserDataLen && sequentialNals(nal,nbNals))
+        {
+            size=(nal[nbNals-1].p_payload+nal[nbNals-1].i_payload)-nal[0].p_payload;
+            out->setRef(new ADM_bitstreamRef,nal[0].p_payload,size);
+        }else
+        {
+            size = encodeNals(out->data, out->bufferSize, nal, nbNals, false);
+        }
 
         if (size < 0)
         {
@@ -154,6 +154,7 @@ virtual        bool        encode (ADMBitstream * out);
 virtual const  char        *getFourcc(void) {return "H264";}
 virtual        bool         getExtraData(uint32_t *l,uint8_t **d) {*l=extraDataLen;*d=extraData;return true;}
 virtual        bool         isDualPass(void) ;
+virtual        uint32_t     getLookahead(void) {return param.rc.i_lookahead+param.i_bframe;}
 
 virtual        bool         setPassAndLogFile(int pass,const char *name);
 
@@ -131,6 +131,7 @@ virtual        bool        encode (ADMBitstream * out);
 virtual const  char        *getFourcc(void) {return "HEVC";}
 virtual        bool         getExtraData(uint32_t *l,uint8_t **d) {*l=extraDataLen;*d=extraData;return true;}
 virtual        bool         isDualPass(void) ;
+virtual        uint32_t     getLookahead(void) {return param.lookaheadDepth+param.bframes;}
 
 virtual        bool         setPassAndLogFile(int pass,const char *name);
 
@@ -41,7 +41,11 @@ bool x265Encoder::setup(void)
 
   x265_param_default( &param);
   firstIdr=true;
-  image=new ADMImageDefault(getWidth(),getHeight());
+  // Take the high bit depth images as they are, x265 shifts them down itself if needed
+  uint32_t inputDepth=8;
+  if(getBitDepth()>8 && x265_max_bit_depth>8)
+      inputDepth=getBitDepth();
+  image=new ADMImageDefault(getWidth(),getHeight(),inputDepth);
 
   // -------------- preset, tune, idc ------------
   if(!x265Settings.useAdvancedConfiguration)
@@ -76,6 +80,11 @@ bool x265Encoder::setup(void)
   param.sourceHeight = getHeight();
   param.internalCsp = X265_CSP_I420;
   param.internalBitDepth = 8;
+  if(inputDepth>8 && x265Settings.general.profile==std::string("main10"))
+  {
+      ADM_info("[x265] Encoding the %" PRIu32" bits source as 10 bits\n",inputDepth);
+      param.internalBitDepth = 10;
+  }
   param.logLevel=X265_LOG_INFO; //DEBUG; //INFO;
 
   //Framerate
@@ -41,7 +41,7 @@ protected:
 // Add the hook to make it valid plugin
 DECLARE_VIDEO_FILTER_PARTIALIZABLE(   verticalFlipFilter,   // Class
                         1,0,0,              // Version
-                        ADM_UI_ALL,         // UI
+                        ADM_UI_ALL+ADM_CAPABILITY_HIGH_BITDEPTH,         // UI
                         VF_TRANSFORM,            // Category
                         "vflip",            // internal name (must be uniq!)
                         QT_TRANSLATE_NOOP("vflip","Vertical Flip"),            // Display name
@@ -56,7 +56,7 @@ DECLARE_VIDEO_FILTER_PARTIALIZABLE(   verticalFlipFilter,   // Class
 verticalFlipFilter::verticalFlipFilter(  ADM_coreVideoFilter *in,CONFcouple *setup) : ADM_coreVideoFilter(in,setup)
 {
 UNUSED_ARG(setup);
-scratch=(uint8_t *)malloc(info.width);
+scratch=(uint8_t *)malloc(info.width*2); // up to 2 bytes per sample
 
     // By default the info field contains the output of previous filter
     // Tweak it here if you change fps, duration, width,...
@@ -97,7 +97,7 @@ bool verticalFlipFilter::getNextFrame(uint32_t *fn,ADMImage *image)
         return false;
     }
     // do in place flip
-    int w=info.width;
+    int w=info.width*image->GetBytesPerSample();
     int h=info.height;
     int stride=image->GetPitch(PLANAR_Y);
     flipMe(YPLANE(image),w,h,stride);
@@ -50,6 +50,7 @@
 #include "ADM_coreVideoFilter.h"
 #include "ADM_videoFilterCache.h"
 #include "DIA_factory.h"
+#include "ADM_threadPool.h"
 #include "yadif.h"
 #include "yadif_desc.cpp"
 #include "libavutil/common.h"
@@ -120,6 +121,8 @@ protected:
     void (*filter_end)(void);    
     
     void filter_plane(int mode, uint8_t *dst, int dst_stride, const uint8_t *prev0, const uint8_t *cur0, const uint8_t *next0, int refs, int w, int h, int parity, int tff, int mmx);
+public: // called by the worker threads
+    void filter_rows(uint8_t *dst, int dst_stride, const uint8_t *prev0, const uint8_t *cur0, const uint8_t *next0, int refs, int w, int h, int parity, int tff, int yStart, int yEnd);
 };
 
 // Add the hook to make it valid plugin
@@ -159,14 +159,78 @@ bool yadifFilter::getNextFrame(uint32_t *fn,ADMImage *image)
 }
 
 
+#define YADIF_MIN_ROWS_PER_SLICE 16
+/**
+    \struct yadifSlice
+    \brief One plane to deinterlace, split in horizontal bands
+*/
+typedef struct
+{
+    yadifFilter   *filter;
+    uint8_t       *dst;
+    int           dst_stride;
+    const uint8_t *prev0;
+    const uint8_t *cur0;
+    const uint8_t *next0;
+    int           refs;
+    int           w;
+    int           h;
+    int           parity;
+    int           tff;
+    int           nbSlices;
+}yadifSlice;
+
+/**
+    \fn yadifWorker
+    \brief Process band number slice
+*/
+static void yadifWorker(void *cookie,int slice)
+{
+    yadifSlice *s=(yadifSlice *)cookie;
+    int yStart=(s->h*slice)/s->nbSlices;
+    int yEnd=(s->h*(slice+1))/s->nbSlices;
+    s->filter->filter_rows(s->dst,s->dst_stride,s->prev0,s->cur0,s->next0,s->refs,s->w,s->h,s->parity,s->tff,yStart,yEnd);
+}
+/**
+    \fn filter_plane
+    \brief Each output row only depends on the input frames, rows are spread over the thread pool
+*/
 void yadifFilter::filter_plane(int mode, uint8_t *dst, int dst_stride, const uint8_t *prev0, const uint8_t *cur0, const uint8_t *next0, int refs, int w, int h, int parity, int tff, int mmx)
+{
+        ADM_threadPool *pool=ADM_threadPool::getInstance();
+        int nbSlices=pool->getNbSlices();
+        if(nbSlices>h/YADIF_MIN_ROWS_PER_SLICE)
+            nbSlices=h/YADIF_MIN_ROWS_PER_SLICE;
+        if(nbSlices<=1)
+        {
+            filter_rows(dst,dst_stride,prev0,cur0,next0,refs,w,h,parity,tff,0,h);
+            return;
+        }
+        yadifSlice slice;
+        slice.filter=this;
+        slice.dst=dst;
+        slice.dst_stride=dst_stride;
+        slice.prev0=prev0;
+        slice.cur0=cur0;
+        slice.next0=next0;
+        slice.refs=refs;
+        slice.w=w;
+        slice.h=h;
+        slice.parity=parity;
+        slice.tff=tff;
+        slice.nbSlices=nbSlices;
+        pool->run(nbSlices,yadifWorker,&slice);
+}
+/**
+    \fn filter_rows
+    \brief Deinterlace rows yStart to yEnd-1 of a plane of height h
+*/
+void yadifFilter::filter_rows(uint8_t *dst, int dst_stride, const uint8_t *prev0, const uint8_t *cur0, const uint8_t *next0, int refs, int w, int h, int parity, int tff, int yStart, int yEnd)
 {
         int df = 1;
         int pix_3 = 3 * df;
         int edge = 3 + MAX_ALIGN / df - 1;
-        //memcpy(dst, cur0, w);
-        //memcpy(dst + dst_stride, cur0 + refs, w);
-        for(int y=0; y<h; y++){
+        for(int y=yStart; y<yEnd; y++){
             if(((y ^ parity) & 1)){
                 const uint8_t *prev= prev0 + y*refs;
                 const uint8_t *cur = cur0 + y*refs;
@@ -188,8 +252,6 @@ void yadifFilter::filter_plane(int mode, uint8_t *dst, int dst_stride, const uin
                 memcpy(dst + y*dst_stride, cur0 + y*refs, w);
             }
         }
-        //memcpy(dst + (h-1)*dst_stride, cur0 + (h-1)*refs, w);
-
 }
 
 //--- ff ---